@@ -50,6 +50,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agent keeps its registry handle
 //   [2004-12-23] (antoine): added configuration methods, modified constructor 
 //							 and factory method to handle configurations
 //   [2004-04-24] (dbohus): added create method
@@ -73,6 +74,7 @@ CAgent::CAgent(string sAName, string sAConfiguration, string sAType)
 {
 	sName = sAName;
 	sType = sAType;
+	iRegistryHandle = NULL_AGENT_HANDLE;
 	//ַstringΪHash
 	// sAConfiguration = "key=value,key=value,.."
 	SetConfiguration(sAConfiguration);
@@ -187,12 +189,18 @@ string CAgent::GetType()
 	return sType;
 }
 
+// M: returns the handle of the agent in the registry
+int CAgent::GetRegistryHandle()
+{
+	return iRegistryHandle;
+}
+
 // D: registers the agent
 //麯Ĭʵ - עagent
 void CAgent::Register()
 {
 	//this ָǰagentʵָ
-	AgentsRegistry.RegisterAgent(sName, this);
+	iRegistryHandle = AgentsRegistry.RegisterAgent(sName, this);
 }
 
 // D: unregisters the agent
@@ -200,4 +208,5 @@ void CAgent::Register()
 void CAgent::UnRegister()
 {
 	AgentsRegistry.UnRegisterAgent(sName);
+	iRegistryHandle = NULL_AGENT_HANDLE;
 }
\ No newline at end of file
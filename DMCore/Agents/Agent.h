@@ -50,6 +50,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agent keeps its registry handle
 //   [2004-12-23] (antoine): added configuration methods, modified constructor 
 //							 and factory method to handle configurations
 //   [2004-04-24] (dbohus): added create method
@@ -85,6 +86,9 @@ protected:
 	//
 	string sName;						// name of agent 
 	string sType;						// type of agent 
+	int iRegistryHandle;				// handle in the agents registry (see
+										//  TAgentHandle in Registry.h), -1 if
+										//  the agent is not registered
 	STRING2STRING s2sConfiguration;		// hash of parameters 
 
 public:
@@ -108,6 +112,7 @@ public:
 
 	string GetName();
 	string GetType();
+	int GetRegistryHandle();
 
 	// Sets the configuration from a configuration string or from a hash
 	// ͨstring  hash ò s2sConfiguration
@@ -52,6 +52,28 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agenda broadcast string is built level by
+//                            level (expectationAgendaLevelToBroadcastString)
+//   [2026-10-19] (mbrenner): the journal records each part of a concept state
+//                            once per dialog state, in compact snapshots
+//   [2026-10-19] (mbrenner): the memory accounting includes the compiled 
+//                            grounding policies
+//   [2026-10-19] (mbrenner): the forced updates compare the top hyp before 
+//                            and after the update by value (the hypotheses
+//                            are copied on write)
+//   [2026-10-19] (mbrenner): added the memory accounting of the session
+//   [2026-10-19] (mbrenner): the dialog state generation is incremented when
+//                            the execution stack, the turn or the bindings
+//                            change
+//   [2026-10-19] (mbrenner): concept updates use the update type enum
+//   [2026-10-19] (mbrenner): the concept grounding requests issued during 
+//                            binding and forced updates are batched
+//   [2026-10-19] (mbrenner): the temporary concepts used in binding are kept
+//                            as scratch concepts, released together after
+//                            the binding phase
+//   [2026-10-19] (mbrenner): added the dialog state journal; rollBackDialogState
+//                            now undoes the journal back to the target state
+//                            instead of only restoring the stack and agenda
 //   [2007-03-05] (antoine): changed Execute so that grounding and dialog agents
 //							 are only executed once the floor is free and all 
 //							 pending prompt notifications have been received 
@@ -94,6 +116,8 @@ CDMCoreAgent::CDMCoreAgent(string sAName, string sAConfiguration, string sAType)
 	bFocusClaimsPhaseFlag = false;				// indicates whether we should		־
 	fsFloorStatus = fsSystem;					// indicates who has the floor		Floor״̬ - ö
 	iTurnNumber = 0;							// stores the current turn number	¼ǰturn
+	iJournalBase = 0;
+	bJournalReplay = false;
 	csoStartOverFunct = NULL;					// a custom start over function		ûƵ [ָ]
 	//ȫֱ - floor״̬
 	vsFloorStatusLabels.push_back("unknown");	// TFloorStatusǩַ
@@ -106,6 +130,10 @@ CDMCoreAgent::CDMCoreAgent(string sAName, string sAConfiguration, string sAType)
 // 
 CDMCoreAgent::~CDMCoreAgent()
 {
+	// release the snapshots held in the journal
+	ClearDialogStateJournal();
+	// and any leftover scratch concepts
+	releaseScratchConcepts();
 }
 
 //-----------------------------------------------------------------------------
@@ -126,11 +154,13 @@ CAgent* CDMCoreAgent::AgentFactory(string sAName, string sAConfiguration)
 void CDMCoreAgent::Reset()
 {
 	// clear the class members
+	CDialogAgent::IncrementDialogStateGeneration();
 	esExecutionStack.clear();
 	ehExecutionHistory.clear();
 	bhBindingHistory.clear();
 	eaAgenda.celSystemExpectations.clear();
 	eaAgenda.vCompiledExpectations.clear();
+	ClearDialogStateJournal();
 }
 
 //-----------------------------------------------------------------------------
@@ -402,12 +432,19 @@ void CDMCoreAgent::AcquireNextEvent()//
 	//		try and bind concepts 
 	// <3>	԰concept
 	TBindingsDescr bdBindings;
+	// (the grounding requests from binding and forced updates are issued 
+	// once per concept, at the end)
+	pGroundingManager->BeginConceptGroundingRequestsBatch();
 	bindConcepts(bdBindings);
+	pGroundingManager->CommitConceptGroundingRequestsBatch();
+	// the temporary concepts used in binding are not needed anymore
+	releaseScratchConcepts();
 	//################################## concept###########################################
 
 	//		add the binding results to history
 	// <4>	󶨽ӵʷ¼
 	bhBindingHistory.push_back(bdBindings);
+	CDialogAgent::IncrementDialogStateGeneration();
 
 	//		Set the bindings index on the focused agent
 	// <5>	ڹעĴð
@@ -464,6 +501,7 @@ void CDMCoreAgent::AcquireNextEvent()//
 			GetAgentInFocus()->IncrementTurnsInFocusCounter();// ʾagentϴΡ/´򿪡жٴλý iTurnsInFocusCounter
 
 			iTurnNumber++;//TurnNumberһ
+			CDialogAgent::IncrementDialogStateGeneration();
 
 			//###############################Turn Grouding#########################################
 			// signal the need for a turn grounding
@@ -1091,97 +1129,106 @@ string CDMCoreAgent::expectationAgendaToBroadcastString()
 string CDMCoreAgent::expectationAgendaToBroadcastString(TExpectationAgenda eaBAgenda)
 {
 	string sResult;
-	STRING2STRING s2sAllOpenGrammarExpectations;
 	// go through all the levels of the agenda
 	for (unsigned int l = 0; l < eaBAgenda.vCompiledExpectations.size(); l++)
 	{
 		sResult += FormatString("\n%d:", l);
-		TMapCE::iterator iPtr;
-		// iterate through the compiled expectations from that level
-		for (iPtr = eaBAgenda.vCompiledExpectations[l].mapCE.begin();
-			iPtr != eaBAgenda.vCompiledExpectations[l].mapCE.end();
-			iPtr++)
-		{
-			string sSlotExpected = iPtr->first;
-			TIntVector& rvIndices = iPtr->second;
+		sResult += expectationAgendaLevelToBroadcastString(eaBAgenda, l);
+	}
+	// finally, return the string
+	return Trim(sResult, "\n");
+}
 
-			TIntVector vOpenIndices;
-			set<CConcept *> scpOpenConcepts;
-			TIntVector vClosedIndices;
-			set<CConcept *> scpClosedConcepts;
+// M: generates the broadcast string representation of one level of the 
+//    expectation agenda (one line per expectation, without the "<level>:"
+//    line that starts the level in the full representation)
+string CDMCoreAgent::expectationAgendaLevelToBroadcastString(
+	TExpectationAgenda& reaBAgenda, unsigned int iLevel)
+{
+	string sResult;
+	TMapCE::iterator iPtr;
+	// iterate through the compiled expectations from that level
+	for (iPtr = reaBAgenda.vCompiledExpectations[iLevel].mapCE.begin();
+		iPtr != reaBAgenda.vCompiledExpectations[iLevel].mapCE.end();
+		iPtr++)
+	{
+		string sSlotExpected = iPtr->first;
+		TIntVector& rvIndices = iPtr->second;
 
-			for (unsigned int i = 0; i < rvIndices.size(); i++)
+		TIntVector vOpenIndices;
+		set<CConcept *> scpOpenConcepts;
+		TIntVector vClosedIndices;
+		set<CConcept *> scpClosedConcepts;
+
+		for (unsigned int i = 0; i < rvIndices.size(); i++)
+		{
+			TConceptExpectation& rceExpectation =
+				reaBAgenda.celSystemExpectations[rvIndices[i]];
+			// determine the concept under consideration
+			CConcept* pConcept =
+				&(rceExpectation.pDialogAgent->C(
+				rceExpectation.sConceptName));
+
+			// test that the expectation is not disabled
+			if (!reaBAgenda.celSystemExpectations[rvIndices[i]].bDisabled)
 			{
-				TConceptExpectation& rceExpectation =
-					eaBAgenda.celSystemExpectations[rvIndices[i]];
-				// determine the concept under consideration
-				CConcept* pConcept =
-					&(rceExpectation.pDialogAgent->C(
-					rceExpectation.sConceptName));
-
-				// test that the expectation is not disabled
-				if (!eaBAgenda.celSystemExpectations[rvIndices[i]].bDisabled)
+				if (scpOpenConcepts.find(pConcept) == scpOpenConcepts.end())
 				{
-					if (scpOpenConcepts.find(pConcept) == scpOpenConcepts.end())
+					// add it to the open indices list
+					vOpenIndices.push_back(rvIndices[i]);
+					// add the concept to the open concepts list
+					scpOpenConcepts.insert(pConcept);
+					// if by any chance it's already in the closed concepts, 
+					set<CConcept *>::iterator iPtr;
+					if ((iPtr = scpClosedConcepts.find(pConcept)) !=
+						scpClosedConcepts.end())
 					{
-						// add it to the open indices list
-						vOpenIndices.push_back(rvIndices[i]);
-						// add the concept to the open concepts list
-						scpOpenConcepts.insert(pConcept);
-						// if by any chance it's already in the closed concepts, 
-						set<CConcept *>::iterator iPtr;
-						if ((iPtr = scpClosedConcepts.find(pConcept)) !=
-							scpClosedConcepts.end())
-						{
-							// remove it from there
-							scpClosedConcepts.erase(iPtr);
-						}
+						// remove it from there
+						scpClosedConcepts.erase(iPtr);
 					}
 				}
-				else
+			}
+			else
+			{
+				// o/w if the expectation is disabled
+				if ((scpClosedConcepts.find(pConcept) == scpClosedConcepts.end()) &&
+					(scpOpenConcepts.find(pConcept) == scpOpenConcepts.end()))
 				{
-					// o/w if the expectation is disabled
-					if ((scpClosedConcepts.find(pConcept) == scpClosedConcepts.end()) &&
-						(scpOpenConcepts.find(pConcept) == scpOpenConcepts.end()))
-					{
-						// add it to the closed indices list
-						vClosedIndices.push_back(rvIndices[i]);
-						// add the concept to the closed concepts list
-						scpClosedConcepts.insert(pConcept);
-					}
+					// add it to the closed indices list
+					vClosedIndices.push_back(rvIndices[i]);
+					// add the concept to the closed concepts list
+					scpClosedConcepts.insert(pConcept);
 				}
 			}
+		}
 
-			// now add the first one in the open indices, if there is any
-			// in there
+		// now add the first one in the open indices, if there is any
+		// in there
 
-			if (vOpenIndices.size() > 0)
-			{
-				TConceptExpectation& rceExpectation =
-					eaBAgenda.celSystemExpectations[vOpenIndices[0]];
-				sResult += "\n"; // (air)
-				sResult += "O" + rceExpectation.sGrammarExpectation;
+		if (vOpenIndices.size() > 0)
+		{
+			TConceptExpectation& rceExpectation =
+				reaBAgenda.celSystemExpectations[vOpenIndices[0]];
+			sResult += "\n"; // (air)
+			sResult += "O" + rceExpectation.sGrammarExpectation;
 
-				sResult +=
-					(rceExpectation.bmBindMethod == bmExplicitValue) ? "V," : "S,";
-			}
+			sResult +=
+				(rceExpectation.bmBindMethod == bmExplicitValue) ? "V," : "S,";
+		}
 
-			// finally, add all the blocked ones
-			for (unsigned int i = 0; i < vClosedIndices.size(); i++)
-			{
-				TConceptExpectation& rceExpectation =
-					eaBAgenda.celSystemExpectations[vClosedIndices[i]];
-				sResult += "\n"; // (air)
-				sResult += "X" + rceExpectation.sGrammarExpectation;
-				sResult +=
-					(rceExpectation.bmBindMethod == bmExplicitValue) ? "V," : "S,";
-			}
+		// finally, add all the blocked ones
+		for (unsigned int i = 0; i < vClosedIndices.size(); i++)
+		{
+			TConceptExpectation& rceExpectation =
+				reaBAgenda.celSystemExpectations[vClosedIndices[i]];
+			sResult += "\n"; // (air)
+			sResult += "X" + rceExpectation.sGrammarExpectation;
+			sResult +=
+				(rceExpectation.bmBindMethod == bmExplicitValue) ? "V," : "S,";
 		}
-		// cut the last comma
-		sResult = TrimRight(sResult, ",");
 	}
-	// finally, return the string
-	return Trim(sResult, "\n");
+	// cut the last comma
+	return TrimRight(sResult, ",");
 }
 
 // D: generates a string representation of the bindings description
@@ -1669,11 +1716,12 @@ void CDMCoreAgent::performConceptBinding(string sSlotName, string sSlotValue,
 	{
 		// first, create a temporary concept for that
 		// һʱconcept
-		CConcept *pTempConcept = ceExpectation.pDialogAgent->C(ceExpectation.sConceptName).EmptyClone();
+		CConcept *pTempConcept = newScratchConcept(
+			ceExpectation.pDialogAgent->C(ceExpectation.sConceptName));
 		// assign it from the string
 		// <4>	ͨstringֵconcept
 		//		sBindingString =>  ʽ slotValue|confidence    ==>  value/confidence
-		pTempConcept->Update(CU_ASSIGN_FROM_STRING, &sBindingString);
+		pTempConcept->Update(cuAssignFromString, &sBindingString);
 
 		CConcept &c = ceExpectation.pDialogAgent->C(ceExpectation.sConceptName);
 
@@ -1685,18 +1733,16 @@ void CDMCoreAgent::performConceptBinding(string sSlotName, string sSlotValue,
 		//############################ ʵʸ ###########################################
 		//		now call the binding method 
 		// <6>	ڵð󶨷,ʱpTempConceptʵʵconcept
-		c.Update(CU_UPDATE_WITH_CONCEPT, pTempConcept);
+		c.Update(cuUpdateWithConcept, pTempConcept);
 		//############################ ʵʸ ###########################################
 
-		// finally, deallocate the temporary concept
-		// 
-		delete pTempConcept;
+		// (the temporary concept is released at the end of the binding phase)
 	}//if (bIsComplete) event
 	else
 	{
 		// perform a partial (temporary) binding
 		// ִв֣ʱ
-		ceExpectation.pDialogAgent->C(ceExpectation.sConceptName).Update(CU_PARTIAL_FROM_STRING, &sBindingString);
+		ceExpectation.pDialogAgent->C(ceExpectation.sConceptName).Update(cuPartialFromString, &sBindingString);
 	}
 
 	// log it
@@ -1707,6 +1753,24 @@ void CDMCoreAgent::performConceptBinding(string sSlotName, string sSlotValue,
 }// Dִи
 
 
+// M: creates a scratch concept (an empty clone of a given concept), which
+//    is released at the end of the binding phase
+CConcept* CDMCoreAgent::newScratchConcept(CConcept& rAConcept)
+{
+	CConcept* pConcept = rAConcept.EmptyClone();
+	vpScratchConcepts.push_back(pConcept);
+	return pConcept;
+}
+
+// M: releases all the scratch concepts (the hypotheses they hold go back 
+//    to the hypothesis pools)
+void CDMCoreAgent::releaseScratchConcepts()
+{
+	for (unsigned int i = 0; i < vpScratchConcepts.size(); i++)
+		delete vpScratchConcepts[i];
+	vpScratchConcepts.clear();
+}
+
 // D: processes non-understandings
 void CDMCoreAgent::processNonUnderstanding()
 {
@@ -1756,12 +1820,15 @@ void CDMCoreAgent::performForcedConceptUpdates(TBindingsDescr& rbdBindings)
 			fcu.sConceptName = (*iPtr)->GetName();
 			fcu.iType = FCU_EXPLICIT_CONFIRM;
 			fcu.bUnderstanding = false;
+			// (the top hyp is compared by value, since the update can 
+			// replace the hypothesis objects)
 			CHyp *phOldTopHyp = (*iPtr)->GetTopHyp();
+			string sOldTopHyp = phOldTopHyp ? phOldTopHyp->ValueToString() : "";
 
 			// log the update
 			Log(DMCORE_STREAM, "Performing forced concept update on %s ...", (*iPtr)->GetName().c_str());
 			Log(DMCORE_STREAM, "Concept grounding status: %d", pGroundingManager->GetConceptGroundingRequestStatus((*iPtr)));
-			(*iPtr)->Update(CU_UPDATE_WITH_CONCEPT, NULL);// ????pUpdateData=NULL
+			(*iPtr)->Update(cuUpdateWithConcept, NULL);// ????pUpdateData=NULL
 
 			Log(DMCORE_STREAM, "Concept grounding status: %d", pGroundingManager->GetConceptGroundingRequestStatus((*iPtr)));
 			// now, if this update has desealed the concept, then we need
@@ -1779,7 +1846,10 @@ void CDMCoreAgent::performForcedConceptUpdates(TBindingsDescr& rbdBindings)
 					fcu.bUnderstanding = true;
 					rbdBindings.bNonUnderstanding = false;
 				}
-				else if ((*iPtr)->GetTopHyp() == phOldTopHyp)
+				else if ((phOldTopHyp == NULL) ?
+					((*iPtr)->GetTopHyp() == NULL) :
+					(((*iPtr)->GetTopHyp() != NULL) &&
+					((*iPtr)->GetTopHyp()->ValueToString() == sOldTopHyp)))
 				{
 					// if we are still on an explicit confirm on the same hypothesis, 
 					// seal it back
@@ -1811,7 +1881,7 @@ void CDMCoreAgent::performForcedConceptUpdates(TBindingsDescr& rbdBindings)
 
 			// log the update
 			Log(DMCORE_STREAM, FormatString("Performing forced concept update on %s ...", (*iPtr)->GetName().c_str()));
-			(*iPtr)->Update(CU_UPDATE_WITH_CONCEPT, NULL);
+			(*iPtr)->Update(cuUpdateWithConcept, NULL);
 
 			// now, if this update has desealed the concept, then we need
 			// to run grounding on this concept 
@@ -1850,7 +1920,7 @@ void CDMCoreAgent::performForcedConceptUpdates(TBindingsDescr& rbdBindings)
 
 			// log the update
 			Log(DMCORE_STREAM, FormatString("Performing forced concept update on %s ...", (*iPtr)->GetName().c_str()));
-			(*iPtr)->Update(CU_UPDATE_WITH_CONCEPT, NULL);
+			(*iPtr)->Update(cuUpdateWithConcept, NULL);
 
 			// now, if this update has desealed the concept, then we need
 			// to run grounding on this concept 
@@ -2069,6 +2139,7 @@ void CDMCoreAgent::SetFloorStatus(TFloorStatus fsaFloorStatus)
 {
 	Log(DMCORE_STREAM, "Set floor status to %s", vsFloorStatusLabels[fsaFloorStatus].c_str());
 	fsFloorStatus = fsaFloorStatus;
+	CDialogAgent::IncrementDialogStateGeneration();
 }
 
 void CDMCoreAgent::SetFloorStatus(string sAFloorStatus)
@@ -2078,6 +2149,7 @@ void CDMCoreAgent::SetFloorStatus(string sAFloorStatus)
 
 TFloorStatus CDMCoreAgent::GetFloorStatus()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	return fsFloorStatus;
 }
 
@@ -2122,6 +2194,7 @@ void CDMCoreAgent::SignalFocusClaimsPhase(bool bAFocusClaimsPhaseFlag)
 // D: returns the number of concepts bound in the last input pass
 int CDMCoreAgent::LastTurnGetConceptsBound()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	if (bhBindingHistory.size() == 0)
 		return -1;
 	else
@@ -2132,6 +2205,7 @@ int CDMCoreAgent::LastTurnGetConceptsBound()
 // Dһturnǲ⣬򷵻true
 bool CDMCoreAgent::LastTurnNonUnderstanding()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	// <1>	Ӻǰ => ʷ
 	for (int i = bhBindingHistory.size() - 1; i >= 0; i--)
 	{
@@ -2168,6 +2242,7 @@ bool CDMCoreAgent::LastTurnNonUnderstanding()
 // صĿǰΪֹ
 int CDMCoreAgent::GetNumberNonUnderstandings()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	int iNumNonunderstandings = 0;
 	for (int i = bhBindingHistory.size() - 1; i >= 0; i--)
 	{
@@ -2192,6 +2267,7 @@ int CDMCoreAgent::GetNumberNonUnderstandings()
 //صǰԻΪֹ
 int CDMCoreAgent::GetTotalNumberNonUnderstandings()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	int iNumNonunderstandings = 0;
 	for (int i = 0; i < (int)bhBindingHistory.size(); i++)
 	{
@@ -2242,7 +2318,8 @@ void CDMCoreAgent::ContinueWith(CAgent* paPusher, CDialogAgent* pdaDialogAgent)
 	// <3>	ʵʵеAgentѹջ
 	TExecutionStackItem esi;
 	esi.pdaAgent = pdaDialogAgent;
-	esi.iEHIndex = ehExecutionHistory.size() - 1;	//¼ִʷе
+	esi.iEHIndex = ehExecutionHistory.size() - 1;
+	journalStackPush(esi);	//¼ִʷе
 	esExecutionStack.push_front(esi);				//ڿʼλ[ջ]һԪ======ڿʼλһԪ
 
 	//		stores the execution index in the agent
@@ -2306,6 +2383,9 @@ void CDMCoreAgent::StartOver()
 {
 	if (csoStartOverFunct == NULL)
 	{
+		// the journal cannot roll back over a start over
+		ClearDialogStateJournal();
+		CDialogAgent::IncrementDialogStateGeneration();
 		// restart the dialog clear the execution stack
 		// ִջ Ұָ룿
 		esExecutionStack.clear();
@@ -2418,6 +2498,7 @@ void CDMCoreAgent::popAgentFromExecutionStack(CDialogAgent* pdaADialogAgent,
 	rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
 
 	// eliminate the agent from the stack
+	journalStackErase(iPtr);
 	esExecutionStack.erase(iPtr);
 
 	// signals that the agenda needs to be recompiled
@@ -2476,6 +2557,7 @@ void CDMCoreAgent::popTopicFromExecutionStack(CDialogAgent* pdaADialogAgent, TSt
 
 	//		eliminate the agent from the stack
 	// <7>	ջɾǰagent
+	journalStackErase(iPtr);
 	esExecutionStack.erase(iPtr);
 
 	// now enter in a loop going through the stack repeatedly until 
@@ -2516,6 +2598,7 @@ void CDMCoreAgent::popTopicFromExecutionStack(CDialogAgent* pdaADialogAgent, TSt
 				rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
 				// eliminate the agent from the stack
 				// ջɾ - ʵʲ
+				journalStackErase(iPtr);
 				esExecutionStack.erase(iPtr);
 				// set found one to true
 				bFoundAgentToRemove = true;
@@ -2577,6 +2660,7 @@ void CDMCoreAgent::popGroundingAgentsFromExecutionStack(TStringVector& rvsAgents
 				// and add it to the list of eliminated agents
 				rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
 				// eliminate the agent from the stack
+				journalStackErase(iPtr);
 				esExecutionStack.erase(iPtr);
 				// set found one to true
 				bFoundAgentToRemove = true;
@@ -2589,6 +2673,239 @@ void CDMCoreAgent::popGroundingAgentsFromExecutionStack(TStringVector& rvsAgents
 	bAgendaModifiedFlag = true;
 }
 
+//-----------------------------------------------------------------------------
+//
+// DIALOG STATE JOURNAL METHODS
+//
+//-----------------------------------------------------------------------------
+
+// M: Records a concept in the journal, before it changes; iParts indicates
+//    the parts of the concept state (CJ_*) that are about to change, besides
+//    the flags. Each part of a concept is recorded only once between two 
+//    consecutive dialog states, since rolling back only needs its value as 
+//    of the last dialog state
+void CDMCoreAgent::JournalConceptChange(CConcept* pConcept, int iParts)
+{
+	// don't record anything while the journal is being replayed
+	if (bJournalReplay) return;
+
+	// check which parts were already recorded since the last state
+	map<CConcept*, int>::iterator iPtr = 
+		c2iJournaledSinceMark.find(pConcept);
+	if (iPtr != c2iJournaledSinceMark.end())
+	{
+		iParts &= ~(iPtr->second);
+		if (iParts == 0) return;
+		iPtr->second |= iParts;
+	}
+	else
+		c2iJournaledSinceMark.insert(make_pair(pConcept, iParts));
+
+	// o/w record a snapshot of the missing parts
+	TJournalEntry jeEntry;
+	jeEntry.jetType = jetConcept;
+	jeEntry.pConcept = pConcept;
+	jeEntry.pSnapshot = pConcept->CreateJournalSnapshot(iParts);
+	jeEntry.pdaAgent = NULL;
+	jeEntry.iStackPosition = -1;
+	pushJournalEntry(jeEntry);
+}
+
+// M: Records an agent's status in the journal, before it changes. As for 
+//    concepts, an agent is recorded only once between two dialog states
+void CDMCoreAgent::JournalAgentChange(CDialogAgent* pdaAgent)
+{
+	// don't record anything while the journal is being replayed
+	if (bJournalReplay) return;
+
+	// check if the agent was already recorded since the last state
+	if (!spdaJournaledSinceMark.insert(pdaAgent).second) return;
+
+	// o/w record the agent status
+	TJournalEntry jeEntry;
+	jeEntry.jetType = jetAgent;
+	jeEntry.pConcept = NULL;
+	jeEntry.pSnapshot = NULL;
+	jeEntry.pdaAgent = pdaAgent;
+	jeEntry.dasStatus = pdaAgent->GetStatus();
+	jeEntry.iStackPosition = -1;
+	pushJournalEntry(jeEntry);
+}
+
+// M: Drops the journal entries referring to a concept which is being 
+//    destroyed. Since the journal can no longer be undone past the last entry
+//    referring to that concept, everything up to that entry is discarded
+void CDMCoreAgent::ForgetJournaledConcept(CConcept* pConcept)
+{
+	// a concept with the same address might be created later on
+	c2iJournaledSinceMark.erase(pConcept);
+
+	// check if the journal refers to this concept at all
+	if (c2iJournalRefs.find(pConcept) == c2iJournalRefs.end())
+		return;
+
+	// find the last entry referring to it, and discard up to there
+	int i = djJournal.size() - 1;
+	while ((i >= 0) && (djJournal[i].pConcept != pConcept)) i--;
+	discardJournalUpTo(iJournalBase + i + 1);
+}
+
+// M: Drops the journal entries referring to an agent which is being 
+//    destroyed (same as above)
+void CDMCoreAgent::ForgetJournaledAgent(CDialogAgent* pdaAgent)
+{
+	// an agent with the same address might be created later on
+	spdaJournaledSinceMark.erase(pdaAgent);
+
+	// check if the journal refers to this agent at all
+	if (da2iJournalRefs.find(pdaAgent) == da2iJournalRefs.end())
+		return;
+
+	// find the last entry referring to it, and discard up to there
+	int i = djJournal.size() - 1;
+	while ((i >= 0) && (djJournal[i].pdaAgent != pdaAgent)) i--;
+	discardJournalUpTo(iJournalBase + i + 1);
+}
+
+// M: Marks a new dialog state in the journal, and returns its journal index
+int CDMCoreAgent::MarkDialogStateJournal()
+{
+	int iMark = iJournalBase + djJournal.size();
+	diJournalMarks.push_back(iMark);
+
+	// concepts and agents will be recorded again when they next change
+	c2iJournaledSinceMark.clear();
+	spdaJournaledSinceMark.clear();
+
+	// keep only the entries needed to roll back over the last 
+	// STATE_JOURNAL_DEPTH dialog states
+	if (diJournalMarks.size() > STATE_JOURNAL_DEPTH)
+	{
+		diJournalMarks.pop_front();
+		discardJournalUpTo(diJournalMarks.front());
+	}
+
+	return iMark;
+}
+
+// M: Clears the journal
+void CDMCoreAgent::ClearDialogStateJournal()
+{
+	// move the base past the current end, so that none of the previously
+	// marked dialog states can be rolled back to
+	discardJournalUpTo(iJournalBase + djJournal.size());
+	iJournalBase++;
+	diJournalMarks.clear();
+	c2iJournaledSinceMark.clear();
+	spdaJournaledSinceMark.clear();
+}
+
+// M: Records an execution stack push in the journal
+void CDMCoreAgent::journalStackPush(TExecutionStackItem esiItem)
+{
+	// the execution stack is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	if (bJournalReplay) return;
+
+	TJournalEntry jeEntry;
+	jeEntry.jetType = jetStackPush;
+	jeEntry.pConcept = NULL;
+	jeEntry.pSnapshot = NULL;
+	jeEntry.pdaAgent = esiItem.pdaAgent;
+	jeEntry.esiItem = esiItem;
+	jeEntry.iStackPosition = 0;
+	pushJournalEntry(jeEntry);
+}
+
+// M: Records the erasure of an execution stack item in the journal
+void CDMCoreAgent::journalStackErase(TExecutionStack::iterator iPtr)
+{
+	// the execution stack is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	if (bJournalReplay) return;
+
+	TJournalEntry jeEntry;
+	jeEntry.jetType = jetStackErase;
+	jeEntry.pConcept = NULL;
+	jeEntry.pSnapshot = NULL;
+	jeEntry.pdaAgent = iPtr->pdaAgent;
+	jeEntry.esiItem = *iPtr;
+	jeEntry.iStackPosition = distance(esExecutionStack.begin(), iPtr);
+	pushJournalEntry(jeEntry);
+}
+
+// M: Adds an entry at the end of the journal
+void CDMCoreAgent::pushJournalEntry(TJournalEntry& rjeEntry)
+{
+	if (rjeEntry.pConcept)
+		c2iJournalRefs[rjeEntry.pConcept]++;
+	if (rjeEntry.pdaAgent)
+		da2iJournalRefs[rjeEntry.pdaAgent]++;
+	djJournal.push_back(rjeEntry);
+}
+
+// M: Releases a journal entry (the caller removes it from the journal)
+void CDMCoreAgent::releaseJournalEntry(TJournalEntry& rjeEntry)
+{
+	if (rjeEntry.pConcept && (--c2iJournalRefs[rjeEntry.pConcept] == 0))
+		c2iJournalRefs.erase(rjeEntry.pConcept);
+	if (rjeEntry.pdaAgent && (--da2iJournalRefs[rjeEntry.pdaAgent] == 0))
+		da2iJournalRefs.erase(rjeEntry.pdaAgent);
+	if (rjeEntry.pSnapshot)
+	{
+		CConcept::DeleteJournalSnapshot(rjeEntry.pSnapshot);
+		rjeEntry.pSnapshot = NULL;
+	}
+}
+
+// M: Discards the journal entries before a certain journal index
+void CDMCoreAgent::discardJournalUpTo(int iJournalIndex)
+{
+	while (!djJournal.empty() && (iJournalBase < iJournalIndex))
+	{
+		releaseJournalEntry(djJournal.front());
+		djJournal.pop_front();
+		iJournalBase++;
+	}
+	// and drop the marks that can no longer be rolled back to
+	while (!diJournalMarks.empty() && (diJournalMarks.front() < iJournalBase))
+		diJournalMarks.pop_front();
+}
+
+// M: Undoes the change recorded in a journal entry
+void CDMCoreAgent::undoJournalEntry(TJournalEntry& rjeEntry)
+{
+	switch (rjeEntry.jetType)
+	{
+	case jetConcept:
+		rjeEntry.pConcept->RestoreFromJournalSnapshot(rjeEntry.pSnapshot);
+		break;
+
+	case jetAgent:
+		rjeEntry.pdaAgent->SetStatus(rjeEntry.dasStatus);
+		break;
+
+	case jetStackPush:
+		// the pushed agent has to be on top of the stack
+		if (esExecutionStack.empty() ||
+			(esExecutionStack.front().pdaAgent != rjeEntry.pdaAgent))
+			FatalError("Dialog state journal is out of sync with the execution"
+			" stack (" + rjeEntry.pdaAgent->GetName() + " not on top).");
+		esExecutionStack.pop_front();
+		CDialogAgent::IncrementDialogStateGeneration();
+		break;
+
+	case jetStackErase:
+		{
+			TExecutionStack::iterator iPtr = esExecutionStack.begin();
+			advance(iPtr, rjeEntry.iStackPosition);
+			esExecutionStack.insert(iPtr, rjeEntry.esiItem);
+			CDialogAgent::IncrementDialogStateGeneration();
+		}
+		break;
+	}
+}
+
 // A: Rolls back to a previous dialog state (e.g. after a user barge-in)
 void CDMCoreAgent::rollBackDialogState(int iState)
 {
@@ -2597,17 +2914,17 @@ void CDMCoreAgent::rollBackDialogState(int iState)
 
 	for (int i = ehExecutionHistory.size() - 1; i > iLastEHIndex; i--)
 	{
-		TExecutionHistoryItem ehi = ehExecutionHistory[i];
+		TExecutionHistoryItem& rehi = ehExecutionHistory[i];
 		// if the agents were indeed executed and not yet canceled
-		if (ehi.bExecuted && !ehi.bCanceled)
+		if (rehi.bExecuted && !rehi.bCanceled)
 		{
 			// Undo the execution of the agent
 			CDialogAgent *pdaAgent = (CDialogAgent*)
-				AgentsRegistry[ehi.sCurrentAgent];
+				AgentsRegistry[rehi.sCurrentAgent];
 			pdaAgent->Undo();
 
 			// Mark the execution as canceled
-			ehi.bCanceled = true;
+			rehi.bCanceled = true;
 
 			Log(DMCORE_STREAM, "Canceled execution of agent %s (state=%d,"
 				"iEHIndex=%d).", pdaAgent->GetName().c_str(),
@@ -2617,8 +2934,40 @@ void CDMCoreAgent::rollBackDialogState(int iState)
 
 	// Now updates the execution stack and the agenda
 	TDialogState dsCurrentState = (*pStateManager)[iState];
+
+	// undo the journal back to the target state; this restores the 
+	// concepts, the agents' status and the execution stack
+	if (dsCurrentState.iJournalIndex >= iJournalBase)
+	{
+		int iUndone = 0;
+		bJournalReplay = true;
+		while ((int)(iJournalBase + djJournal.size()) > 
+			dsCurrentState.iJournalIndex)
+		{
+			undoJournalEntry(djJournal.back());
+			releaseJournalEntry(djJournal.back());
+			djJournal.pop_back();
+			iUndone++;
+		}
+		bJournalReplay = false;
+
+		// drop the marks of the states we rolled back over
+		while (!diJournalMarks.empty() && 
+			(diJournalMarks.back() > dsCurrentState.iJournalIndex))
+			diJournalMarks.pop_back();
+
+		Log(DMCORE_STREAM, "Undid %d dialog state journal entries.", iUndone);
+	}
+	else
+	{
+		// o/w the journal does not go back that far, so only the execution 
+		// stack can be restored
+		Warning(FormatString("Dialog state journal does not reach back to "
+			"state %d. Concepts and agents were not rolled back.", iState));
+		esExecutionStack = dsCurrentState.esExecutionStack;
+	}
+
 	fsFloorStatus = dsCurrentState.fsFloorStatus;
-	esExecutionStack = dsCurrentState.esExecutionStack;
 	eaAgenda = dsCurrentState.eaAgenda;
 	saSystemAction = dsCurrentState.saSystemAction;
 	// There is no need to recompile the agenda
@@ -2637,6 +2986,7 @@ void CDMCoreAgent::rollBackDialogState(int iState)
 // Dذʷ¼ĴС
 int CDMCoreAgent::GetBindingHistorySize()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	return bhBindingHistory.size();
 }
 
@@ -2644,6 +2994,7 @@ int CDMCoreAgent::GetBindingHistorySize()
 // Dָʷ¼İ󶨽ָ
 const TBindingsDescr& CDMCoreAgent::GetBindingResult(int iBindingHistoryIndex)
 {
+	CDialogAgent::RecordDialogStateDependency();
 	// check that the index is within bounds
 	if ((iBindingHistoryIndex >= 0) ||
 		(iBindingHistoryIndex < -(int)bhBindingHistory.size()))
@@ -2791,6 +3142,7 @@ void CDMCoreAgent::SignalAcceptOnConcept(CConcept* pConcept)
 // ִջջagent
 CDialogAgent* CDMCoreAgent::GetAgentInFocus()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	TExecutionStack::iterator iPtr;
 	for (iPtr = esExecutionStack.begin(); iPtr != esExecutionStack.end(); iPtr++)
 	{
@@ -2808,6 +3160,7 @@ CDialogAgent* CDMCoreAgent::GetAgentInFocus()
 // ִжջ
 CDialogAgent* CDMCoreAgent::GetDTSAgentInFocus()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	TExecutionStack::iterator iPtr;
 	for (iPtr = esExecutionStack.begin();
 		iPtr != esExecutionStack.end();
@@ -2824,6 +3177,7 @@ CDialogAgent* CDMCoreAgent::GetDTSAgentInFocus()
 // DָĴڽ㣬򷵻true
 bool CDMCoreAgent::AgentIsInFocus(CDialogAgent* pdaDialogAgent)
 {
+	CDialogAgent::RecordDialogStateDependency();
 
 	// if it's not executable, return false
 	if (!pdaDialogAgent->IsExecutable())
@@ -2845,6 +3199,7 @@ bool CDMCoreAgent::AgentIsInFocus(CDialogAgent* pdaDialogAgent)
 CDialogAgent* CDMCoreAgent::GetAgentPreviouslyInFocus(
 	CDialogAgent* pdaDialogAgent)
 {
+	CDialogAgent::RecordDialogStateDependency();
 	if (esExecutionStack.empty())
 		return NULL;
 	else
@@ -2877,6 +3232,7 @@ CDialogAgent* CDMCoreAgent::GetAgentPreviouslyInFocus(
 CDialogAgent* CDMCoreAgent::GetDTSAgentPreviouslyInFocus(
 	CDialogAgent* pdaDialogAgent)
 {
+	CDialogAgent::RecordDialogStateDependency();
 	if (esExecutionStack.empty())
 		return NULL;
 	else
@@ -2931,6 +3287,7 @@ CDialogAgent* CDMCoreAgent::GetCurrentMainTopicAgent()
 // Dǻ⣬򷵻true  => ǰڵִջУTrue
 bool CDMCoreAgent::AgentIsActive(CDialogAgent* pdaDialogAgent)
 {
+	CDialogAgent::RecordDialogStateDependency();
 	TExecutionStack::iterator iPtr;
 	for (iPtr = esExecutionStack.begin(); iPtr != esExecutionStack.end(); iPtr++)
 	{
@@ -3014,5 +3371,152 @@ void CDMCoreAgent::PopGroundingAgentsFromExecutionStack()
 // A: Returns the last input turn number
 int CDMCoreAgent::GetLastInputTurnNumber()
 {
+	CDialogAgent::RecordDialogStateDependency();
 	return iTurnNumber;
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+//
+// MEMORY ACCOUNTING METHODS
+//
+//-----------------------------------------------------------------------------
+
+// M: computes the memory accounting of the session: the dialog task tree 
+//    (agents, concepts and their history, grounding models), the histories
+//    kept by the core agents and the dialog state journal. The hypothesis 
+//    pools and the shared strings table are process-wide, and are included
+//    since a process runs one session at a time
+TMemoryAccount CDMCoreAgent::GetMemoryAccount()
+{
+	TMemoryAccount maAccount;
+
+	// the dialog task tree
+	if (pDTTManager && pDTTManager->GetDialogTaskTreeRoot())
+		pDTTManager->GetDialogTaskTreeRoot()->AccountMemoryUsage(maAccount);
+
+	// the hypotheses, through their pools
+	AccountMemory(maAccount, MA_HYPOTHESES, CIntHyp::GetPool().GetBlocksInUse(),
+		CIntHyp::GetPool().GetBytesReserved());
+	AccountMemory(maAccount, MA_HYPOTHESES, CFloatHyp::GetPool().GetBlocksInUse(),
+		CFloatHyp::GetPool().GetBytesReserved());
+	AccountMemory(maAccount, MA_HYPOTHESES, CBoolHyp::GetPool().GetBlocksInUse(),
+		CBoolHyp::GetPool().GetBytesReserved());
+	AccountMemory(maAccount, MA_HYPOTHESES, CStringHyp::GetPool().GetBlocksInUse(),
+		CStringHyp::GetPool().GetBytesReserved());
+	AccountMemory(maAccount, MA_HYPOTHESES, CStructHyp::GetPool().GetBlocksInUse(),
+		CStructHyp::GetPool().GetBytesReserved());
+
+	// the shared strings (the string concept values)
+	AccountMemory(maAccount, MA_SHARED_STRINGS, CSharedString::GetTableSize(),
+		CSharedString::GetTableBytes());
+
+	// the execution history
+	int iBytes = (int)(ehExecutionHistory.capacity() *
+		sizeof(TExecutionHistoryItem));
+	for (unsigned int i = 0; i < ehExecutionHistory.size(); i++)
+	{
+		TExecutionHistoryItem& rehiItem = ehExecutionHistory[i];
+		iBytes += StringHeapBytes(rehiItem.sCurrentAgent) +
+			StringHeapBytes(rehiItem.sCurrentAgentType) +
+			StringHeapBytes(rehiItem.sScheduledBy) +
+			(int)(rehiItem.vtExecutionTimes.capacity() * sizeof(_timeb));
+	}
+	AccountMemory(maAccount, MA_EXECUTION_HISTORY, ehExecutionHistory.size(),
+		iBytes);
+
+	// the binding history
+	iBytes = (int)(bhBindingHistory.capacity() * sizeof(TBindingsDescr));
+	for (unsigned int i = 0; i < bhBindingHistory.size(); i++)
+	{
+		TBindingsDescr& rbdBindings = bhBindingHistory[i];
+		iBytes += StringHeapBytes(rbdBindings.sEventType) +
+			(int)(rbdBindings.vbBindings.capacity() * sizeof(TBinding)) +
+			(int)(rbdBindings.vfcuForcedUpdates.capacity() *
+			sizeof(TForcedConceptUpdate));
+		for (unsigned int b = 0; b < rbdBindings.vbBindings.size(); b++)
+		{
+			TBinding& rbBinding = rbdBindings.vbBindings[b];
+			iBytes += StringHeapBytes(rbBinding.sGrammarExpectation) +
+				StringHeapBytes(rbBinding.sValue) +
+				StringHeapBytes(rbBinding.sAgentName) +
+				StringHeapBytes(rbBinding.sConceptName) +
+				StringHeapBytes(rbBinding.sReasonDisabled);
+		}
+		for (unsigned int f = 0; f < rbdBindings.vfcuForcedUpdates.size(); f++)
+			iBytes += StringHeapBytes(
+			rbdBindings.vfcuForcedUpdates[f].sConceptName);
+	}
+	AccountMemory(maAccount, MA_BINDING_HISTORY, bhBindingHistory.size(),
+		iBytes);
+
+	// the dialog state journal (the objects counted are the concept 
+	// snapshots)
+	AccountMemory(maAccount, MA_STATE_JOURNAL, 0,
+		(int)(djJournal.size() * sizeof(TJournalEntry) +
+		diJournalMarks.size() * sizeof(int)));
+	for (unsigned int i = 0; i < djJournal.size(); i++)
+		if (djJournal[i].pSnapshot)
+			CConcept::AccountJournalSnapshotMemory(djJournal[i].pSnapshot,
+			maAccount, MA_STATE_JOURNAL);
+
+	// the state and output histories
+	if (pStateManager)
+		pStateManager->AccountMemoryUsage(maAccount);
+	if (pOutputManager)
+		pOutputManager->AccountMemoryUsage(maAccount);
+
+	// the compiled grounding policies
+	if (pGroundingManager)
+		pGroundingManager->AccountMemoryUsage(maAccount);
+
+	return maAccount;
+}
+
+// M: returns the memory accounting of the session as a string
+string CDMCoreAgent::GetMemoryAccountAsString()
+{
+	TMemoryAccount maAccount = GetMemoryAccount();
+	return MemoryAccountToString(maAccount);
+}
+
+// M: dumps the memory accounting of the session to the log
+void CDMCoreAgent::LogMemoryAccount()
+{
+	Log(DMCORE_STREAM, "Session memory accounting (dumped below):\n%s",
+		GetMemoryAccountAsString().c_str());
+}
+
+// M: returns the number of heap bytes held by an expectation agenda (the
+//    expectations, and the compiled levels)
+int CDMCoreAgent::GetExpectationAgendaHeapBytes(TExpectationAgenda& reaAgenda)
+{
+	int iBytes = (int)(reaAgenda.celSystemExpectations.capacity() *
+		sizeof(TConceptExpectation));
+	for (unsigned int i = 0; i < reaAgenda.celSystemExpectations.size(); i++)
+	{
+		TConceptExpectation& rceExpectation =
+			reaAgenda.celSystemExpectations[i];
+		iBytes += StringHeapBytes(rceExpectation.sConceptName) +
+			StringHeapBytes(rceExpectation.sGrammarExpectation) +
+			StringHeapBytes(rceExpectation.sExplicitValue) +
+			StringHeapBytes(rceExpectation.sBindingFilterName) +
+			StringHeapBytes(rceExpectation.sReasonDisabled) +
+			StringHeapBytes(rceExpectation.sExpectationType) +
+			(int)(rceExpectation.vsOtherConceptNames.capacity() *
+			sizeof(string));
+	}
+
+	iBytes += (int)(reaAgenda.vCompiledExpectations.capacity() *
+		sizeof(TCompiledExpectationLevel));
+	for (unsigned int l = 0; l < reaAgenda.vCompiledExpectations.size(); l++)
+	{
+		TMapCE::iterator iPtr;
+		for (iPtr = reaAgenda.vCompiledExpectations[l].mapCE.begin();
+			iPtr != reaAgenda.vCompiledExpectations[l].mapCE.end();
+			iPtr++)
+			iBytes += (int)(sizeof(TMapCE::value_type) + TREE_NODE_OVERHEAD) +
+			StringHeapBytes(iPtr->first) +
+			(int)(iPtr->second.capacity() * sizeof(int));
+	}
+	return iBytes;
+}
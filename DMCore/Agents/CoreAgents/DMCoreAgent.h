@@ -54,6 +54,14 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added expectationAgendaLevelToBroadcastString
+//   [2026-10-19] (mbrenner): added the memory accounting of the session
+//   [2026-10-19] (mbrenner): the temporary concepts used in binding are kept
+//                            as scratch concepts, released together after
+//                            the binding phase
+//   [2026-10-19] (mbrenner): added the dialog state journal, a per-state undo log
+//                            of concept, agent status and execution stack
+//                            changes used by rollBackDialogState
 //   [2007-03-05] (antoine): changed Execute so that grounding and dialog agents
 //							 are only executed once the floor is free and all 
 //							 pending prompt notifications have been received 
@@ -334,6 +342,43 @@ typedef struct
 	// Ҫϵͳһв
 } TSystemActionOnConcept;
 
+//-----------------------------------------------------------------------------
+// M: Auxiliary type definitions for the dialog state journal. The journal 
+//    records, between two consecutive dialog states, the information needed
+//    to undo the changes on concepts, on agents' status and on the execution
+//    stack; rolling back to a previous state then amounts to undoing the 
+//    journal entries in reverse order
+//-----------------------------------------------------------------------------
+
+// M: the number of dialog states we can roll back over
+#define STATE_JOURNAL_DEPTH 10
+
+// M: types of journal entries
+typedef enum
+{
+	jetConcept,			// a concept changed (a snapshot is stored)
+	jetAgent,			// an agent's status changed
+	jetStackPush,		// an agent was pushed on the execution stack
+	jetStackErase,		// an agent was erased from the execution stack
+} TJournalEntryType;
+
+// M: structure describing a journal entry
+typedef struct
+{
+	TJournalEntryType jetType;		// the type of the entry
+	CConcept* pConcept;				// the concept (for jetConcept)
+	TConceptJournalSnapshot* pSnapshot;// the concept snapshot (for 
+									//  jetConcept)
+	CDialogAgent* pdaAgent;			// the agent (for all other types)
+	TDialogAgentStatus dasStatus;	// the agent status (for jetAgent)
+	TExecutionStackItem esiItem;	// the stack item (for jetStackErase)
+	int iStackPosition;				// the position on the stack (for 
+									//  jetStackErase)
+} TJournalEntry;
+
+// M: definition of the journal
+typedef deque<TJournalEntry, allocator<TJournalEntry> > TDialogStateJournal;
+
 // D: definition for customized start over routine
 // һԶĿʼ
 typedef void(*TCustomStartOverFunct)();
@@ -392,6 +437,20 @@ private:
 
 	TFloorStatus fsFloorStatus;             // indicates who has the floor		// floor ״̬[δ֪ϵͳû]
 	int iTurnNumber;						// stores the current turn number	//ǰturn
+	TDialogStateJournal djJournal;			// the dialog state journal
+	int iJournalBase;						// the journal index of the first
+											//  entry in djJournal
+	deque<int> diJournalMarks;				// the journal indices of the last
+											//  dialog states
+	map<CConcept*, int> c2iJournaledSinceMark;// the concepts (and their 
+											//  parts) and agents already
+	set<CDialogAgent*> spdaJournaledSinceMark;//  recorded since the last state
+	map<CConcept*, int> c2iJournalRefs;		// the number of journal entries
+	map<CDialogAgent*, int> da2iJournalRefs;//  referring to each concept/agent
+	bool bJournalReplay;					// indicates that the journal is
+											//  being replayed
+	TConceptPointersVector vpScratchConcepts;// the temporary concepts used
+											//  in the current binding phase
 	TCustomStartOverFunct csoStartOverFunct;// a custom start over function		//Զ¿ʼ
 
 	//---------------------------------------------------------------------
@@ -619,6 +678,39 @@ public:
 	void SignalUnplannedImplicitConfirmOnConcept(int iState, CConcept* pConcept);
 	void SignalAcceptOnConcept(CConcept* pConcept);
 
+	//---------------------------------------------------------------------
+	// Methods for the dialog state journal
+	//---------------------------------------------------------------------
+
+	// Record a concept / an agent's status before it changes
+	void JournalConceptChange(CConcept* pConcept, int iParts);
+	void JournalAgentChange(CDialogAgent* pdaAgent);
+
+	// Drop the journal entries referring to a concept / agent which is 
+	// being destroyed
+	void ForgetJournaledConcept(CConcept* pConcept);
+	void ForgetJournaledAgent(CDialogAgent* pdaAgent);
+
+	// Marks a new dialog state in the journal, and returns its index
+	int MarkDialogStateJournal();
+
+	// Clears the journal
+	void ClearDialogStateJournal();
+
+	//---------------------------------------------------------------------
+	// Methods for memory accounting
+	//---------------------------------------------------------------------
+
+	// Computes the memory accounting of the session
+	TMemoryAccount GetMemoryAccount();
+
+	// Returns the memory accounting as a string, and dumps it to the log
+	string GetMemoryAccountAsString();
+	void LogMemoryAccount();
+
+	// Returns the number of heap bytes held by an expectation agenda
+	int GetExpectationAgendaHeapBytes(TExpectationAgenda& reaAgenda);
+
 	//---------------------------------------------------------------------
 	// Methods for floor handling
 	//---------------------------------------------------------------------
@@ -650,6 +742,24 @@ private:
 	// ɾgrouding agent
 	void popGroundingAgentsFromExecutionStack(TStringVector& rvsAgentsEliminated);
 
+	//---------------------------------------------------------------------
+	// DMCoreManagerAgent private methods related to the dialog state journal
+	//---------------------------------------------------------------------
+
+	// Record execution stack changes in the journal
+	void journalStackPush(TExecutionStackItem esiItem);
+	void journalStackErase(TExecutionStack::iterator iPtr);
+
+	// Add and release journal entries
+	void pushJournalEntry(TJournalEntry& rjeEntry);
+	void releaseJournalEntry(TJournalEntry& rjeEntry);
+
+	// Discard the journal entries before a certain journal index
+	void discardJournalUpTo(int iJournalIndex);
+
+	// Undo the change recorded in a journal entry
+	void undoJournalEntry(TJournalEntry& rjeEntry);
+
 	//---------------------------------------------------------------------
 	// DMCoreManagerAgent private methods related to the input pass
 	// ˽з
@@ -681,6 +791,8 @@ private:
 	string expectationAgendaToString();
 	string expectationAgendaToBroadcastString();
 	string expectationAgendaToBroadcastString(TExpectationAgenda eaBAgenda);
+	string expectationAgendaLevelToBroadcastString(
+		TExpectationAgenda& reaBAgenda, unsigned int iLevel);
 
 	// Method for logging the bindings description
 	//log¼binding η
@@ -702,6 +814,12 @@ private:
 	// ִжԸʵʰ
 	void performConceptBinding(string sSlotName, string sSlotValue, float fConfidence, int iExpectationIndex, bool bIsComplete);
 
+	// Helper functions for the scratch concepts (temporary concepts used
+	// during binding, which live until the end of the binding phase and 
+	// are then released together)
+	CConcept* newScratchConcept(CConcept& rAConcept);
+	void releaseScratchConcepts();
+
 	// Helper function that performs a binding through a customized binding filter
 	//ͨԶ󶨹ִа
 	void performCustomConceptBinding(int iExpectationIndex);
@@ -52,6 +52,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): MountAgentsFromArrayConcept mounts the agents 
+//                            in one pass
+//   [2026-10-19] (mbrenner): added pre/post-order interval labels on the
+//                            dialog tree, and pointer-based ancestry checks
 //   [2004-12-23] (antoine): modified constructor, agent factory, etc to handle
 //							  configurations
 //   [2002-10-22] (dbohus): added support for destroying and for recreating
@@ -76,7 +80,8 @@
 CDTTManagerAgent::CDTTManagerAgent(string sAName, string sAConfiguration, string sAType) :
 CAgent(sAName, sAConfiguration, sAType)
 {
-	// nothing here
+	pdaDialogTaskRoot = NULL;
+	bTreeLabelsValid = false;
 }
 
 // D: destructor - destroys all the agents that were left in the dialog task tree
@@ -200,7 +205,9 @@ void CDTTManagerAgent::DestroyDialogTree()
 		// then delete
 		// ɾڵ
 		delete pdaDialogTaskRoot;
+		pdaDialogTaskRoot = NULL;
 	}
+	bTreeLabelsValid = false;
 	Log(DTTMANAGER_STREAM, "Dialog Tree Destruction Phase completed successfully.");
 }
 
@@ -307,6 +314,8 @@ void CDTTManagerAgent::UnMountAgent(CDialogAgent* pdaWho)
 			// if it has no parent, then that is a fatal error
 			FatalError("Cannot unmount a root dialog agent.");
 		}
+		// removing a subtree leaves the labels on the rest of the tree 
+		// consistent, so they do not need to be recomputed
 		// øڵ㣬жصǰڵ
 		pdaWho->GetParent()->DeleteSubAgent(pdaWho);
 	}
@@ -332,20 +341,35 @@ void CDTTManagerAgent::MountAgentsFromArrayConcept(
 	//  and # will be replaced by the index
 {
 
-	// go through the array and for each element create and mount an agent
-	for (int i = 0; i < pdaParent->C(sArrayConceptName).GetSize(); i++)
+	// get the array concept (once)
+	CConcept& rArrayConcept = pdaParent->C(sArrayConceptName);
+	int iSize = rArrayConcept.GetSize();
+	if (iSize == 0)
+		return;
+
+	Log(DTTMANAGER_STREAM, "Mounting %d %s agents as %s of %s .", iSize,
+		sAgentsType.c_str(), MountingMethodAsString[mmAsLastChild].c_str(),
+		pdaParent->GetName().c_str());
+
+	// create the agents for all the elements
+	TAgentsVector vpdaNewAgents;
+	vpdaNewAgents.reserve(iSize);
+	for (int i = 0; i < iSize; i++)
+		vpdaNewAgents.push_back((CDialogAgent *)AgentsRegistry.CreateAgent(
+		sAgentsType, ReplaceSubString(sAgentsName, "#", FormatString("%d", i))));
+
+	// mount them all as the last children of the parent
+	pdaParent->AddSubAgents(vpdaNewAgents);
+
+	// and now initialize each of them
+	for (int i = 0; i < iSize; i++)
 	{
-		CDialogAgent* pNewAgent =
-			pDTTManager->MountAgent(pdaParent, sAgentsType,
-			ReplaceSubString(sAgentsName, "#", FormatString("%d", i)),
-			"", mmAsLastChild);
+		CDialogAgent* pNewAgent = vpdaNewAgents[i];
+		pNewAgent->Initialize();
 		// if the agent has a concept associated with it, give it the part
 		//  of the array 
 		if (sAgentsConceptName != "")
-		{
-			pNewAgent->C(sAgentsConceptName) =
-				pdaParent->C("%s.%d", sArrayConceptName.c_str(), i);
-		}
+			pNewAgent->C(sAgentsConceptName) = rArrayConcept[i];
 		// set the agent index in the array        
 		pNewAgent->SetDynamicAgentID(
 			ReplaceSubString(sAgentsDynamicID, "#", FormatString("%d", i)));
@@ -407,6 +431,69 @@ bool CDTTManagerAgent::IsSiblingOf(string sAgent1Path, string sAgent2Path)
 	return GetParentName(sAgent1Path) == GetParentName(sAgent2Path);
 }
 
+// M: returns true if pdaParentAgent is the parent of pdaAgent
+bool CDTTManagerAgent::IsParentOf(CDialogAgent* pdaParentAgent, CDialogAgent* pdaAgent)
+{
+	return pdaAgent && pdaParentAgent && (pdaAgent->GetParent() == pdaParentAgent);
+}
+
+// M: returns true if pdaChildAgent is a child of pdaAgent
+bool CDTTManagerAgent::IsChildOf(CDialogAgent* pdaChildAgent, CDialogAgent* pdaAgent)
+{
+	return IsParentOf(pdaAgent, pdaChildAgent);
+}
+
+// M: returns true if pdaAncestorAgent is an ancestor of pdaAgent. Uses the 
+//    interval labels on the tree; agents that are not labeled (i.e. not 
+//    attached to the tree) are compared by their paths
+bool CDTTManagerAgent::IsAncestorOf(CDialogAgent* pdaAncestorAgent, CDialogAgent* pdaAgent)
+{
+	if (!pdaAncestorAgent || !pdaAgent)
+		return false;
+	if (!bTreeLabelsValid)
+		labelDialogTree();
+	if ((pdaAncestorAgent->GetPreOrderLabel() < 0) ||
+		(pdaAgent->GetPreOrderLabel() < 0))
+		return IsAncestorOf(pdaAncestorAgent->GetName(), pdaAgent->GetName());
+	return (pdaAncestorAgent->GetPreOrderLabel() < pdaAgent->GetPreOrderLabel()) &&
+		(pdaAgent->GetPostOrderLabel() < pdaAncestorAgent->GetPostOrderLabel());
+}
+
+// M: returns true if pdaAncestorAgent is an ancestor of pdaAgent or if they
+//    are the same agent
+bool CDTTManagerAgent::IsAncestorOrEqualOf(CDialogAgent* pdaAncestorAgent, CDialogAgent* pdaAgent)
+{
+	if (pdaAncestorAgent && (pdaAncestorAgent == pdaAgent))
+		return true;
+	return IsAncestorOf(pdaAncestorAgent, pdaAgent);
+}
+
+// M: returns true if pdaDescendantAgent is a descendant of pdaAgent
+bool CDTTManagerAgent::IsDescendantOf(CDialogAgent* pdaDescendantAgent, CDialogAgent* pdaAgent)
+{
+	return IsAncestorOf(pdaAgent, pdaDescendantAgent);
+}
+
+// M: returns true if the 2 agents are siblings
+bool CDTTManagerAgent::IsSiblingOf(CDialogAgent* pdaAgent1, CDialogAgent* pdaAgent2)
+{
+	return pdaAgent1 && pdaAgent2 && (pdaAgent1->GetParent() == pdaAgent2->GetParent());
+}
+
+// M: marks the labels on the dialog task tree as out of date
+void CDTTManagerAgent::InvalidateDialogTreeLabels()
+{
+	bTreeLabelsValid = false;
+}
+
+// M: assigns the pre/post-order labels on the dialog task tree
+void CDTTManagerAgent::labelDialogTree()
+{
+	if (pdaDialogTaskRoot)
+		pdaDialogTaskRoot->AssignTreeLabels(0);
+	bTreeLabelsValid = true;
+}
+
 
 //-----------------------------------------------------------------------------
 //
@@ -52,6 +52,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): MountAgentsFromArrayConcept mounts the agents 
+//                            in one pass
+//   [2026-10-19] (mbrenner): added pre/post-order interval labels on the
+//                            dialog tree, and pointer-based ancestry checks
 //   [2004-12-23] (antoine): modified constructor, agent factory, etc to handle
 //							  configurations
 //   [2002-10-22] (dbohus): added support for destroying and for recreating
@@ -118,6 +122,10 @@ private:
 	// a vector containing the information about the discourse agents to be used	// ʹõagentϢб
 	vector<TDiscourseAgentInfo, allocator<TDiscourseAgentInfo> > vdaiDAInfo;
 
+	// indicates if the pre/post-order labels on the dialog task tree are 
+	// up to date
+	bool bTreeLabelsValid;
+
 public:
 
 	//---------------------------------------------------------------------
@@ -193,6 +201,24 @@ public:
 	bool IsAncestorOrEqualOf(string sAncestorAgentPath, string sAgentPath);
 	bool IsDescendantOf(string sDescendantAgentPath, string sAgentPath);
 	bool IsSiblingOf(string sAgent1Path, string sAgent2Path);
+
+	// Pointer-based versions of the relationship methods: ancestry checks 
+	// are answered from the pre/post-order labels on the tree
+	//
+	bool IsParentOf(CDialogAgent* pdaParentAgent, CDialogAgent* pdaAgent);
+	bool IsChildOf(CDialogAgent* pdaChildAgent, CDialogAgent* pdaAgent);
+	bool IsAncestorOf(CDialogAgent* pdaAncestorAgent, CDialogAgent* pdaAgent);
+	bool IsAncestorOrEqualOf(CDialogAgent* pdaAncestorAgent, CDialogAgent* pdaAgent);
+	bool IsDescendantOf(CDialogAgent* pdaDescendantAgent, CDialogAgent* pdaAgent);
+	bool IsSiblingOf(CDialogAgent* pdaAgent1, CDialogAgent* pdaAgent2);
+
+	// Marks the tree labels as out of date (called whenever an agent gets 
+	// attached to the tree); they are recomputed on the next query
+	void InvalidateDialogTreeLabels();
+
+private:
+	// Assigns the pre/post-order labels on the whole dialog task tree
+	void labelDialogTree();
 };
 
 //-----------------------------------------------------------------------------
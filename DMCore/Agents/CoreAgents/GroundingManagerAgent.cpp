@@ -53,6 +53,24 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): batched concept grounding requests check that the
+//                            queue is not locked
+//   [2026-10-19] (mbrenner): the policy caches are keyed by policy file, file
+//                            time and text hash (recordPolicyFile)
+//   [2026-10-19] (mbrenner): the grounding queue queries consult the batched
+//                            requests instead of issuing them; the batch is
+//                            issued at the end of binding, or when the queue
+//                            changes
+//   [2026-10-19] (mbrenner): belief updating features are precomputed into a dense
+//                            vector; the Calista models are compiled to weight
+//                            vectors in LoadBeliefUpdatingModel and scored by
+//                            ComputeBeliefUpdatingScores
+//   [2026-10-19] (mbrenner): policies loaded from a string are no longer read
+//                            twice from disk; recorded the policy file times
+//   [2026-10-19] (mbrenner): added the compiled policies, shared by the 
+//                            grounding models
+//   [2026-10-19] (mbrenner): added GetBeliefUpdatingModel (BUM_* constants)
+//   [2026-10-19] (mbrenner): added batching of concept grounding requests
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
@@ -84,6 +102,13 @@ CAgent(sAName, sAConfiguration, sAType)
 	// set the lock to false
 	// ־ = false
 	bLockedGroundingRequests = false;
+
+	// no open batch of grounding requests
+	iGroundingRequestsBatchDepth = 0;
+
+	// no belief updating features precomputed
+	iConceptIdFeature = -1;
+	bBeliefUpdatingFeaturesPrecomputed = false;
 }
 
 // D: Virtual destructor 
@@ -92,6 +117,8 @@ CGroundingManagerAgent::~CGroundingManagerAgent()
 	// release all external policies
 	// ͷⲿ
 	ReleaseExternalPolicyInterfaces();
+	// and the compiled policies
+	ReleaseCompiledPolicies();
 }
 
 //-----------------------------------------------------------------------------
@@ -127,6 +154,7 @@ void CGroundingManagerAgent::SetConfiguration(string sAGroundingManagerConfigura
 	gmcConfig.bGroundConcepts = false;
 	gmcConfig.bGroundTurns = false;
 	gmcConfig.sBeliefUpdatingModelName = "npu";
+	gmcConfig.iBeliefUpdatingModel = BUM_NPU;
 
 	for (unsigned int i = 0; i < vsTokens.size(); i++)
 	{
@@ -136,6 +164,7 @@ void CGroundingManagerAgent::SetConfiguration(string sAGroundingManagerConfigura
 			gmcConfig.bGroundConcepts = false;
 			gmcConfig.bGroundTurns = false;
 			gmcConfig.sBeliefUpdatingModelName = "npu";
+			gmcConfig.iBeliefUpdatingModel = BUM_NPU;
 			break;
 		}
 		else
@@ -230,7 +259,8 @@ void CGroundingManagerAgent::LoadPoliciesFromString(string sPolicies)
 				*/
 				// add it to the hash
 				// ӽHash
-				s2sPolicies.insert( STRING2STRING::value_type(sModelName, loadPolicy(sModelFileName)));
+				s2sPolicies.insert( STRING2STRING::value_type(sModelName, sModelData));
+				recordPolicyFile(sModelName, Trim(sModelFileName));
 			}
 		}
 	}
@@ -294,6 +324,7 @@ void CGroundingManagerAgent::LoadPoliciesFromFile(string sFileName)
 			{
 				// add it to the hash
 				s2sPolicies.insert(STRING2STRING::value_type(sModelName, sModelData));
+				recordPolicyFile(sModelName, Trim(sModelFileName));
 
 				// and count it up
 				iModelsCount++;
@@ -312,6 +343,26 @@ string CGroundingManagerAgent::GetPolicy(string sModelName)
 	return s2sPolicies[sModelName];
 }
 
+// M: Return the file a policy was loaded from (the model name, if the 
+//    policy was not loaded)
+string CGroundingManagerAgent::GetPolicyFile(string sModelName)
+{
+	STRING2STRING::iterator iPtr = s2sPolicyFiles.find(sModelName);
+	if (iPtr == s2sPolicyFiles.end())
+		return sModelName;
+	return iPtr->second;
+}
+
+// M: Return the key identifying the contents of a policy in the parsed and
+//    compiled policy caches (the model name, if the policy was not loaded)
+string CGroundingManagerAgent::GetPolicyKey(string sModelName)
+{
+	STRING2STRING::iterator iPtr = s2sPolicyKeys.find(sModelName);
+	if (iPtr == s2sPolicyKeys.end())
+		return sModelName;
+	return iPtr->second;
+}
+
 // D: create an external policy interface
 CExternalPolicyInterface* CGroundingManagerAgent::CreateExternalPolicyInterface(
 	string sAHost)
@@ -335,6 +386,49 @@ CExternalPolicyInterface* CGroundingManagerAgent::CreateExternalPolicyInterface(
 	}
 }
 
+// M: returns the compiled form of a policy. The policies are compiled the
+//    first time they are requested, and are then shared by all the models
+//    that use them. The policy key (see GetPolicyKey) identifies the policy
+//    file and its contents; the dimensions are added to it, so that models
+//    which parse the same policy differently do not share it
+CCompiledPolicy* CGroundingManagerAgent::GetCompiledPolicy(
+	string sPolicyKey, TPolicy& rpPolicy, int iNumActions)
+{
+	string sKey = FormatString("%s:%dx%d", sPolicyKey.c_str(),
+		(int)rpPolicy.size(), iNumActions);
+	TCompiledPolicies::iterator iPtr = mapCompiledPolicies.find(sKey);
+	if (iPtr != mapCompiledPolicies.end())
+		return iPtr->second;
+	// o/w compile it
+	CCompiledPolicy* pcpPolicy = new CCompiledPolicy(rpPolicy, iNumActions);
+	mapCompiledPolicies.insert(TCompiledPolicies::value_type(sKey, pcpPolicy));
+	return pcpPolicy;
+}
+
+// M: release the set of compiled policies
+void CGroundingManagerAgent::ReleaseCompiledPolicies()
+{
+	TCompiledPolicies::iterator iPtr;
+	for (iPtr = mapCompiledPolicies.begin(); iPtr != mapCompiledPolicies.end(); 
+		iPtr++)
+		delete iPtr->second;
+	mapCompiledPolicies.clear();
+}
+
+// M: accounts the memory held by the compiled policies
+void CGroundingManagerAgent::AccountMemoryUsage(TMemoryAccount& rmaAccount)
+{
+	int iBytes = 0;
+	TCompiledPolicies::iterator iPtr;
+	for (iPtr = mapCompiledPolicies.begin(); iPtr != mapCompiledPolicies.end(); 
+		iPtr++)
+		iBytes += sizeof(CCompiledPolicy) + iPtr->second->GetHeapBytes() +
+		(int)(sizeof(TCompiledPolicies::value_type) + TREE_NODE_OVERHEAD) +
+		StringHeapBytes(iPtr->first);
+	AccountMemory(rmaAccount, MA_GROUNDING_POLICIES, 
+		(int)mapCompiledPolicies.size(), iBytes);
+}
+
 // D: release the set of external policy interfaces
 // DͷⲿԽӿڼ
 void CGroundingManagerAgent::ReleaseExternalPolicyInterfaces()
@@ -498,6 +592,9 @@ void CGroundingManagerAgent::LoadBeliefUpdatingModel(string sAFileName)
 	}
 	fclose(fid);
 
+	// compile the models against the precomputed features
+	compileBeliefUpdatingModels();
+
 	// Log the models loaded
 	Log(GROUNDINGMANAGER_STREAM, "Belief updating grounding model loaded.");
 
@@ -531,6 +628,14 @@ void CGroundingManagerAgent::SetBeliefUpdatingModelName( string sABeliefUpdating
 				"Unknown belief updating model type: %s", sModelName.c_str()));
 		}
 	}
+
+	// and precompute the model constant
+	if (gmcConfig.sBeliefUpdatingModelName == "npu")
+		gmcConfig.iBeliefUpdatingModel = BUM_NPU;
+	else if (gmcConfig.sBeliefUpdatingModelName == "calista")
+		gmcConfig.iBeliefUpdatingModel = BUM_CALISTA;
+	else
+		gmcConfig.iBeliefUpdatingModel = BUM_UNKNOWN;
 }
 
 // D: Gets the belief updating model name
@@ -540,6 +645,12 @@ string CGroundingManagerAgent::GetBeliefUpdatingModelName()
 	return gmcConfig.sBeliefUpdatingModelName; //ģ["npu", "calista"]
 }
 
+// M: Gets the belief updating model (one of the BUM_* constants)
+int CGroundingManagerAgent::GetBeliefUpdatingModel()
+{
+	return gmcConfig.iBeliefUpdatingModel;
+}
+
 // D: Returns an actual belief updating model for an action
 STRING2FLOATVECTOR& CGroundingManagerAgent::GetBeliefUpdatingModelForAction(
 	string sSystemAction)
@@ -560,6 +671,128 @@ STRING2FLOATVECTOR& CGroundingManagerAgent::GetBeliefUpdatingModelForAction(
 	return iPtr->second;
 }
 
+// M: the names of the precomputed belief updating features (indexed by 
+//    the BUF_* ids)
+static const char* lpszBeliefUpdatingFeatureNames[BUF_NUM_FEATURES] = {
+	"k",
+	"h00hhh",
+	"i_th_explicitly_confirmed_already",
+	"ur_selh_new_1_explicitly_disconfirmed_already",
+	"ur_selh_h_th_avail",
+	"ur_selh_i_th_avail",
+	"ur_selh_i_2h_avail",
+	"ur_selh_new_1_avail",
+	"response_new_hyps_in_selh",
+	"concept_repeat_selh",
+	"concept_repeat_selh_i_th",
+	"concept_repeat_selh_not_i_th",
+	"initial_num_hyps",
+	"initial_num_hyps_gt_0",
+	"initial_num_hyps_gt_1",
+	"initial_value_structure",
+	"concept_2",
+	"concept_bool",
+	"i_th_conf",
+	"i_th_conf_gtm",
+	"i_th_confusability",
+	"ur_selh_new_1_conf",
+	"ur_selh_new_1_conf_gt_25",
+	"ur_selh_new_1_conf_gt_75",
+	"ur_selh_new_1_confusability",
+	"i_th_prior",
+	"i_th_prior_gt_1",
+	"ur_selh_new_1_prior",
+	"ur_selh_new_1_prior_gt_1"
+};
+
+// M: Compile the belief updating models against the precomputed features
+void CGroundingManagerAgent::compileBeliefUpdatingModels()
+{
+	// assign the concept ids (in the order of the concept values info)
+	mapConceptIds.clear();
+	vsConceptIdNames.clear();
+	STRING2STRING2FLOATVECTOR::iterator iPtr;
+	for (iPtr = s2s2vfConceptValuesInfo.begin();
+		iPtr != s2s2vfConceptValuesInfo.end(); iPtr++)
+	{
+		mapConceptIds.insert(map<string, int>::value_type(
+			iPtr->first, (int)vsConceptIdNames.size()));
+		vsConceptIdNames.push_back(ToLowerCase(iPtr->first));
+	}
+
+	// now compile each of the models
+	mapCompiledBeliefUpdatingModels.clear();
+	for (iPtr = s2s2vfBeliefUpdatingModels.begin();
+		iPtr != s2s2vfBeliefUpdatingModels.end(); iPtr++)
+	{
+		TCompiledBeliefUpdatingModel cbumModel;
+		cbumModel.vfWeights1.resize(BUF_NUM_FEATURES, 0);
+		cbumModel.vfWeights2.resize(BUF_NUM_FEATURES, 0);
+		cbumModel.vbInModel.resize(BUF_NUM_FEATURES, false);
+		cbumModel.vfConceptIdWeights1.resize(vsConceptIdNames.size(), 0);
+		cbumModel.vfConceptIdWeights2.resize(vsConceptIdNames.size(), 0);
+
+		STRING2FLOATVECTOR::iterator iPtr2;
+		for (iPtr2 = iPtr->second.begin(); iPtr2 != iPtr->second.end();
+			iPtr2++)
+		{
+			// check that we have a coefficient for each score
+			if (iPtr2->second.size() < 2)
+				FatalError(FormatString(
+					"Error loading belief updating model. Feature %s for "\
+					"action %s does not have 2 coefficients.",
+					iPtr2->first.c_str(), iPtr->first.c_str()));
+
+			int iFeatureId = beliefUpdatingFeatureNameToId(iPtr2->first);
+			int iConceptId = conceptIdFeatureToConceptId(iPtr2->first);
+			if (iFeatureId != -1)
+			{
+				cbumModel.vfWeights1[iFeatureId] += iPtr2->second[0];
+				cbumModel.vfWeights2[iFeatureId] += iPtr2->second[1];
+				cbumModel.vbInModel[iFeatureId] = true;
+			}
+			else if (iConceptId != -1)
+			{
+				cbumModel.vfConceptIdWeights1[iConceptId] += iPtr2->second[0];
+				cbumModel.vfConceptIdWeights2[iConceptId] += iPtr2->second[1];
+			}
+			else
+			{
+				// o/w the feature is computed by GetGroundingFeature
+				cbumModel.s2vfOtherFeatures.insert(*iPtr2);
+			}
+		}
+
+		mapCompiledBeliefUpdatingModels.insert(
+			TCompiledBeliefUpdatingModels::value_type(iPtr->first, cbumModel));
+	}
+}
+
+// M: Return the id of a precomputed belief updating feature (-1 if the 
+//    feature is not precomputed)
+int CGroundingManagerAgent::beliefUpdatingFeatureNameToId(string sFeatureName)
+{
+	for (int i = 0; i < BUF_NUM_FEATURES; i++)
+	if (sFeatureName == lpszBeliefUpdatingFeatureNames[i])
+		return i;
+	return -1;
+}
+
+// M: Return the concept id for a concept_id(...) feature (-1 if the name
+//    is not a concept_id feature on a known concept)
+int CGroundingManagerAgent::conceptIdFeatureToConceptId(string sFeatureName)
+{
+	if ((sFeatureName.length() < 12) ||
+		(sFeatureName.substr(0, 11) != "concept_id(") ||
+		(sFeatureName[sFeatureName.length() - 1] != ')'))
+		return -1;
+	string sConcept = sFeatureName.substr(11, sFeatureName.length() - 12);
+	for (unsigned int i = 0; i < vsConceptIdNames.size(); i++)
+	if (vsConceptIdNames[i] == sConcept)
+		return (int)i;
+	return -1;
+}
+
 // D: Return the constant parameter from the configuration
 float CGroundingManagerAgent::GetConstantParameter(string sParam)
 {
@@ -587,6 +820,11 @@ void CGroundingManagerAgent::PrecomputeBeliefUpdatingFeatures(
 	if (!pIConcept)
 		FatalError("Cannot precompute belief updating features on NULL concept.");
 
+	// reset the features
+	vfBeliefUpdatingFeatures.assign(BUF_NUM_FEATURES, 0);
+	vfBeliefUpdatingFeatures[BUF_K] = 1;
+	bBeliefUpdatingFeaturesPrecomputed = true;
+
 	// grab the top hypothesis 
 	int iIndexI_TH = pIConcept->GetTopHypIndex();
 	CHyp* phI_TH = (iIndexI_TH != -1) ? pIConcept->GetHyp(iIndexI_TH) : NULL;
@@ -607,7 +845,7 @@ void CGroundingManagerAgent::PrecomputeBeliefUpdatingFeatures(
 	// history hypothesis)
 	bool bHOHH = bEmptyWithHistory &&
 		((sSystemAction == SA_IMPL_CONF) || (sSystemAction == SA_UNPLANNED_IMPL_CONF));
-	s2fBeliefUpdatingFeatures.insert(STRING2FLOAT::value_type("h00hhh", (float)bHOHH));
+	vfBeliefUpdatingFeatures[BUF_H00HHH] = (float)bHOHH;
 
 	// now if we need to replace the initial with the history one, do that
 	if (bHOHH)
@@ -635,72 +873,50 @@ void CGroundingManagerAgent::PrecomputeBeliefUpdatingFeatures(
 	CHyp* phNEW_1 = bNEWMatchesNEW_1 ? phNewTop : NULL;
 
 	// precompute the i_th_explicitly_confirmed_already
-	s2fBeliefUpdatingFeatures.insert(STRING2FLOAT::value_type(
-		"i_th_explicitly_confirmed_already",
-		(phI_TH != NULL) &&
-		(pIConcept->GetExplicitlyConfirmedHypAsString() == phI_TH->ValueToString())));
+	vfBeliefUpdatingFeatures[BUF_I_TH_EXPLICITLY_CONFIRMED_ALREADY] =
+		(float)((phI_TH != NULL) &&
+		(pIConcept->GetExplicitlyConfirmedHypAsString() == phI_TH->ValueToString()));
 
 	// precompute the ur_selh_new_1_explicitly_disconfirmed_already
-	s2fBeliefUpdatingFeatures.insert(STRING2FLOAT::value_type(
-		"ur_selh_new_1_explicitly_disconfirmed_already",
-		(phNEW_1 != NULL) &&
-		(pIConcept->GetExplicitlyDisconfirmedHypAsString() == phNEW_1->ValueToString())));
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_EXPLICITLY_DISCONFIRMED_ALREADY] =
+		(float)((phNEW_1 != NULL) &&
+		(pIConcept->GetExplicitlyDisconfirmedHypAsString() == phNEW_1->ValueToString()));
 
 	// precompute response_new_hyps_in_selh
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("ur_selh_h_th_avail", (float)bNEWMatchesH_TH));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("ur_selh_i_th_avail", (float)bNEWMatchesI_TH));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("ur_selh_i_2h_avail", (float)bNEWMatchesI_2H));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("ur_selh_new_1_avail", (float)bNEWMatchesNEW_1));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("response_new_hyps_in_selh", (float)bNEWMatchesNEW_1));
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_H_TH_AVAIL] = (float)bNEWMatchesH_TH;
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_I_TH_AVAIL] = (float)bNEWMatchesI_TH;
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_I_2H_AVAIL] = (float)bNEWMatchesI_2H;
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_AVAIL] = (float)bNEWMatchesNEW_1;
+	vfBeliefUpdatingFeatures[BUF_RESPONSE_NEW_HYPS_IN_SELH] = (float)bNEWMatchesNEW_1;
 
 	// precompute concept_repeat_selh family
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("concept_repeat_selh", (float)(phNewTop != NULL)));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("concept_repeat_selh_i_th", (float)bNEWMatchesI_TH));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("concept_repeat_selh_not_i_th",
-		(float)(phNewTop && !bNEWMatchesI_TH)));
-
-	// precompute the concept_id family of features
-	STRING2STRING2FLOATVECTOR::iterator iPtr;
-	for (iPtr = s2s2vfConceptValuesInfo.begin();
-		iPtr != s2s2vfConceptValuesInfo.end(); iPtr++)
-	{
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type(
-			FormatString("concept_id(%s)",
-			ToLowerCase(iPtr->first).c_str()),
-			(iPtr->first == pIConcept->GetSmallName())));
-	}
+	vfBeliefUpdatingFeatures[BUF_CONCEPT_REPEAT_SELH] = (float)(phNewTop != NULL);
+	vfBeliefUpdatingFeatures[BUF_CONCEPT_REPEAT_SELH_I_TH] = (float)bNEWMatchesI_TH;
+	vfBeliefUpdatingFeatures[BUF_CONCEPT_REPEAT_SELH_NOT_I_TH] =
+		(float)(phNewTop && !bNEWMatchesI_TH);
+
+	// precompute the concept_id family of features (one-hot, so we only
+	// store the id of the concept)
+	map<string, int>::iterator iPtr =
+		mapConceptIds.find(pIConcept->GetSmallName());
+	iConceptIdFeature = (iPtr != mapConceptIds.end()) ? iPtr->second : -1;
 
 	// precompute initial_num_hyps, history_num_hyps and family
 	int iInitialNumHyps = pIConcept->GetNumHyps();
 	int iHistoryNumHyps = 0;
 	if (pIConcept->GetHistorySize() >= 1)
 		iHistoryNumHyps = pIConcept->GetHistoryVersion(-1).GetNumHyps();
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("initial_num_hyps", (float)iInitialNumHyps));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("initial_num_hyps_gt_0", iInitialNumHyps > 0));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("initial_num_hyps_gt_1", iInitialNumHyps > 1));
+	vfBeliefUpdatingFeatures[BUF_INITIAL_NUM_HYPS] = (float)iInitialNumHyps;
+	vfBeliefUpdatingFeatures[BUF_INITIAL_NUM_HYPS_GT_0] = (float)(iInitialNumHyps > 0);
+	vfBeliefUpdatingFeatures[BUF_INITIAL_NUM_HYPS_GT_1] = (float)(iInitialNumHyps > 1);
 
 	// precompute initial_value_structure
 	if (iInitialNumHyps > 0)
-		s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("initial_value_structure", 0));
+		vfBeliefUpdatingFeatures[BUF_INITIAL_VALUE_STRUCTURE] = 0;
 	else if (iHistoryNumHyps > 0)
-		s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("initial_value_structure", 1));
+		vfBeliefUpdatingFeatures[BUF_INITIAL_VALUE_STRUCTURE] = 1;
 	else
-		s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("initial_value_structure", 2));
+		vfBeliefUpdatingFeatures[BUF_INITIAL_VALUE_STRUCTURE] = 2;
 
 	// precompute concept_2 and concept_bool
 	int iConcept2 = 0;
@@ -712,81 +928,61 @@ void CGroundingManagerAgent::PrecomputeBeliefUpdatingFeatures(
 		iConcept2 = 2;
 	else
 		iConcept2 = -1;
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("concept_2", (float)iConcept2));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("concept_bool", iConcept2 > 0));
+	vfBeliefUpdatingFeatures[BUF_CONCEPT_2] = (float)iConcept2;
+	vfBeliefUpdatingFeatures[BUF_CONCEPT_BOOL] = (float)(iConcept2 > 0);
 
 	// precompute i_th_confusability, i_th_conf
 	if (iIndexI_TH != -1)
 	{
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type(
-			"i_th_conf", phI_TH->GetConfidence()));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("i_th_conf_gtm",
-			phI_TH->GetConfidence() > GetConstantParameter("i_th_conf_mean")));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type(
-			"i_th_confusability", pIConcept->GetConfusabilityForHyp(phI_TH)));
+		vfBeliefUpdatingFeatures[BUF_I_TH_CONF] = phI_TH->GetConfidence();
+		vfBeliefUpdatingFeatures[BUF_I_TH_CONF_GTM] = (float)
+			(phI_TH->GetConfidence() > GetConstantParameter("i_th_conf_mean"));
+		vfBeliefUpdatingFeatures[BUF_I_TH_CONFUSABILITY] =
+			pIConcept->GetConfusabilityForHyp(phI_TH);
 	}
 	else
 	{
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("i_th_conf", 0));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("i_th_conf_gtm", 0));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("i_th_confusability",
-			pIConcept->GetConfusabilityForHyp(NULL)));
+		vfBeliefUpdatingFeatures[BUF_I_TH_CONF] = 0;
+		vfBeliefUpdatingFeatures[BUF_I_TH_CONF_GTM] = 0;
+		vfBeliefUpdatingFeatures[BUF_I_TH_CONFUSABILITY] =
+			pIConcept->GetConfusabilityForHyp(NULL);
 	}
 
 	// precompute ur_selh_new_1_confusability, ur_selh_new_1_conf
 	if (iIndexNEW_1 != -1)
 	{
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_conf",
-			phNEW_1->GetConfidence()));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_conf_gt_25",
-			phNEW_1->GetConfidence() > 0.25));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_conf_gt_75",
-			phNEW_1->GetConfidence() > 0.75));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_confusability",
-			pNewConcept->GetConfusabilityForHyp(phNEW_1)));
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONF] =
+			phNEW_1->GetConfidence();
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONF_GT_25] =
+			(float)(phNEW_1->GetConfidence() > 0.25);
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONF_GT_75] =
+			(float)(phNEW_1->GetConfidence() > 0.75);
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONFUSABILITY] =
+			pNewConcept->GetConfusabilityForHyp(phNEW_1);
 	}
 	else
 	{
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_conf", 0));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_conf_gt_25", 0));
-		s2fBeliefUpdatingFeatures.insert(
-			STRING2FLOAT::value_type("ur_selh_new_1_conf_gt_75", 0));
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONF] = 0;
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONF_GT_25] = 0;
+		vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONF_GT_75] = 0;
 		// if we have an other type update, introduce the missing
 		// value
 		if (sSystemAction == SA_OTHER)
 		{
-			s2fBeliefUpdatingFeatures.insert(
-				STRING2FLOAT::value_type("ur_selh_new_1_confusability",
-				GetConstantParameter("missing_ur_selh_new_1_confusability")));
+			vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONFUSABILITY] =
+				GetConstantParameter("missing_ur_selh_new_1_confusability");
 		}
 		else
 		{
-			s2fBeliefUpdatingFeatures.insert(
-				STRING2FLOAT::value_type("ur_selh_new_1_confusability",
-				pIConcept->GetConfusabilityForHyp(NULL)));
+			vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_CONFUSABILITY] =
+				pIConcept->GetConfusabilityForHyp(NULL);
 		}
 	}
 
 	// precompute i_th_prior and derived versions
 	float fI_THPrior = pIConcept->GetPriorForHyp(phI_TH);
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("i_th_prior", fI_THPrior));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("i_th_prior_gt_1", (fI_THPrior >= 0.95)));
+	vfBeliefUpdatingFeatures[BUF_I_TH_PRIOR] = fI_THPrior;
+	vfBeliefUpdatingFeatures[BUF_I_TH_PRIOR_GT_1] = (float)(fI_THPrior >= 0.95);
 
 	// precompute ur_selh_new_1_prior and derived versions
 	float fNEW_1Prior = 1;
@@ -795,30 +991,42 @@ void CGroundingManagerAgent::PrecomputeBeliefUpdatingFeatures(
 	// introduce the missing feature value if we are doing an other update
 	if ((sSystemAction == SA_OTHER) && (iIndexNEW_1 == -1))
 		fNEW_1Prior = GetConstantParameter("missing_ur_selh_new_1_prior");
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("ur_selh_new_1_prior", fNEW_1Prior));
-	s2fBeliefUpdatingFeatures.insert(
-		STRING2FLOAT::value_type("ur_selh_new_1_prior_gt_1", (fNEW_1Prior >= 0.95)));
-
-	// at the end log all the precomputed belief updating features
-	string sPrecomputedFeatures = "";
-	STRING2FLOAT::iterator iPtr2;
-	for (iPtr2 = s2fBeliefUpdatingFeatures.begin();
-		iPtr2 != s2fBeliefUpdatingFeatures.end();
-		iPtr2++)
-	{
-		sPrecomputedFeatures = FormatString("%s  %s = %.4f\n",
-			sPrecomputedFeatures.c_str(), iPtr2->first.c_str(),
-			iPtr2->second);
-	}
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_PRIOR] = fNEW_1Prior;
+	vfBeliefUpdatingFeatures[BUF_UR_SELH_NEW_1_PRIOR_GT_1] = (float)(fNEW_1Prior >= 0.95);
+
 	// Log(BELIEFUPDATING_STREAM, "Finished precomputing belief updating features.");
 }
 
+// M: Look up the value of a precomputed belief updating feature by name
+//    (returns false if the feature is not precomputed)
+bool CGroundingManagerAgent::getBeliefUpdatingFeature(string sFeatureName,
+	float& rfValue)
+{
+	if (!bBeliefUpdatingFeaturesPrecomputed)
+		return false;
+
+	// check the dense features
+	int iFeatureId = beliefUpdatingFeatureNameToId(sFeatureName);
+	if (iFeatureId != -1)
+	{
+		rfValue = vfBeliefUpdatingFeatures[iFeatureId];
+		return true;
+	}
+
+	// o/w check the concept_id(...) family
+	int iConceptId = conceptIdFeatureToConceptId(sFeatureName);
+	if (iConceptId != -1)
+	{
+		rfValue = (float)(iConceptId == iConceptIdFeature);
+		return true;
+	}
+
+	return false;
+}
+
 // D: Return the value of a belief updating feature
 float CGroundingManagerAgent::GetGroundingFeature(string sFeatureName)
 {
-	STRING2FLOAT::iterator iPtr;
-
 	// check if it's a class / enum feature (something like feature[value])
 	string sClassFeature = "";
 	string sClassFeatureValue = "";
@@ -830,11 +1038,9 @@ float CGroundingManagerAgent::GetGroundingFeature(string sFeatureName)
 
 	float fValue = -1;
 	string sValue = "";
-	if ((iPtr = s2fBeliefUpdatingFeatures.find(sFeatureName)) !=
-		s2fBeliefUpdatingFeatures.end())
+	if (getBeliefUpdatingFeature(sFeatureName, fValue))
 	{
-		// if we found the feature in the hash, simply return it
-		fValue = iPtr->second;
+		// if it's a precomputed feature, we have its value
 	}
 	else if (sFeatureName == "k")
 	{
@@ -910,8 +1116,6 @@ float CGroundingManagerAgent::GetGroundingFeature(string sFeatureName)
 // D: Return the value of a belief updating feature, as a string
 string CGroundingManagerAgent::GetGroundingFeatureAsString(string sFeatureName)
 {
-	STRING2FLOAT::iterator iPtr;
-
 	// check if it's a class / enum feature (something like feature[value])
 	string sClassFeature = "";
 	string sClassFeatureValue = "";
@@ -922,11 +1126,11 @@ string CGroundingManagerAgent::GetGroundingFeatureAsString(string sFeatureName)
 	}
 
 	string sValue = "";
-	if ((iPtr = s2fBeliefUpdatingFeatures.find(sFeatureName)) !=
-		s2fBeliefUpdatingFeatures.end())
+	float fPrecomputedValue;
+	if (getBeliefUpdatingFeature(sFeatureName, fPrecomputedValue))
 	{
-		// if we found the feature in the hash, simply return it
-		sValue = FormatString("%.4f", iPtr->second);
+		// if it's a precomputed feature, simply return it
+		sValue = FormatString("%.4f", fPrecomputedValue);
 	}
 	else if (sFeatureName == "k")
 	{
@@ -993,12 +1197,72 @@ string CGroundingManagerAgent::GetGroundingFeatureAsString(string sFeatureName)
 // D: Clear the belief updating features
 void CGroundingManagerAgent::ClearBeliefUpdatingFeatures()
 {
-	// clear the hash of precomputed belief updating feature
-	s2fBeliefUpdatingFeatures.clear();
+	// invalidate the precomputed belief updating features
+	bBeliefUpdatingFeaturesPrecomputed = false;
+	iConceptIdFeature = -1;
 	// and return
 	return;
 }
 
+// M: Computes the scores of the belief updating model for a system action
+//    from the precomputed features: a dot product of the model weights with
+//    the dense features, plus the weight of the current concept id, plus
+//    the features obtained through GetGroundingFeature
+void CGroundingManagerAgent::ComputeBeliefUpdatingScores(string sSystemAction,
+	double& rfScore1, double& rfScore2, string& rsLog)
+{
+	// check that the model exists
+	TCompiledBeliefUpdatingModels::iterator iPtr;
+	if ((iPtr = mapCompiledBeliefUpdatingModels.find(sSystemAction)) ==
+		mapCompiledBeliefUpdatingModels.end())
+	{
+		// if it doesn't, issue a fatal error
+		FatalError(FormatString(
+			"Could not find belief updating model for action %s.",
+			sSystemAction.c_str()));
+	}
+	TCompiledBeliefUpdatingModel& rcbumModel = iPtr->second;
+
+	// the precomputed features
+	for (int i = 0; i < BUF_NUM_FEATURES; i++)
+	{
+		if (!rcbumModel.vbInModel[i])
+			continue;
+		float fFeatureValue = vfBeliefUpdatingFeatures[i];
+		rfScore1 += fFeatureValue * rcbumModel.vfWeights1[i];
+		rfScore2 += fFeatureValue * rcbumModel.vfWeights2[i];
+		rsLog += FormatString("  %s = %.4f\t%.4f\t%.4f\n",
+			lpszBeliefUpdatingFeatureNames[i], fFeatureValue,
+			fFeatureValue * rcbumModel.vfWeights1[i],
+			fFeatureValue * rcbumModel.vfWeights2[i]);
+	}
+
+	// the concept_id(...) features (only the current concept is 1)
+	if (iConceptIdFeature != -1)
+	{
+		rfScore1 += rcbumModel.vfConceptIdWeights1[iConceptIdFeature];
+		rfScore2 += rcbumModel.vfConceptIdWeights2[iConceptIdFeature];
+		rsLog += FormatString("  concept_id(%s) = 1.0000\t%.4f\t%.4f\n",
+			vsConceptIdNames[iConceptIdFeature].c_str(),
+			rcbumModel.vfConceptIdWeights1[iConceptIdFeature],
+			rcbumModel.vfConceptIdWeights2[iConceptIdFeature]);
+	}
+
+	// and the remaining features
+	STRING2FLOATVECTOR::iterator iPtr2;
+	for (iPtr2 = rcbumModel.s2vfOtherFeatures.begin();
+		iPtr2 != rcbumModel.s2vfOtherFeatures.end(); iPtr2++)
+	{
+		float fFeatureValue = GetGroundingFeature(iPtr2->first);
+		rfScore1 += fFeatureValue * (iPtr2->second)[0];
+		rfScore2 += fFeatureValue * (iPtr2->second)[1];
+		rsLog += FormatString("  %s = %.4f\t%.4f\t%.4f\n",
+			iPtr2->first.c_str(), fFeatureValue,
+			fFeatureValue * (iPtr2->second)[0],
+			fFeatureValue * (iPtr2->second)[1]);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // D: Methods for access to concept priors and confusability information
 //-----------------------------------------------------------------------------
@@ -1172,6 +1436,8 @@ CGroundingAction* CGroundingManagerAgent::operator [] (unsigned int	iActionIndex
 //	void RequestTurnGrounding(bool bATurnGroundingRequest = true); ĬΪTrue
 void CGroundingManagerAgent::RequestTurnGrounding(bool bATurnGroundingRequest)
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
 	bTurnGroundingRequest = bATurnGroundingRequest && gmcConfig.bGroundTurns; //ǷTurn Grouding
 }
 
@@ -1179,11 +1445,37 @@ void CGroundingManagerAgent::RequestTurnGrounding(bool bATurnGroundingRequest)
 // źţҪӵһconcept
 void CGroundingManagerAgent::RequestConceptGrounding(CConcept* pConcept)
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
 
 	// first check that the current configuration allows to ground concepts
 	//ȼ鵱ǰǷӵconcept
 	if (!gmcConfig.bGroundConcepts) return;
 
+	// if a batch is open, just record the request (a locked queue is 
+	// reported right away, as for the requests issued directly)
+	if (iGroundingRequestsBatchDepth > 0)
+	{
+		if (bLockedGroundingRequests)
+			FatalError(FormatString(
+			"Cannot add concept grounding request for %s: concept "
+			"grounding queue is locked.",
+			pConcept->GetAgentQualifiedName().c_str()));
+		vcpBatchedGroundingRequests.push_back(pConcept);
+		scpBatchedGroundingRequests.insert(pConcept);
+		return;
+	}
+
+	// o/w issue it right away
+	issueConceptGroundingRequest(pConcept);
+}
+
+// M: issues a concept grounding request: adds it at the end of the queue
+//    (or moves it there, if the concept already had a request)
+void CGroundingManagerAgent::issueConceptGroundingRequest(CConcept* pConcept)
+{
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
 	// if the queue is locked, issue a fatal error
 	if (bLockedGroundingRequests)
 		FatalError(FormatString(
@@ -1211,10 +1503,35 @@ void CGroundingManagerAgent::RequestConceptGrounding(CConcept* pConcept)
 	vcgrConceptGroundingRequests.push_back(cgr);
 }
 
+// M: opens a batch of concept grounding requests
+void CGroundingManagerAgent::BeginConceptGroundingRequestsBatch()
+{
+	iGroundingRequestsBatchDepth++;
+}
+
+// M: commits a batch of concept grounding requests
+void CGroundingManagerAgent::CommitConceptGroundingRequestsBatch()
+{
+	if (iGroundingRequestsBatchDepth == 0)
+	{
+		Warning("CommitConceptGroundingRequestsBatch called without an open "\
+			"batch.");
+		return;
+	}
+	iGroundingRequestsBatchDepth--;
+	if (iGroundingRequestsBatchDepth == 0)
+		flushBatchedConceptGroundingRequests();
+}
+
 // D: force the grounding manager to schedule grounding for a certain concept
 // DǿƽӵعΪĳŽӵ
 string CGroundingManagerAgent::ScheduleConceptGrounding(CConcept* pConcept)
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
+
 
 	// log that we are scheduling concept grounding
 	Log(GROUNDINGMANAGER_STREAM, "Scheduling concept grounding for concept %s",
@@ -1223,6 +1540,8 @@ string CGroundingManagerAgent::ScheduleConceptGrounding(CConcept* pConcept)
 	// first, call a simple request concept grounding
 	// ȣһconceptӵز [GRS_UNPROCESSED]
 	RequestConceptGrounding(pConcept);
+	// (which is batched if a batch is open)
+	flushBatchedConceptGroundingRequests();
 
 	// then get the index from the list
 	int iIndex = getConceptGroundingRequestIndex(pConcept);
@@ -1303,6 +1622,9 @@ string CGroundingManagerAgent::ScheduleConceptGrounding(CConcept* pConcept)
 // D: Lock the grounding requests queue
 void CGroundingManagerAgent::LockConceptGroundingRequestsQueue()
 {
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
+
 	bLockedGroundingRequests = true;
 }
 
@@ -1316,6 +1638,10 @@ void CGroundingManagerAgent::UnlockConceptGroundingRequestsQueue()
 // Dýӵ״̬
 void CGroundingManagerAgent::SetConceptGroundingRequestStatus(CConcept* pConcept, int iAGroundingRequestStatus)
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
 	// get the index of that concept grounding request
 	int iIndex = getConceptGroundingRequestIndex(pConcept);
 	// now check that it exists
@@ -1347,6 +1673,9 @@ void CGroundingManagerAgent::SetConceptGroundingRequestStatus(CConcept* pConcept
 // conceptӵزstate
 int CGroundingManagerAgent::GetConceptGroundingRequestStatus(CConcept* pConcept)
 {
+	// a batched request will be issued as unprocessed
+	if (isConceptGroundingRequestBatched(pConcept))
+		return GRS_UNPROCESSED;
 	// get the index of that concept grounding request
 	int iIndex = getConceptGroundingRequestIndex(pConcept);
 	// now check that it exists
@@ -1366,6 +1695,10 @@ int CGroundingManagerAgent::GetConceptGroundingRequestStatus(CConcept* pConcept)
 // Dʾɵź
 void CGroundingManagerAgent::ConceptGroundingRequestCompleted(CConcept* pConcept)
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
 	// get the index of that concept grounding request
 	int iIndex = getConceptGroundingRequestIndex(pConcept);
 	// if it exists in the queue, and it was currently executing
@@ -1385,6 +1718,10 @@ void CGroundingManagerAgent::ConceptGroundingRequestCompleted(CConcept* pConcept
 // Dɾconceptӵ
 void CGroundingManagerAgent::RemoveConceptGroundingRequest(CConcept* pConcept)
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
 
 	// get the index
 	int iIndex = getConceptGroundingRequestIndex(pConcept);
@@ -1404,6 +1741,11 @@ void CGroundingManagerAgent::RemoveConceptGroundingRequest(CConcept* pConcept)
 // Dӵб
 void CGroundingManagerAgent::PurgeConceptGroundingRequestsQueue()
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
+
 	/*
 	// D: type describing a concept grounding request
 	// D
@@ -1657,6 +1999,10 @@ bool CGroundingManagerAgent::HasPendingTurnGroundingRequest()
 */
 bool CGroundingManagerAgent::HasPendingConceptGroundingRequests()
 {
+	// the batched requests will be issued as unprocessed
+	if (!vcpBatchedGroundingRequests.empty())
+		return true;
+
 	//  go through the list    
 	for (int i = 0; i < (int)vcgrConceptGroundingRequests.size(); i++)
 	{
@@ -1672,6 +2018,10 @@ bool CGroundingManagerAgent::HasPendingConceptGroundingRequests()
 // DȷǷδĸ
 bool CGroundingManagerAgent::HasUnprocessedConceptGroundingRequests()
 {
+	// the batched requests will be issued as unprocessed
+	if (!vcpBatchedGroundingRequests.empty())
+		return true;
+
 	//  go through the list    
 	for (int i = 0; i < (int)vcgrConceptGroundingRequests.size(); i++)
 	{
@@ -1686,10 +2036,12 @@ bool CGroundingManagerAgent::HasUnprocessedConceptGroundingRequests()
 // DȷǷ 
 bool CGroundingManagerAgent::HasScheduledConceptGroundingRequests()
 {
-	//  go through the list
+	//  go through the list (the requests that are batched again will be
+	//  reissued as unprocessed)
 	for (int i = 0; i < (int)vcgrConceptGroundingRequests.size(); i++)
 	{
-		if (vcgrConceptGroundingRequests[i].iGroundingRequestStatus == GRS_SCHEDULED) //ǰӵǷ ̬
+		if ((vcgrConceptGroundingRequests[i].iGroundingRequestStatus == GRS_SCHEDULED) &&
+			!isConceptGroundingRequestBatched(vcgrConceptGroundingRequests[i].pConcept)) //ǰӵǷ ̬
 			return true;
 	}
 	return false;
@@ -1698,11 +2050,13 @@ bool CGroundingManagerAgent::HasScheduledConceptGroundingRequests()
 // D: determines if there are executing requests
 bool CGroundingManagerAgent::HasExecutingConceptGroundingRequests()
 {
-	//  go through the list
+	//  go through the list (the requests that are batched again will be
+	//  reissued as unprocessed)
 	for (int i = 0; i < (int)vcgrConceptGroundingRequests.size(); i++)
 	{
-		if (vcgrConceptGroundingRequests[i].iGroundingRequestStatus ==
-			GRS_EXECUTING)
+		if ((vcgrConceptGroundingRequests[i].iGroundingRequestStatus ==
+			GRS_EXECUTING) &&
+			!isConceptGroundingRequestBatched(vcgrConceptGroundingRequests[i].pConcept))
 			return true;
 	}
 	return false;
@@ -1712,12 +2066,15 @@ bool CGroundingManagerAgent::HasExecutingConceptGroundingRequests()
 // DȷǷڽӵ
 bool CGroundingManagerAgent::GroundingInProgressOnConcept(CConcept* pConcept)
 {
-	return (getConceptGroundingRequestIndex(pConcept) != -1);
+	return isConceptGroundingRequestBatched(pConcept) ||
+		(getConceptGroundingRequestIndex(pConcept) != -1);
 }
 
 // D: check if there is a scheduled action for a concept
 string CGroundingManagerAgent::GetScheduledGroundingActionOnConcept(CConcept* pConcept)
 {
+	// a batched request will be issued as unprocessed
+	if (isConceptGroundingRequestBatched(pConcept)) return "";
 	// find the request
 	int iIndex = getConceptGroundingRequestIndex(pConcept);
 	// check that it exists
@@ -1741,6 +2098,11 @@ string CGroundingManagerAgent::GetScheduledGroundingActionOnConcept(CConcept* pC
 #pragma warning (disable:4706)
 void CGroundingManagerAgent::Run()
 {
+	// the grounding queue is about to change
+	CDialogAgent::IncrementDialogStateGeneration();
+	// issue the batched requests first
+	flushBatchedConceptGroundingRequests();
+
 
 	// and log it
 	Log(GROUNDINGMANAGER_STREAM, "Running grounding process ...");
@@ -2088,7 +2450,9 @@ void CGroundingManagerAgent::Run()
 // D: Private auxiliary methods
 //-----------------------------------------------------------------------------
 
-// D: Return the index of a concept grounding request, or -1 if not found
+// D: Return the index of a concept grounding request, or -1 if not found.
+//    The batched requests are not seen here: the callers that change the 
+//    queue issue them first, and the queries check them separately
 // DظҲ򷵻-1
 int CGroundingManagerAgent::getConceptGroundingRequestIndex(CConcept* pConcept)
 {
@@ -2102,6 +2466,57 @@ int CGroundingManagerAgent::getConceptGroundingRequestIndex(CConcept* pConcept)
 	return -1;
 }
 
+// M: Issue the batched concept grounding requests: one request per 
+//    concept, in the order of the last request for each concept (which
+//    leaves the queue as it would have been without batching)
+void CGroundingManagerAgent::flushBatchedConceptGroundingRequests()
+{
+	if (vcpBatchedGroundingRequests.empty())
+		return;
+
+	// take the requests out (issuing them accesses the queue, which
+	// flushes again)
+	TConceptPointersVector vcpRequests;
+	vcpRequests.swap(vcpBatchedGroundingRequests);
+	scpBatchedGroundingRequests.clear();
+
+	// keep only the last request for each concept
+	TConceptPointersSet scpSeen;
+	TConceptPointersVector vcpLastRequests;
+	for (int i = (int)vcpRequests.size() - 1; i >= 0; i--)
+	if (scpSeen.insert(vcpRequests[i]).second)
+		vcpLastRequests.push_back(vcpRequests[i]);
+
+	// and issue them in order
+	for (int i = (int)vcpLastRequests.size() - 1; i >= 0; i--)
+		issueConceptGroundingRequest(vcpLastRequests[i]);
+}
+
+// M: Checks if a concept has a batched (not yet issued) grounding request
+bool CGroundingManagerAgent::isConceptGroundingRequestBatched(CConcept* pConcept)
+{
+	return !scpBatchedGroundingRequests.empty() &&
+		(scpBatchedGroundingRequests.find(pConcept) != 
+		scpBatchedGroundingRequests.end());
+}
+
+// M: Record the file a policy was loaded from, and compute the key of the
+//    policy: the file name, the file time and a hash of the policy text, so
+//    that a changed file gets a new key even when its time is not known or
+//    did not change. The first policy loaded for a model is kept (as in 
+//    s2sPolicies)
+void CGroundingManagerAgent::recordPolicyFile(string sModelName, 
+	string sFileName)
+{
+	if (s2sPolicyFiles.find(sModelName) != s2sPolicyFiles.end())
+		return;
+	s2sPolicyFiles.insert(STRING2STRING::value_type(sModelName, sFileName));
+	s2sPolicyKeys.insert(STRING2STRING::value_type(sModelName, 
+		FormatString("%s@%ld#%08x", sFileName.c_str(), 
+		(long)GetFileModificationTime(sFileName), 
+		HashString(s2sPolicies[sModelName]))));
+}
+
 // A: Load a policy from its description file
 // ļмpolicy
 string CGroundingManagerAgent::loadPolicy(string sFileName)
@@ -53,6 +53,20 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the grounding queue queries consult the batched
+//                            requests instead of issuing them
+//   [2026-10-19] (mbrenner): belief updating features are held in a dense vector
+//                            indexed by BUF_* ids; the models are compiled to
+//                            weight vectors at load time
+//   [2026-10-19] (mbrenner): replaced GetPolicyFileTime with GetPolicyFile and
+//                            GetPolicyKey (file, file time and text hash), 
+//                            used by the parsed and compiled policy caches
+//   [2026-10-19] (mbrenner): added GetPolicyFileTime, so that parsed policies can
+//                            be cached process-wide
+//   [2026-10-19] (mbrenner): added the compiled policies, shared by the 
+//                            grounding models
+//   [2026-10-19] (mbrenner): added GetBeliefUpdatingModel (BUM_* constants)
+//   [2026-10-19] (mbrenner): added batching of concept grounding requests
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
@@ -74,6 +88,9 @@
 // ⲿ
 typedef map<string, CExternalPolicyInterface*> TExternalPolicies;
 
+// M: auxiliary define for a map holding the compiled policies
+typedef map<string, CCompiledPolicy*> TCompiledPolicies;
+
 // D: auxiliary definition of the grounding manager configuration
 // ӵع
 typedef struct
@@ -84,6 +101,8 @@ typedef struct
 	string sConceptGM;						//Ĭϵconceptӵģ
 	string sTurnGM;							//ĬϵTurnӵģ
 	string sBeliefUpdatingModelName;		//ģ ["npu", "calista" ]
+	int iBeliefUpdatingModel;				// the same, as a BUM_* constant 
+											//  (defined in Concept.h)
 } TGroundingManagerConfiguration;
 
 // D: type describing a concept grounding request
@@ -113,6 +132,56 @@ TConceptGroundingRequests;
 typedef map <string, vector<float> > STRING2FLOATVECTOR;
 typedef map <string, STRING2FLOATVECTOR> STRING2STRING2FLOATVECTOR;
 
+// M: ids of the precomputed belief updating features (the features are 
+//    held in a dense vector indexed by these ids; the concept_id(...) 
+//    family is one-hot, so it is held as the id of the current concept)
+#define BUF_K                                              0
+#define BUF_H00HHH                                         1
+#define BUF_I_TH_EXPLICITLY_CONFIRMED_ALREADY              2
+#define BUF_UR_SELH_NEW_1_EXPLICITLY_DISCONFIRMED_ALREADY  3
+#define BUF_UR_SELH_H_TH_AVAIL                             4
+#define BUF_UR_SELH_I_TH_AVAIL                             5
+#define BUF_UR_SELH_I_2H_AVAIL                             6
+#define BUF_UR_SELH_NEW_1_AVAIL                            7
+#define BUF_RESPONSE_NEW_HYPS_IN_SELH                      8
+#define BUF_CONCEPT_REPEAT_SELH                            9
+#define BUF_CONCEPT_REPEAT_SELH_I_TH                       10
+#define BUF_CONCEPT_REPEAT_SELH_NOT_I_TH                   11
+#define BUF_INITIAL_NUM_HYPS                               12
+#define BUF_INITIAL_NUM_HYPS_GT_0                          13
+#define BUF_INITIAL_NUM_HYPS_GT_1                          14
+#define BUF_INITIAL_VALUE_STRUCTURE                        15
+#define BUF_CONCEPT_2                                      16
+#define BUF_CONCEPT_BOOL                                   17
+#define BUF_I_TH_CONF                                      18
+#define BUF_I_TH_CONF_GTM                                  19
+#define BUF_I_TH_CONFUSABILITY                             20
+#define BUF_UR_SELH_NEW_1_CONF                             21
+#define BUF_UR_SELH_NEW_1_CONF_GT_25                       22
+#define BUF_UR_SELH_NEW_1_CONF_GT_75                       23
+#define BUF_UR_SELH_NEW_1_CONFUSABILITY                    24
+#define BUF_I_TH_PRIOR                                     25
+#define BUF_I_TH_PRIOR_GT_1                                26
+#define BUF_UR_SELH_NEW_1_PRIOR                            27
+#define BUF_UR_SELH_NEW_1_PRIOR_GT_1                       28
+#define BUF_NUM_FEATURES                                   29
+
+// M: type for a belief updating model compiled against the precomputed 
+//    features
+typedef struct
+{
+	vector<float> vfWeights1;			// the weights of the precomputed
+	vector<float> vfWeights2;			//  features, for the two scores
+	vector<bool> vbInModel;				// marks the features the model uses
+	vector<float> vfConceptIdWeights1;	// the weights of the concept_id(...)
+	vector<float> vfConceptIdWeights2;	//  features, indexed by concept id
+	STRING2FLOATVECTOR s2vfOtherFeatures;
+										// the remaining features (obtained
+										//  through GetGroundingFeature)
+} TCompiledBeliefUpdatingModel;
+typedef map <string, TCompiledBeliefUpdatingModel> 
+	TCompiledBeliefUpdatingModels;
+
 // D: the type definition for a grounding action that was run 
 // DеĻͶ
 #define GAT_TURN 0
@@ -167,6 +236,12 @@ private:
 	// (key = model_name, value= model policy string)
 	// policy Hash
 	STRING2STRING s2sPolicies;
+
+	// hashes holding the file each policy was loaded from, and the key 
+	// identifying the policy contents in the policy caches: the file name, 
+	// the file time and a hash of the policy text (key = model_name)
+	STRING2STRING s2sPolicyFiles;
+	STRING2STRING s2sPolicyKeys;
 	//#########################################################################
 
 	// hash holding various constant parameters for feature computation
@@ -187,7 +262,20 @@ private:
 
 	// hash holding the precomputed belief updating features
 	// ϣԤȼ
-	STRING2FLOAT s2fBeliefUpdatingFeatures;
+	vector<float> vfBeliefUpdatingFeatures;
+	// the id of the concept for the concept_id(...) features (-1 if none)
+	int iConceptIdFeature;
+	// indicates whether the features above are currently precomputed
+	bool bBeliefUpdatingFeaturesPrecomputed;
+
+	// the belief updating models, compiled against the precomputed 
+	// features (key = system action)
+	TCompiledBeliefUpdatingModels mapCompiledBeliefUpdatingModels;
+
+	// the concept ids used by the concept_id(...) features (key = concept),
+	// and the corresponding feature names (indexed by concept id)
+	map<string, int> mapConceptIds;
+	TStringVector vsConceptIdNames;
 
 	//############################CGroundingAction#########################################
 	//      GROUNDING_ACTION(NO_ACTION, NO_ACTION, Configuration)
@@ -207,6 +295,10 @@ private:
 	// ϣָⲿʵֵĲԵָ
 	TExternalPolicies mapExternalPolicies;
 
+	// hash with the compiled policies (shared by the grounding models 
+	// that use the same policy)
+	TCompiledPolicies mapCompiledPolicies;
+
 	// the grounding manager configuration
 	// ӵع - ṹ
 	TGroundingManagerConfiguration gmcConfig;
@@ -223,6 +315,14 @@ private:
 	// flag indicating if the stack is locked
 	// ־ - vcgrConceptGroundingRequests
 	bool bLockedGroundingRequests;
+
+	// the concept grounding requests batch: while a batch is open, the 
+	// requests are only recorded here, and are issued (once per concept) 
+	// when the batch is committed, or when the queue is changed; the 
+	// queries on the queue take the batched requests into account
+	int iGroundingRequestsBatchDepth;
+	TConceptPointersVector vcpBatchedGroundingRequests;
+	TConceptPointersSet scpBatchedGroundingRequests;
 	//##########################GroundingRequests####################################
 
 	// the history of grounding actions
@@ -292,10 +392,24 @@ public:
 	// ĳӵģ͵Ĳ
 	virtual string GetPolicy(string sModelName);
 
+	// Return the file a policy was loaded from, and the key identifying 
+	// the policy contents in the parsed and compiled policy caches
+	virtual string GetPolicyFile(string sModelName);
+	virtual string GetPolicyKey(string sModelName);
+
 	// Create an external policy interface
 	// ⲿԽ
 	CExternalPolicyInterface* CreateExternalPolicyInterface(string sAHost);
 
+	// Obtain the compiled form of a policy (compiled from the parsed form 
+	// the first time it is requested), and release all compiled policies
+	CCompiledPolicy* GetCompiledPolicy(string sPolicyKey, 
+		TPolicy& rpPolicy, int iNumActions);
+	void ReleaseCompiledPolicies();
+
+	// Account the memory held by the compiled policies
+	void AccountMemoryUsage(TMemoryAccount& rmaAccount);
+
 	// Release all external policy interaces
 	// ͷⲿ
 	void ReleaseExternalPolicyInterfaces();
@@ -317,6 +431,10 @@ public:
 	// ģ
 	virtual string GetBeliefUpdatingModelName();
 
+	// Gets the belief updating model (one of the BUM_* constants)
+	// 
+	int GetBeliefUpdatingModel();
+
 	// Returns an actual belief updating model, corresponding to a certain system action
 	// ضӦĳϵͳʵθģ
 	virtual STRING2FLOATVECTOR& GetBeliefUpdatingModelForAction(string sSystemAction);
@@ -341,6 +459,12 @@ public:
 	// 
 	virtual void ClearBeliefUpdatingFeatures();
 
+	// Computes the scores of the belief updating model for a system action
+	// from the precomputed features (the per-feature terms are appended
+	// to rsLog)
+	virtual void ComputeBeliefUpdatingScores(string sSystemAction,
+		double& rfScore1, double& rfScore2, string& rsLog);
+
 	//---------------------------------------------------------------------
 	// Methods for access to concept priors, confusability and concept
 	// type information
@@ -391,6 +515,11 @@ public:
 	// ҪGroudingǰconcept
 	void RequestConceptGrounding(CConcept* pConcept);
 
+	// open / commit a batch of concept grounding requests (batches can be
+	// nested; the requests are issued when the outermost one is committed)
+	void BeginConceptGroundingRequestsBatch();
+	void CommitConceptGroundingRequestsBatch();
+
 	// force the grounding manager to schedule grounding for a concept; returns the action that got scheduled
 	// ǿƽӵعΪһŽӵ; ѵȵĲ
 	string ScheduleConceptGrounding(CConcept* pConcept);
@@ -523,9 +652,36 @@ private:
 	// ظӵδҵ򷵻-1
 	int getConceptGroundingRequestIndex(CConcept* pConcept);
 
+	// Issue a concept grounding request (moves the concept at the end of
+	// the queue)
+	void issueConceptGroundingRequest(CConcept* pConcept);
+
+	// Issue the batched concept grounding requests
+	void flushBatchedConceptGroundingRequests();
+
+	// Check if a concept has a batched (not yet issued) grounding request
+	bool isConceptGroundingRequestBatched(CConcept* pConcept);
+
 	// Load a policy from its description file
 	// ļز
 	string loadPolicy(string sFileName);
+
+	// Record the file a policy was loaded from, and compute its key
+	void recordPolicyFile(string sModelName, string sFileName);
+
+	// Compile the belief updating models against the precomputed features
+	void compileBeliefUpdatingModels();
+
+	// Return the id of a precomputed belief updating feature (-1 if the
+	// feature is not precomputed)
+	int beliefUpdatingFeatureNameToId(string sFeatureName);
+
+	// Return the concept id for a concept_id(...) feature (-1 if none)
+	int conceptIdFeatureToConceptId(string sFeatureName);
+
+	// Look up the value of a precomputed belief updating feature by name
+	// (returns false if the feature is not precomputed)
+	bool getBeliefUpdatingFeature(string sFeatureName, float& rfValue);
 };
 
 #endif // __GROUNDINGMANAGERAGENT_H__
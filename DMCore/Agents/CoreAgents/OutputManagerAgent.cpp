@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added RenewConceptNotificationRequest
+//   [2026-10-19] (mbrenner): added memory accounting for the output history
 //   [2006-06-15] (antoine): merged with latest RavenClaw1 version
 //   [2005-01-26] (antoine): modified output so that it handles the 
 //                           ":non-listening" flag
@@ -214,6 +216,32 @@ inline COutput* COutputHistory::operator [](unsigned int iIndex)
 	return GetOutputAt(iIndex);
 }
 
+// M: accounts the memory held by the history: the utterances, and the 
+//    outputs (each of which carries the dialog state string at the time it
+//    was issued)
+void COutputHistory::AccountMemoryUsage(TMemoryAccount& rmaAccount)
+{
+	int iBytes = (int)(vsUtterances.capacity() * sizeof(string) +
+		vopOutputs.capacity() * sizeof(COutput*));
+	for (unsigned int i = 0; i < vsUtterances.size(); i++)
+		iBytes += StringHeapBytes(vsUtterances[i]);
+	for (unsigned int i = 0; i < vopOutputs.size(); i++)
+	{
+		COutput* pOutput = vopOutputs[i];
+		iBytes += sizeof(COutput) +
+			StringHeapBytes(pOutput->sGeneratorAgentName) +
+			StringHeapBytes(pOutput->sDialogState) +
+			StringHeapBytes(pOutput->sAct) +
+			StringHeapBytes(pOutput->sObject) +
+			StringHeapBytes(pOutput->sOutputDeviceName) +
+			(int)(pOutput->vcpConcepts.capacity() * sizeof(CConcept*)) +
+			(int)(pOutput->vsFlags.capacity() * sizeof(string));
+		for (unsigned int f = 0; f < pOutput->vsFlags.size(); f++)
+			iBytes += StringHeapBytes(pOutput->vsFlags[f]);
+	}
+	AccountMemory(rmaAccount, MA_OUTPUT_HISTORY, vopOutputs.size(), iBytes);
+}
+
 
 //-----------------------------------------------------------------------------
 //
@@ -489,8 +517,8 @@ vector<COutput*> COutputManagerAgent::Output(CDialogAgent* pGeneratorAgent, stri
 #endif
 		//######################################################## output################################################################
 		// <8>	output, ǿpromptoutput
-		//bool CFrameOutput::Create(string sAGeneratorAgentName, int iAExecutionIndex, string sAOutput, TFloorStatus fsAFloor, int iAOutputId)
-		if (!pOutput->Create(pGeneratorAgent->GetName(), pStateManager->GetStateHistoryLength() - 1, sFirstPrompt, fsFloor, iOutputCounter))
+		//bool CFrameOutput::Create(CDialogAgent* pAGeneratorAgent, int iAExecutionIndex, string sAOutput, TFloorStatus fsAFloor, int iAOutputId)
+		if (!pOutput->Create(pGeneratorAgent, pStateManager->GetStateHistoryLength() - 1, sFirstPrompt, fsFloor, iOutputCounter))
 		{
 			// if the output could not be created, deallocate it and ignore
 			// outputʧܣ󣬲ѭ
@@ -788,6 +816,22 @@ void COutputManagerAgent::CancelConceptNotificationRequest(
 	LeaveCriticalSection(&csCriticalSection);
 }
 
+// M: Renews a concept notification request (cancelled earlier)
+void COutputManagerAgent::RenewConceptNotificationRequest(
+	CConcept* pConcept)
+{
+	// guard for safe access
+	EnterCriticalSection(&csCriticalSection);
+	// renew the notification in the recent outputs
+	for (unsigned int i = 0; i < vopRecentOutputs.size(); i++)
+		vopRecentOutputs[i]->RenewConceptNotificationRequest(pConcept);
+	// and in the history outputs
+	for (unsigned int i = 0; i < ohHistory.GetSize(); i++)
+		ohHistory[i]->RenewConceptNotificationRequest(pConcept);
+	// leave critical section
+	LeaveCriticalSection(&csCriticalSection);
+}
+
 // D: Changes a concept notification request
 void COutputManagerAgent::ChangeConceptNotificationPointer(
 	CConcept* pOldConcept, CConcept* pNewConcept)
@@ -826,6 +870,12 @@ string COutputManagerAgent::GetPromptsWaitingForNotification()
 	return sResult;
 }
 
+// M: accounts the memory held by the output history
+void COutputManagerAgent::AccountMemoryUsage(TMemoryAccount& rmaAccount)
+{
+	ohHistory.AccountMemoryUsage(rmaAccount);
+}
+
 //-----------------------------------------------------------------------------
 // A: COutputManager private (helper) methods
 //-----------------------------------------------------------------------------
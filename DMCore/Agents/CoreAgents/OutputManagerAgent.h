@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added RenewConceptNotificationRequest
+//   [2026-10-19] (mbrenner): added memory accounting for the output history
 //   [2006-06-15] (antoine): merged with latest RavenClaw1 version
 //   [2005-01-26] (antoine): modified output so that it handles the 
 //                           ":non-listening" flag
@@ -175,6 +177,9 @@ public:
 	string GetUtteranceAt(unsigned int iIndex);
 	COutput* GetOutputAt(unsigned int iIndex);
 	COutput* operator[](unsigned int iIndex);
+
+	// Method for accounting the memory held by the history
+	void AccountMemoryUsage(TMemoryAccount& rmaAccount);
 };
 
 //-----------------------------------------------------------------------------
@@ -286,6 +291,9 @@ public:
 	// 取消概念通知请求
 	void CancelConceptNotificationRequest(CConcept* pConcept);
 
+	// Renews a concept notification request (cancelled earlier)
+	void RenewConceptNotificationRequest(CConcept* pConcept);
+
 	// Changes a concept notification request
 	// 更改概念通知请求
 	void ChangeConceptNotificationPointer(CConcept* pOldConcept, CConcept* pNewConcept);
@@ -294,6 +302,9 @@ public:
 	// 返回等待通知的提示列表
 	string GetPromptsWaitingForNotification();
 
+	// Accounts the memory held by the output history
+	void AccountMemoryUsage(TMemoryAccount& rmaAccount);
+
 private:
 
 	//---------------------------------------------------------------------
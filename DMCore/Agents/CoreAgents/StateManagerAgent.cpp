@@ -54,6 +54,18 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the cached dialog state names are redone when
+//                            the agent name or the mapping changes
+//   [2026-10-19] (mbrenner): the delta broadcast builds the agenda sections 
+//                            from the agenda levels; the base snapshots use
+//                            the delta format (bottom-up stack, with sizes)
+//   [2026-10-19] (mbrenner): added memory accounting for the state history
+//   [2026-10-19] (mbrenner): added a delta mode for the state broadcast 
+//                            (versioned base snapshots, followed by deltas
+//                            of the stack, agenda and input line config)
+//   [2026-10-19] (mbrenner): the dialog state names are compiled into a 
+//                            substring matcher, and cached per focused agent
+//   [2026-10-19] (mbrenner): UpdateState marks the dialog state journal
 //	 [2007-06-02] (antoine): fixed GetLastState and operator[] so that they
 //							 return reference to TDialogState instead of 
 //							 copies of these objects
@@ -84,7 +96,9 @@ CStateManagerAgent::CStateManagerAgent(string sAName,
 	string sAType) :
 	CAgent(sAName, sAConfiguration, sAType)
 {
-	// notfhing here	
+	// the state is broadcast in full by default
+	sbmBroadcastMode = sbmFull;
+	clearBroadcastSections();
 }
 
 // Virtual destructor - does nothing at this point
@@ -110,6 +124,7 @@ CAgent* CStateManagerAgent::AgentFactory(string sAName, string sAConfiguration)
 void CStateManagerAgent::Reset()
 {
 	vStateHistory.clear();
+	clearBroadcastSections();
 }
 
 //-----------------------------------------------------------------------------
@@ -168,10 +183,63 @@ void CStateManagerAgent::LoadDialogStateNames(string sFileName)
 	}
 	fclose(fid);
 
+	// compile the mapping
+	compileDialogStateNames();
+
 	// Log the states loaded
 	Log(STATEMANAGER_STREAM, "Dialog states specification loaded successfully.");
 }
 
+// M: compiles the dialog state names mapping into the substring matcher. The
+//    patterns are added in the order of the mapping, so that the matcher 
+//    returns the same entry as the linear scan over the mapping would
+void CStateManagerAgent::compileDialogStateNames()
+{
+	smDialogStateNames.Clear();
+	vsDialogStateNames.clear();
+	STRING2STRING::iterator iPtr;
+	for (iPtr = s2sDialogStateNames.begin(); iPtr != s2sDialogStateNames.end(); iPtr++)
+	{
+		smDialogStateNames.AddPattern(iPtr->first);
+		vsDialogStateNames.push_back(iPtr->second);
+	}
+	smDialogStateNames.Compile();
+	s2sCompiledDialogStateNames = s2sDialogStateNames;
+	// and forget the cached results
+	viDialogStateNameByAgent.clear();
+	vsDialogStateNameAgents.clear();
+}
+
+// M: returns the index of the dialog state name for an agent. The result 
+//    is cached by the agent's registry handle, together with the agent name
+//    it was computed for: handles are reused after the dynamic agents are 
+//    unregistered, and agents change names when they are reparented, so 
+//    the match is redone whenever the name differs
+int CStateManagerAgent::getDialogStateNameIndex(CDialogAgent* pdaAgent)
+{
+	// the mapping might have been changed directly
+	if (s2sCompiledDialogStateNames != s2sDialogStateNames)
+		compileDialogStateNames();
+
+	int iHandle = pdaAgent->GetRegistryHandle();
+	if (iHandle == NULL_AGENT_HANDLE)
+		return smDialogStateNames.FindFirstPattern(pdaAgent->GetName());
+
+	if ((int)viDialogStateNameByAgent.size() <= iHandle)
+	{
+		viDialogStateNameByAgent.resize(iHandle + 1, -2);
+		vsDialogStateNameAgents.resize(iHandle + 1);
+	}
+	if ((viDialogStateNameByAgent[iHandle] == -2) ||
+		(vsDialogStateNameAgents[iHandle] != pdaAgent->GetName()))
+	{
+		viDialogStateNameByAgent[iHandle] =
+			smDialogStateNames.FindFirstPattern(pdaAgent->GetName());
+		vsDialogStateNameAgents[iHandle] = pdaAgent->GetName();
+	}
+	return viDialogStateNameByAgent[iHandle];
+}
+
 // D: Sets the expectation state broadcast address
 void CStateManagerAgent::SetStateBroadcastAddress(
 	string sAStateBroadcastAddress)
@@ -179,6 +247,154 @@ void CStateManagerAgent::SetStateBroadcastAddress(
 	sStateBroadcastAddress = sAStateBroadcastAddress;
 }
 
+// M: Sets the state broadcast mode
+void CStateManagerAgent::SetStateBroadcastMode(string sABroadcastMode)
+{
+	sABroadcastMode = ToLowerCase(Trim(sABroadcastMode));
+	if ((sABroadcastMode == "") || (sABroadcastMode == "full"))
+		sbmBroadcastMode = sbmFull;
+	else if (sABroadcastMode == "delta")
+		sbmBroadcastMode = sbmDelta;
+	else
+	{
+		Warning(FormatString("Unknown state broadcast mode (%s). Broadcasting"\
+			" the full state.", sABroadcastMode.c_str()));
+		sbmBroadcastMode = sbmFull;
+	}
+	// and start over with a base snapshot
+	clearBroadcastSections();
+}
+
+// M: Requests that the next state broadcast is a base snapshot. This is 
+//    called (from the interface thread) when a consumer receives a delta 
+//    whose base version is not the last version it has seen
+void CStateManagerAgent::RequestStateResync()
+{
+	bBroadcastResyncRequested = true;
+}
+
+// M: forgets the last broadcast state
+void CStateManagerAgent::clearBroadcastSections()
+{
+	iBroadcastVersion = 0;
+	iDeltasSinceBase = 0;
+	bBroadcastResyncRequested = false;
+	s2sLastBroadcastHeader.clear();
+	vsLastBroadcastStack.clear();
+	vsLastBroadcastAgenda.clear();
+	s2sLastBroadcastInputLineConfig.clear();
+}
+
+// M: splits a dialog state into the sections tracked by the delta broadcast:
+//    the header fields, the names of the agents on the stack (from the 
+//    bottom up, so that pushes and pops only touch the last entries), the
+//    levels of the agenda (built directly from the agenda levels) and the
+//    input line configuration
+void CStateManagerAgent::getBroadcastSections(TDialogState& rdsState,
+	STRING2STRING& rs2sHeader, TStringVector& rvsStack,
+	TStringVector& rvsAgenda, STRING2STRING& rs2sInputLineConfig)
+{
+	rs2sHeader["turn_number"] = IntToString(rdsState.iTurnNumber);
+	rs2sHeader["notify_prompts"] =
+		pOutputManager->GetPromptsWaitingForNotification();
+	rs2sHeader["dialog_state"] = rdsState.sStateName;
+	rs2sHeader["nonu_threshold"] =
+		FormatString("%.4f", pDMCore->GetNonunderstandingThreshold());
+
+	rvsStack.clear();
+	TExecutionStack::reverse_iterator iPtr;
+	for (iPtr = rdsState.esExecutionStack.rbegin();
+		iPtr != rdsState.esExecutionStack.rend();
+		iPtr++)
+		rvsStack.push_back(iPtr->pdaAgent->GetName());
+
+	rvsAgenda.clear();
+	for (unsigned int l = 0; 
+		l < rdsState.eaAgenda.vCompiledExpectations.size(); l++)
+		rvsAgenda.push_back(Trim(pDMCore->expectationAgendaLevelToBroadcastString(
+		rdsState.eaAgenda, l), "\n"));
+
+	rs2sInputLineConfig = StringToS2SHash(rdsState.sInputLineConfiguration);
+}
+
+// M: computes the delta between the last broadcast sections and the given
+//    ones. The delta has one "key = value" line for each header field that 
+//    changed, the stack and agenda sizes and changed entries (stack.<i>, 
+//    numbered from the bottom of the stack, and agenda.<i>), the changed 
+//    input line configuration keys (input_line_config.<key>) and the 
+//    removed ones (input_line_config_removed). A base snapshot is the delta
+//    against an empty state (and always includes the sizes), so that the
+//    snapshots and the deltas use the same keys and the same stack order
+string CStateManagerAgent::computeBroadcastDelta(STRING2STRING& rs2sHeader,
+	TStringVector& rvsStack, TStringVector& rvsAgenda,
+	STRING2STRING& rs2sInputLineConfig, bool bBaseSnapshot)
+{
+	string sDelta;
+	STRING2STRING::iterator iPtr;
+	STRING2STRING::iterator iLastPtr;
+
+	// the sections to compare against
+	STRING2STRING s2sEmpty;
+	TStringVector vsEmpty;
+	STRING2STRING& s2sLastBroadcastHeader = bBaseSnapshot ? 
+		s2sEmpty : this->s2sLastBroadcastHeader;
+	TStringVector& vsLastBroadcastStack = bBaseSnapshot ? 
+		vsEmpty : this->vsLastBroadcastStack;
+	TStringVector& vsLastBroadcastAgenda = bBaseSnapshot ? 
+		vsEmpty : this->vsLastBroadcastAgenda;
+	STRING2STRING& s2sLastBroadcastInputLineConfig = bBaseSnapshot ? 
+		s2sEmpty : this->s2sLastBroadcastInputLineConfig;
+
+	// the header fields
+	for (iPtr = rs2sHeader.begin(); iPtr != rs2sHeader.end(); iPtr++)
+	{
+		iLastPtr = s2sLastBroadcastHeader.find(iPtr->first);
+		if ((iLastPtr == s2sLastBroadcastHeader.end()) ||
+			(iLastPtr->second != iPtr->second))
+			sDelta += FormatString("%s = %s\n", iPtr->first.c_str(),
+			iPtr->second.c_str());
+	}
+
+	// the stack
+	if (bBaseSnapshot || (rvsStack.size() != vsLastBroadcastStack.size()))
+		sDelta += FormatString("stack.size = %d\n", rvsStack.size());
+	for (unsigned int i = 0; i < rvsStack.size(); i++)
+		if ((i >= vsLastBroadcastStack.size()) ||
+			(vsLastBroadcastStack[i] != rvsStack[i]))
+			sDelta += FormatString("stack.%d = %s\n", i, rvsStack[i].c_str());
+
+	// the agenda
+	if (bBaseSnapshot || (rvsAgenda.size() != vsLastBroadcastAgenda.size()))
+		sDelta += FormatString("agenda.size = %d\n", rvsAgenda.size());
+	for (unsigned int i = 0; i < rvsAgenda.size(); i++)
+		if ((i >= vsLastBroadcastAgenda.size()) ||
+			(vsLastBroadcastAgenda[i] != rvsAgenda[i]))
+			sDelta += FormatString("agenda.%d = {\n%s\n}\n", i,
+			rvsAgenda[i].c_str());
+
+	// the input line configuration
+	for (iPtr = rs2sInputLineConfig.begin();
+		iPtr != rs2sInputLineConfig.end(); iPtr++)
+	{
+		iLastPtr = s2sLastBroadcastInputLineConfig.find(iPtr->first);
+		if ((iLastPtr == s2sLastBroadcastInputLineConfig.end()) ||
+			(iLastPtr->second != iPtr->second))
+			sDelta += FormatString("input_line_config.%s = %s\n",
+			iPtr->first.c_str(), iPtr->second.c_str());
+	}
+	string sRemoved;
+	for (iLastPtr = s2sLastBroadcastInputLineConfig.begin();
+		iLastPtr != s2sLastBroadcastInputLineConfig.end(); iLastPtr++)
+		if (rs2sInputLineConfig.find(iLastPtr->first) ==
+			rs2sInputLineConfig.end())
+			sRemoved += (sRemoved == "" ? "" : ", ") + iLastPtr->first;
+	if (sRemoved != "")
+		sDelta += FormatString("input_line_config_removed = %s\n",
+		sRemoved.c_str());
+
+	return TrimRight(sDelta);
+}
+
 // D: broadcasts the state to other components in the system
 // D״̬㲥ϵͳе
 void CStateManagerAgent::BroadcastState()
@@ -186,7 +402,26 @@ void CStateManagerAgent::BroadcastState()
 
 	// construct the string state representation
 	//ַ״̬ʾ
-	string sDialogState = GetStateAsString();
+	// (in delta mode, only the base snapshots carry the full state)
+	string sDialogState;
+	STRING2STRING s2sHeader;
+	TStringVector vsStack;
+	TStringVector vsAgenda;
+	STRING2STRING s2sInputLineConfig;
+	bool bBaseSnapshot = true;
+	if (sbmBroadcastMode == sbmDelta)
+	{
+		getBroadcastSections(GetLastState(), s2sHeader, vsStack, vsAgenda,
+			s2sInputLineConfig);
+		bBaseSnapshot = (iBroadcastVersion == 0) || bBroadcastResyncRequested ||
+			(iDeltasSinceBase >= STATE_BROADCAST_BASE_PERIOD);
+		iBroadcastVersion++;
+	}
+	if (sbmBroadcastMode == sbmFull)
+		sDialogState = GetStateAsString();
+	else if (bBaseSnapshot)
+		sDialogState = computeBroadcastDelta(s2sHeader, vsStack, vsAgenda,
+		s2sInputLineConfig, true);
 
 	// if we are in a Galaxy configuration, send notification to the hub
 //#ifdef GALAXY	
@@ -206,8 +441,50 @@ void CStateManagerAgent::BroadcastState()
 	gcGalaxyCall.bBlockingCall = false;
 	gcGalaxyCall.s2sInputs.insert(
 		STRING2STRING::value_type(":set_dialog_state", "1"));
-	gcGalaxyCall.s2sInputs.insert(
-		STRING2STRING::value_type(":dialog_state", sDialogState));
+	if (sbmBroadcastMode == sbmFull)
+	{
+		gcGalaxyCall.s2sInputs.insert(
+			STRING2STRING::value_type(":dialog_state", sDialogState));
+	}
+	else if (bBaseSnapshot)
+	{
+		// a base snapshot: the full state (in the delta format, against an
+		// empty state), and its version
+		Log(STATEMANAGER_STREAM, "Dialog state base snapshot (version %d).",
+			iBroadcastVersion);
+		gcGalaxyCall.s2sInputs.insert(
+			STRING2STRING::value_type(":dialog_state", sDialogState));
+		gcGalaxyCall.s2sInputs.insert(STRING2STRING::value_type(
+			":dialog_state_version", IntToString(iBroadcastVersion)));
+		gcGalaxyCall.s2sInputs.insert(
+			STRING2STRING::value_type(":dialog_state_base", "1"));
+		iDeltasSinceBase = 0;
+		bBroadcastResyncRequested = false;
+	}
+	else
+	{
+		// a delta against the previous version; a consumer which has not 
+		// seen that version asks for a resync
+		Log(STATEMANAGER_STREAM, "Dialog state delta (version %d).",
+			iBroadcastVersion);
+		gcGalaxyCall.s2sInputs.insert(STRING2STRING::value_type(
+			":dialog_state_version", IntToString(iBroadcastVersion)));
+		gcGalaxyCall.s2sInputs.insert(STRING2STRING::value_type(
+			":dialog_state_base_version", IntToString(iBroadcastVersion - 1)));
+		gcGalaxyCall.s2sInputs.insert(STRING2STRING::value_type(
+			":dialog_state_delta", computeBroadcastDelta(s2sHeader, vsStack,
+			vsAgenda, s2sInputLineConfig, false)));
+		iDeltasSinceBase++;
+	}
+
+	// remember the broadcast sections, for the next delta
+	if (sbmBroadcastMode == sbmDelta)
+	{
+		s2sLastBroadcastHeader = s2sHeader;
+		vsLastBroadcastStack = vsStack;
+		vsLastBroadcastAgenda = vsAgenda;
+		s2sLastBroadcastInputLineConfig = s2sInputLineConfig;
+	}
 
 	// retrieve the current thread id
 	// ǰ߳id
@@ -256,6 +533,7 @@ void CStateManagerAgent::UpdateState()
 	dsDialogState.saSystemAction = pDMCore->saSystemAction;
 	dsDialogState.iTurnNumber = pDMCore->iTurnNumber;
 	dsDialogState.iEHIndex = pDMCore->esExecutionStack.front().iEHIndex;
+	dsDialogState.iJournalIndex = pDMCore->MarkDialogStateJournal();
 
 	//		compute the dialog state 
 	// <3>	###Ի״̬ => State Name###
@@ -266,16 +544,11 @@ void CStateManagerAgent::UpdateState()
 	}
 	else
 	{
-		// go through the mapping and find something that matches the focus
-		STRING2STRING::iterator iPtr;
-		for (iPtr = s2sDialogStateNames.begin(); iPtr != s2sDialogStateNames.end(); iPtr++)
-		{
-			if (dsDialogState.sFocusedAgentName.find(iPtr->first) != -1)//agents2sDialogStateNamesе״̬е
-			{
-				dsDialogState.sStateName = iPtr->second;
-				break;
-			}
-		}
+		// find the first entry in the mapping whose agent name occurs in the
+		// name of the focused agent (compiled, and cached per agent)
+		int iStateName = getDialogStateNameIndex(pDMCore->GetAgentInFocus());
+		if (iStateName != -1)
+			dsDialogState.sStateName = vsDialogStateNames[iStateName];
 		// if we couldn't find anything in the mapping, then set it to 
 		// _unknown_
 		if (dsDialogState.sStateName == "")//s2sDialogStateNamesǿգûҵstate
@@ -348,3 +621,27 @@ TDialogState &CStateManagerAgent::operator[](unsigned int i)
 {
 	return vStateHistory[i];
 }
+
+// M: accounts the memory held by the state history (each state holds its 
+//    own copy of the execution stack and of the expectation agenda)
+void CStateManagerAgent::AccountMemoryUsage(TMemoryAccount& rmaAccount)
+{
+	int iBytes = (int)(vStateHistory.capacity() * sizeof(TDialogState));
+	for (unsigned int i = 0; i < vStateHistory.size(); i++)
+	{
+		TDialogState& rdsState = vStateHistory[i];
+		iBytes += StringHeapBytes(rdsState.sFocusedAgentName) +
+			StringHeapBytes(rdsState.sInputLineConfiguration) +
+			StringHeapBytes(rdsState.sStateName) +
+			(int)(rdsState.esExecutionStack.size() *
+			(sizeof(TExecutionStackItem) + LIST_NODE_OVERHEAD)) +
+			pDMCore->GetExpectationAgendaHeapBytes(rdsState.eaAgenda) +
+			(int)((rdsState.saSystemAction.setcpRequests.size() +
+			rdsState.saSystemAction.setcpExplicitConfirms.size() +
+			rdsState.saSystemAction.setcpImplicitConfirms.size() +
+			rdsState.saSystemAction.setcpUnplannedImplicitConfirms.size()) *
+			(sizeof(CConcept*) + TREE_NODE_OVERHEAD));
+	}
+	AccountMemory(rmaAccount, MA_STATE_HISTORY, vStateHistory.size(), iBytes);
+}
+
@@ -55,6 +55,17 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the cached dialog state names are checked
+//                            against the agent name and the mapping
+//   [2026-10-19] (mbrenner): the delta mode base snapshots use the delta 
+//                            format
+//   [2026-10-19] (mbrenner): added memory accounting for the state history
+//   [2026-10-19] (mbrenner): added a delta mode for the state broadcast 
+//                            (versioned base snapshots, followed by deltas
+//                            of the stack, agenda and input line config)
+//   [2026-10-19] (mbrenner): the dialog state names are compiled into a 
+//                            substring matcher, and cached per focused agent
+//   [2026-10-19] (mbrenner): added the dialog state journal index to TDialogState
 //	 [2007-06-02] (antoine): fixed GetLastState and operator[] so that they
 //							 return reference to TDialogState instead of 
 //							 copies of these objects
@@ -100,9 +111,23 @@ typedef struct
 	int iTurnNumber;					// the current turn number					//ǰturn
 	int iEHIndex;						// the execution history index matching		//ִʷindex
 	// this di`alog state
+	int iJournalIndex;					// the dialog state journal index 
+	// matching this dialog state
 	string sStateName;					// the name of the current dialog state		//״̬
 } TDialogState;
 
+// D: the modes in which the dialog state can be broadcast
+typedef enum
+{
+	sbmFull,		// every broadcast carries the full state
+	sbmDelta		// a versioned base snapshot, followed by deltas against
+					// the previous broadcast (both as "key = value" lines)
+} TStateBroadcastMode;
+
+// D: in delta mode, a full base snapshot is sent at least once every so 
+//    many broadcasts
+#define STATE_BROADCAST_BASE_PERIOD 20
+
 // D: the CStateManager class definition
 //ǸٶԻе״̬ϢĴ
 class CStateManagerAgent : public CAgent
@@ -113,6 +138,20 @@ public:
 	// Իstate [agent -> state]
 	STRING2STRING s2sDialogStateNames;
 
+	// the agent names in s2sDialogStateNames compiled into a matcher (the
+	// patterns are added in the order of the mapping), the state names in 
+	// the same order, and the mapping they were compiled from (to detect
+	// direct changes to s2sDialogStateNames)
+	CSubstringMatcher smDialogStateNames;
+	TStringVector vsDialogStateNames;
+	STRING2STRING s2sCompiledDialogStateNames;
+
+	// the index of the state name for each focused agent, by registry handle
+	// (-2 if not computed yet), and the agent name it was computed for 
+	// (handles are reused, and agents can be renamed)
+	TIntVector viDialogStateNameByAgent;
+	TStringVector vsDialogStateNameAgents;
+
 	// private vector containing a history of the states that the DM went through
 	// private, DM״̬ʷ
 	vector<TDialogState, allocator<TDialogState>> vStateHistory;
@@ -121,6 +160,24 @@ public:
 	// ״̬㲥ַ
 	string sStateBroadcastAddress;
 
+	// the state broadcast mode, the version of the last broadcast (0 if 
+	// nothing was broadcast yet) and the number of deltas sent since the 
+	// last base snapshot
+	TStateBroadcastMode sbmBroadcastMode;
+	int iBroadcastVersion;
+	int iDeltasSinceBase;
+
+	// set when a consumer of the broadcast asks for a resync; the next 
+	// broadcast will then be a base snapshot
+	volatile bool bBroadcastResyncRequested;
+
+	// the sections of the last broadcast state, against which the deltas
+	// are computed (the stack entries are indexed from the bottom)
+	STRING2STRING s2sLastBroadcastHeader;
+	TStringVector vsLastBroadcastStack;
+	TStringVector vsLastBroadcastAgenda;
+	STRING2STRING s2sLastBroadcastInputLineConfig;
+
 public:
 
 	//---------------------------------------------------------------------
@@ -157,6 +214,12 @@ public:
 	// agenda㲥ַ
 	void SetStateBroadcastAddress(string sAStateBroadcastAddress);
 
+	// Set the state broadcast mode ("full" or "delta")
+	void SetStateBroadcastMode(string sABroadcastMode);
+
+	// Request that the next state broadcast is a base snapshot
+	void RequestStateResync();
+
 	// Broadcast the state to the other components in the system
 	// ״̬㲥ϵͳе
 	void BroadcastState();
@@ -182,6 +245,32 @@ public:
 	// ز[] ,ȡ״̬
 	TDialogState &operator[](unsigned int i);
 
+	// Accounts the memory held by the state history
+	void AccountMemoryUsage(TMemoryAccount& rmaAccount);
+
+private:
+	// compiles the dialog state names mapping into the matcher
+	void compileDialogStateNames();
+
+	// returns the index of the dialog state name for an agent, or -1 if 
+	// none of the agent names in the mapping occurs in the agent's name
+	int getDialogStateNameIndex(CDialogAgent* pdaAgent);
+
+	// splits a dialog state into the sections that are tracked by the 
+	// delta broadcast
+	void getBroadcastSections(TDialogState& rdsState,
+		STRING2STRING& rs2sHeader, TStringVector& rvsStack,
+		TStringVector& rvsAgenda, STRING2STRING& rs2sInputLineConfig);
+
+	// computes the delta between the last broadcast sections (or an empty
+	// state, for a base snapshot) and the given ones
+	string computeBroadcastDelta(STRING2STRING& rs2sHeader,
+		TStringVector& rvsStack, TStringVector& rvsAgenda,
+		STRING2STRING& rs2sInputLineConfig, bool bBaseSnapshot);
+
+	// forgets the last broadcast state, so that the next broadcast is a 
+	// base snapshot
+	void clearBroadcastSections();
 };
 
 #endif // __STATEMANAGERAGENT_H__
\ No newline at end of file
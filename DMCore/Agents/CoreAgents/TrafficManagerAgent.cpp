@@ -53,6 +53,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): concept updates use the update type enum
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
 //							  configurations
 //   [2003-03-13] (antoine): modified CTrafficManagerAgent::Call so that it 
@@ -243,7 +244,7 @@ void CTrafficManagerAgent::galaxyCall(TExternalCallSpec ecsCall) {
 					Log(TRAFFICMANAGERDUMP_STREAM, "Setting value: [%s] -> %s.",
 						sItem.c_str(),
 						ecsCall.vFromParams[i].pConcept->GetAgentQualifiedName().c_str());
-					ecsCall.vFromParams[i].pConcept->Update(CU_ASSIGN_FROM_STRING, &sValue);
+					ecsCall.vFromParams[i].pConcept->Update(cuAssignFromString, &sValue);
 					break;
 				}
 			}
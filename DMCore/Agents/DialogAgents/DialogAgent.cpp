@@ -52,6 +52,23 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the printf-like C() and A() look up formatted 
+//                            paths without creating handles for them
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added the agent conditions cache
+//   [2026-10-19] (mbrenner): added AddSubAgents(), for mounting a set of 
+//                            sibling agents in one pass
+//   [2026-10-19] (mbrenner): LocalC returns the cached merged history view 
+//                            for @concept instead of a fresh clone
+//   [2026-10-19] (mbrenner): added CConceptRef and CAgentRef handles; C() and
+//                            A() now resolve paths through per-agent handle
+//                            caches, invalidated by the tree generation
+//   [2026-10-19] (mbrenner): added pre/post-order dialog tree labels; the
+//                            expectation declaration uses the pointer-based
+//                            ancestry checks
+//   [2026-10-19] (mbrenner): the completion/blocking flags and the counters are
+//                            now recorded in the dialog state journal before
+//                            they change; added GetStatus and SetStatus
 //   [2005-10-22] (antoine): Added methods RequiresFloor and 
 //							 IsConversationSynchronous to regulate turn-taking
 //                           and asynchronous agent planning/execution
@@ -102,6 +119,11 @@
 // references
 CDialogAgent NULLDialogAgent("NULL");
 
+// M: the dialog tree generation (see GetTreeGeneration)
+int CDialogAgent::iTreeGeneration = 0;
+int CDialogAgent::iDialogStateGeneration = 0;
+TConditionDependencies* CDialogAgent::pcdConditionDependencies = NULL;
+
 //-----------------------------------------------------------------------------
 //
 // Constructors and destructors
@@ -121,6 +143,8 @@ CAgent(sAName, sAConfiguration, sAType)
 	bBlocked = false;
 	bDynamicAgent = false;
 	sDynamicAgentID = "";
+	iPreOrderLabel = -1;
+	iPostOrderLabel = -1;
 	sTriggeredByCommands = "";
 	sTriggerCommandsGroundingModelSpec = "";
 	iExecuteCounter = 0;
@@ -130,6 +154,9 @@ CAgent(sAName, sAConfiguration, sAType)
 	iLastInputIndex = -1;
 	iLastExecutionIndex = -1;
 	iLastBindingsIndex = -1;
+	iStatusVersion = 0;
+	for (int i = 0; i < acNumConditions; i++)
+		ccConditionCache[i].bValid = false;
 	bInheritedParentInputConfiguration = false;
 }
 
@@ -154,6 +181,13 @@ CDialogAgent::~CDialogAgent()
 
 	// set the parent to NULL
 	pdaParent = NULL;
+
+	// handles that resolved to this agent or its concepts are now stale
+	IncrementTreeGeneration();
+
+	// and make sure the dialog state journal no longer refers to the agent
+	if (pDMCore)
+		pDMCore->ForgetJournaledAgent(this);
 }
 
 
@@ -181,7 +215,7 @@ void CDialogAgent::Register()
 {
 	//		register this agent
 	// <1>	עᵱǰagent
-	AgentsRegistry.RegisterAgent(sName, this);
+	iRegistryHandle = AgentsRegistry.RegisterAgent(sName, this);
 	//		and all its subagents
 	// <2>	ݹעagent
 	for (unsigned int i = 0; i < SubAgents.size(); i++)
@@ -191,6 +225,8 @@ void CDialogAgent::Register()
 	//		finally, create the trigger concept
 	// <3>	trigger Concept ??
 	CreateTriggerConcept();
+	// the new concepts may shadow concepts that handles have resolved to
+	IncrementTreeGeneration();
 }
 
 // D: Initializes the agent, gets called after creation
@@ -215,6 +251,8 @@ void CDialogAgent::Initialize()
 //λ - ʼ
 void CDialogAgent::Reset()
 {
+	// record the status in the journal
+	journalStatus();
 	// clears all the concepts
 	// concept
 	for (unsigned int i = 0; i < Concepts.size(); i++)
@@ -633,6 +671,13 @@ bool CDialogAgent::ClaimsFocus() //
 	return false;
 }
 
+// M: Virtual function which indicates if the values of the agent conditions
+//    can be cached. By default they are not (see CACHES_CONDITIONS)
+bool CDialogAgent::CachesConditions()
+{
+	return false;
+}
+
 // D: indicates if the agent claims the focus while grounding is in progress
 //    by default, this is false
 // Dʾ㣬ӵĬڽУǼٵ
@@ -762,6 +807,9 @@ void CDialogAgent::ReOpenConcepts()
 // DReOpenTopic
 void CDialogAgent::ReOpenTopic()
 {
+	// record the status in the journal
+	journalStatus();
+
 	// set completion to false
 	//ɱ־Ϊfalse
 	bCompleted = false;
@@ -999,6 +1047,7 @@ bool CDialogAgent::RequiresFloor()
 // By default: decrement execution counter and set to incomplete
 void CDialogAgent::Undo()
 {
+	journalStatus();
 	iExecuteCounter--;
 	ResetCompleted();
 }
@@ -1017,22 +1066,13 @@ void CDialogAgent::Undo()
 // DضsConceptPathԸ·ָconcept
 CConcept& CDialogAgent::C(string sConceptPath)
 {
-
-	string sAgentPath, sConceptName;
-	// check if we have an agent path in the concept name
-	//ڸǷд·
-	if (SplitOnLast(sConceptPath, "/", sAgentPath, sConceptName))
-	{
-		// if yes, identify the agent and call the local concept retrieval for
-		// that agent
-		//ǣʶøôıظ
-		return A(sAgentPath).LocalC(sConceptName);
-	}
-	else
-	{
-		// if not, go and try to find the concept locally
-		return LocalC(sConceptPath);
-	}
+	// go through the handle for this path (creating it the first time the 
+	// path is used); the handle walks the dialog task tree only when stale
+	TConceptRefsMap::iterator iPtr = s2crConceptRefs.find(sConceptPath);
+	if (iPtr == s2crConceptRefs.end())
+		iPtr = s2crConceptRefs.insert(TConceptRefsMap::value_type(
+		sConceptPath, CConceptRef(this, sConceptPath))).first;
+	return iPtr->second.Get();
 }
 
 // D: A printf-like version of the C() function
@@ -1048,8 +1088,31 @@ CConcept& CDialogAgent::C(const char *lpszConceptPath, ...)
 	// print the path into the buffer
 	_vsnprintf(buffer, STRING_MAX, lpszConceptPath, pArgs);
 
-	// and finally call the standard C() function to deal with it
-	return C((string)buffer);
+	// and finally call the standard C() function to deal with it; a path
+	// that was actually formatted can change from call to call, so it is 
+	// looked up directly, without creating a handle for it
+	if (strchr(lpszConceptPath, '%') == NULL)
+		return C((string)buffer);
+	return LookupC((string)buffer);
+}
+
+// M: the function returns a reference to the concept pointed by the 
+//    relative concept path in sConceptPath, without going through (or 
+//    creating) a handle
+CConcept& CDialogAgent::LookupC(string sConceptPath)
+{
+	// split the path into the agent part and the concept name
+	string sAgentPath, sConceptName;
+	SplitOnLast(sConceptPath, "/", sAgentPath, sConceptName);
+	if (sAgentPath.empty())
+		return LocalC(sConceptName);
+
+	// o/w look up the agent, and the concept from there
+	CDialogAgent& rdaAgent = LookupA(sAgentPath);
+	if (&rdaAgent == &NULLDialogAgent)
+		return NULLConcept;
+	RecordAgentDependency(&rdaAgent);
+	return rdaAgent.LocalC(sConceptName);
 }
 
 // D: the function returns a pointer to a local concept indicated by 
@@ -1107,11 +1170,12 @@ CConcept& CDialogAgent::LocalC(string sConceptName)
 	{
 		if (Concepts[i]->GetName() == sBaseConceptName)
 		{
-			// if we have found it
+			// if we have found it, record it for the condition being 
+			// evaluated (if any)
+			RecordConceptDependency(Concepts[i]);
 			if (bMergeConcept)
 			{
-				CConcept *pcMerged = Concepts[i]->operator[](sRest).CreateMergedHistoryConcept();
-				return *pcMerged;
+				return Concepts[i]->operator[](sRest).GetMergedHistoryConcept();
 			}
 			else
 			{
@@ -1139,10 +1203,23 @@ CConcept& CDialogAgent::LocalC(string sConceptName)
 //-----------------------------------------------------------------------------
 // Relative access to Agents
 //-----------------------------------------------------------------------------
+// M: the function returns a reference to the agent pointed by the relative
+//    agent path in sDialogAgentPath, through the handle for that path
+CDialogAgent& CDialogAgent::A(string sDialogAgentPath)
+{
+	TAgentRefsMap::iterator iPtr = s2arAgentRefs.find(sDialogAgentPath);
+	if (iPtr == s2arAgentRefs.end())
+		iPtr = s2arAgentRefs.insert(TAgentRefsMap::value_type(
+		sDialogAgentPath, CAgentRef(this, sDialogAgentPath))).first;
+	CDialogAgent& rdaAgent = iPtr->second.Get();
+	RecordAgentDependency(&rdaAgent);
+	return rdaAgent;
+}
+
 // D: the function returns a pointer to the agent pointed by the relative
 //    agent path in sDialogAgentPath
 // DһָsDialogAgentPath·ָagentָ
-CDialogAgent& CDialogAgent::A(string sDialogAgentPath)
+CDialogAgent& CDialogAgent::LookupA(string sDialogAgentPath)
 {
 
 	// split the relative agent path into the first component (until /)
@@ -1205,8 +1282,12 @@ CDialogAgent& CDialogAgent::A(string sDialogAgentPath)
 		{
 
 			// then it must be one of the descendants. Locate quickly using
-			// the registry
-			CDialogAgent* pdaAgent = (CDialogAgent*)
+			// the registry, going down from the handle of this agent
+			CDialogAgent* pdaAgent = (CDialogAgent*)AgentsRegistry.GetAgent(
+				AgentsRegistry.GetDescendantAgentHandle(iRegistryHandle,
+				sDialogAgentPath));
+			if (!pdaAgent)
+				pdaAgent = (CDialogAgent*)
 				AgentsRegistry[GetName() + "/" + sDialogAgentPath];
 			if (pdaAgent)
 			{
@@ -1253,9 +1334,12 @@ CDialogAgent& CDialogAgent::A(string sDialogAgentPath)
 
 		// if not, try and find the agent locally (it has to 
 		// be one of the subagents). Locate quickly using the registry.
-		CDialogAgent* pdaAgent = (CDialogAgent*)
-			AgentsRegistry[GetName() + "/" +
-			sDialogAgentPath];
+		CDialogAgent* pdaAgent = (CDialogAgent*)AgentsRegistry.GetAgent(
+			AgentsRegistry.GetChildAgentHandle(iRegistryHandle,
+			sDialogAgentPath));
+		if (!pdaAgent)
+			pdaAgent = (CDialogAgent*)
+			AgentsRegistry[GetName() + "/" + sDialogAgentPath];
 		if (pdaAgent)
 		{
 			// if the agent was found
@@ -1284,8 +1368,208 @@ CDialogAgent& CDialogAgent::A(const char *lpszDialogAgentPath, ...)
 	// print the path into the buffer
 	_vsnprintf(buffer, STRING_MAX, lpszDialogAgentPath, pArgs);
 
-	// and finally call the standard A() function to deal with it
-	return A((string)buffer);
+	// and finally call the standard A() function to deal with it; a path
+	// that was actually formatted can change from call to call, so it is 
+	// looked up directly, without creating a handle for it
+	if (strchr(lpszDialogAgentPath, '%') == NULL)
+		return A((string)buffer);
+	CDialogAgent& rdaAgent = LookupA((string)buffer);
+	RecordAgentDependency(&rdaAgent);
+	return rdaAgent;
+}
+
+// M: returns the dialog tree generation. The generation is incremented 
+//    whenever agents are attached to or removed from the tree, and whenever
+//    dynamic ids or context agents change, i.e. whenever a relative path 
+//    might resolve differently
+int CDialogAgent::GetTreeGeneration()
+{
+	return iTreeGeneration;
+}
+
+// M: increments the dialog tree generation, invalidating all the concept 
+//    and agent handles
+void CDialogAgent::IncrementTreeGeneration()
+{
+	iTreeGeneration++;
+}
+
+// M: increments the dialog state generation, invalidating the cached 
+//    conditions which read the dialog state
+void CDialogAgent::IncrementDialogStateGeneration()
+{
+	iDialogStateGeneration++;
+}
+
+// M: records that the condition being evaluated (if any) reads the dialog 
+//    state
+void CDialogAgent::RecordDialogStateDependency()
+{
+	if (pcdConditionDependencies)
+		pcdConditionDependencies->bDialogState = true;
+}
+
+// M: records that the condition being evaluated (if any) reads a concept 
+//    (a top-level one)
+void CDialogAgent::RecordConceptDependency(CConcept* pConcept)
+{
+	if (!pcdConditionDependencies || (pConcept == &NULLConcept))
+		return;
+	vector<pair<CConcept*, int> >& rvpciConcepts = 
+		pcdConditionDependencies->vpciConcepts;
+	for (unsigned int i = 0; i < rvpciConcepts.size(); i++)
+	if (rvpciConcepts[i].first == pConcept)
+		return;
+	rvpciConcepts.push_back(make_pair(pConcept, pConcept->GetVersion()));
+}
+
+// M: records that the condition being evaluated (if any) reads the status 
+//    of an agent
+void CDialogAgent::RecordAgentDependency(CDialogAgent* pdaAgent)
+{
+	if (!pcdConditionDependencies || (pdaAgent == &NULLDialogAgent))
+		return;
+	vector<pair<CDialogAgent*, int> >& rvpdaiAgents = 
+		pcdConditionDependencies->vpdaiAgents;
+	for (unsigned int i = 0; i < rvpdaiAgents.size(); i++)
+	if (rvpdaiAgents[i].first == pdaAgent)
+		return;
+	rvpdaiAgents.push_back(make_pair(pdaAgent, pdaAgent->GetStatusVersion()));
+}
+
+// M: records that the condition being evaluated (if any) evaluated a 
+//    condition that is not cached, so it cannot be cached either
+void CDialogAgent::RecordUncacheableDependency()
+{
+	if (pcdConditionDependencies)
+		pcdConditionDependencies->bUncacheable = true;
+}
+
+//-----------------------------------------------------------------------------
+// Concept and agent handles
+//-----------------------------------------------------------------------------
+// M: default constructor (unbound handle)
+CConceptRef::CConceptRef()
+{
+	pdaAgent = NULL;
+	bCacheConcept = false;
+	pdaTarget = NULL;
+	pConcept = NULL;
+	iGeneration = -1;
+}
+
+// M: constructs a handle for the concept at sConceptPath, relative to 
+//    pdaAAgent
+CConceptRef::CConceptRef(CDialogAgent* pdaAAgent, string sConceptPath)
+{
+	pdaAgent = pdaAAgent;
+	// split the path into the agent part and the concept name
+	SplitOnLast(sConceptPath, "/", sAgentPath, sConceptName);
+	// items in structures/arrays can be deleted and recreated as the values
+	// change, and merged history concepts are created on each access, so 
+	// only the agent can be cached for those
+	bCacheConcept = (sConceptName.find('.') == string::npos) &&
+		(sConceptName.find('@') == string::npos);
+	pdaTarget = NULL;
+	pConcept = NULL;
+	iGeneration = -1;
+}
+
+// M: returns the concept, resolving the path if the handle is stale
+CConcept& CConceptRef::Get()
+{
+	if (!pdaAgent)
+	{
+		FatalError("Access through unbound concept handle " + sConceptName + ".");
+		return NULLConcept;
+	}
+
+	// check if the cached pointers are still valid
+	if (!pdaTarget || (iGeneration != CDialogAgent::GetTreeGeneration()))
+	{
+		// if not, resolve the agent part of the path
+		if (sAgentPath.empty())
+			pdaTarget = pdaAgent;
+		else
+			pdaTarget = &(pdaAgent->A(sAgentPath));
+		if (pdaTarget == &NULLDialogAgent)
+		{
+			pdaTarget = NULL;
+			return NULLConcept;
+		}
+		// then the concept, if it can be cached
+		pConcept = NULL;
+		if (bCacheConcept)
+		{
+			pConcept = &(pdaTarget->LocalC(sConceptName));
+			if (pConcept == &NULLConcept)
+			{
+				pdaTarget = NULL;
+				pConcept = NULL;
+				return NULLConcept;
+			}
+		}
+		iGeneration = CDialogAgent::GetTreeGeneration();
+	}
+
+	if (pConcept)
+	{
+		CDialogAgent::RecordConceptDependency(pConcept);
+		return *pConcept;
+	}
+	else
+		return pdaTarget->LocalC(sConceptName);
+}
+
+// M: member access through the handle
+CConcept* CConceptRef::operator ->()
+{
+	return &Get();
+}
+
+// M: default constructor (unbound handle)
+CAgentRef::CAgentRef()
+{
+	pdaAgent = NULL;
+	pdaTarget = NULL;
+	iGeneration = -1;
+}
+
+// M: constructs a handle for the agent at sAAgentPath, relative to pdaAAgent
+CAgentRef::CAgentRef(CDialogAgent* pdaAAgent, string sAAgentPath)
+{
+	pdaAgent = pdaAAgent;
+	sAgentPath = sAAgentPath;
+	pdaTarget = NULL;
+	iGeneration = -1;
+}
+
+// M: returns the agent, resolving the path if the handle is stale
+CDialogAgent& CAgentRef::Get()
+{
+	if (!pdaAgent)
+	{
+		FatalError("Access through unbound agent handle " + sAgentPath + ".");
+		return NULLDialogAgent;
+	}
+
+	if (!pdaTarget || (iGeneration != CDialogAgent::GetTreeGeneration()))
+	{
+		pdaTarget = &(pdaAgent->LookupA(sAgentPath));
+		if (pdaTarget == &NULLDialogAgent)
+		{
+			pdaTarget = NULL;
+			return NULLDialogAgent;
+		}
+		iGeneration = CDialogAgent::GetTreeGeneration();
+	}
+	return *pdaTarget;
+}
+
+// M: member access through the handle
+CDialogAgent* CAgentRef::operator ->()
+{
+	return &Get();
 }
 
 //-----------------------------------------------------------------------------
@@ -1331,6 +1615,29 @@ void CDialogAgent::AddSubAgent(CDialogAgent* pdaWho, CDialogAgent* pdaWhere, TAd
 	pdaWho->Register();
 }
 
+// M: adds a set of subagents as the last children, in one pass: the 
+//    subagents vector grows once, and the tree labels and the relative 
+//    paths resolution are invalidated once for the whole set
+void CDialogAgent::AddSubAgents(TAgentsVector& rvpdaWho)
+{
+	SubAgents.reserve(SubAgents.size() + rvpdaWho.size());
+	SubAgents.insert(SubAgents.end(), rvpdaWho.begin(), rvpdaWho.end());
+	for (unsigned int i = 0; i < rvpdaWho.size(); i++)
+	{
+		// set the parent (directly, the tree is invalidated below)
+		rvpdaWho[i]->pdaParent = this;
+		rvpdaWho[i]->UpdateName();
+		// set it to dynamic
+		rvpdaWho[i]->SetDynamicAgent();
+		// and register it
+		rvpdaWho[i]->Register();
+	}
+	// the shape of the tree changed
+	if (pDTTManager)
+		pDTTManager->InvalidateDialogTreeLabels();
+	IncrementTreeGeneration();
+}
+
 // D: deletes a subagent
 // ɾӽڵ
 void CDialogAgent::DeleteSubAgent(CDialogAgent* pdaWho)
@@ -1392,6 +1699,11 @@ void CDialogAgent::SetParent(CDialogAgent* pdaAParent)
 	pdaParent = pdaAParent;
 	// and update the name of the agent
 	UpdateName();
+	// the shape of the tree changed, so the labels need to be recomputed
+	if (pDTTManager)
+		pDTTManager->InvalidateDialogTreeLabels();
+	// and so can the resolution of relative paths
+	IncrementTreeGeneration();
 }
 
 // D: return the parent
@@ -1400,6 +1712,30 @@ CDialogAgent* CDialogAgent::GetParent()
 	return pdaParent;
 }
 
+// M: assigns pre-order and post-order labels to the agent and to all its
+//    subagents, starting from iNextLabel; returns the next free label. An 
+//    agent A is an ancestor of B iff A.pre < B.pre and B.post < A.post
+int CDialogAgent::AssignTreeLabels(int iNextLabel)
+{
+	iPreOrderLabel = iNextLabel++;
+	for (unsigned int i = 0; i < SubAgents.size(); i++)
+		iNextLabel = SubAgents[i]->AssignTreeLabels(iNextLabel);
+	iPostOrderLabel = iNextLabel++;
+	return iNextLabel;
+}
+
+// M: returns the pre-order label
+int CDialogAgent::GetPreOrderLabel()
+{
+	return iPreOrderLabel;
+}
+
+// M: returns the post-order label
+int CDialogAgent::GetPostOrderLabel()
+{
+	return iPostOrderLabel;
+}
+
 // D: updates the name of the agent, by looking up the parent and concatenating
 //    names as /name/name/name. Also calls UpdateName for the children, since 
 //    their names need to be updated in this case, too
@@ -1433,6 +1769,8 @@ void CDialogAgent::SetContextAgent(CDialogAgent* pdaAContextAgent)
 {
 	// set the new context agent
 	pdaContextAgent = pdaAContextAgent;
+	// concepts are looked up through the context agent
+	IncrementTreeGeneration();
 }
 
 // D: return the context agent
@@ -1489,6 +1827,7 @@ bool CDialogAgent::HasCompleted()//
 // D: set the agent completion status
 void CDialogAgent::SetCompleted(TCompletionType ctACompletionType)
 {
+	journalStatus();
 	bCompleted = true;
 	ctCompletionType = ctACompletionType;
 }
@@ -1496,6 +1835,7 @@ void CDialogAgent::SetCompleted(TCompletionType ctACompletionType)
 // D: resets the agent completion status
 void CDialogAgent::ResetCompleted()
 {
+	journalStatus();
 	bCompleted = false;
 	ctCompletionType = ctFailed;
 }
@@ -1557,6 +1897,7 @@ bool CDialogAgent::IsBlocked()
 void CDialogAgent::Block()
 {
 	// set blocked to true
+	journalStatus();
 	bBlocked = true;
 	// and call recursively for all the subagents
 	for (unsigned int i = 0; i < SubAgents.size(); i++)
@@ -1567,6 +1908,7 @@ void CDialogAgent::Block()
 void CDialogAgent::UnBlock()
 {
 	// set blocked to false
+	journalStatus();
 	bBlocked = false;
 	// and call recursively for all the subagents
 	for (unsigned int i = 0; i < SubAgents.size(); i++)
@@ -1599,6 +1941,8 @@ void CDialogAgent::SetDynamicAgentID(string sADynamicAgentID)
 	bDynamicAgent = true;
 	// set the dynamic agent ID
 	sDynamicAgentID = sADynamicAgentID;
+	// paths containing # now resolve differently
+	IncrementTreeGeneration();
 	// and set it for its subagents, too
 	for (unsigned int i = 0; i < SubAgents.size(); i++)
 		SubAgents[i]->SetDynamicAgentID(sDynamicAgentID);
@@ -1617,6 +1961,7 @@ string CDialogAgent::GetDynamicAgentID()
 // ִд
 void CDialogAgent::IncrementExecuteCounter()
 {
+	journalStatus();
 	iExecuteCounter++;//ִм
 }
 
@@ -1648,6 +1993,7 @@ bool CDialogAgent::WasReOpened()
 // DfocusȦ
 void CDialogAgent::IncrementTurnsInFocusCounter()
 {
+	journalStatus();
 	iTurnsInFocusCounter++;
 }
 
@@ -1664,6 +2010,7 @@ int CDialogAgent::GetTurnsInFocusCounter()
 void CDialogAgent::SetLastInputIndex(int iInputIndex)
 {
 	iLastInputIndex = iInputIndex;
+	iStatusVersion++;
 }
 
 // D: obtain a pointer to the last input index
@@ -1680,6 +2027,7 @@ int CDialogAgent::GetLastInputIndex()
 void CDialogAgent::SetLastExecutionIndex(int iExecutionIndex)
 {
 	iLastExecutionIndex = iExecutionIndex;
+	iStatusVersion++;
 }
 
 // D: obtain a pointer to the last execution index
@@ -1696,6 +2044,7 @@ int CDialogAgent::GetLastExecutionIndex()
 void CDialogAgent::SetLastBindingsIndex(int iBindingsIndex)
 {
 	iLastBindingsIndex = iBindingsIndex;//TBindingHistory bhBindingHistory;     // the binding history	//ʷ
+	iStatusVersion++;
 }
 
 // D: get the last bindings index 
@@ -1704,6 +2053,201 @@ int CDialogAgent::GetLastBindingsIndex()
 	return iLastBindingsIndex;
 }
 
+//-----------------------------------------------------------------------------
+// Access to the agent status (used by the dialog state journal)
+//-----------------------------------------------------------------------------
+// M: returns the completion and blocking flags and the counters
+TDialogAgentStatus CDialogAgent::GetStatus()
+{
+	TDialogAgentStatus dasStatus;
+	dasStatus.bCompleted = bCompleted;
+	dasStatus.ctCompletionType = ctCompletionType;
+	dasStatus.bBlocked = bBlocked;
+	dasStatus.iExecuteCounter = iExecuteCounter;
+	dasStatus.iResetCounter = iResetCounter;
+	dasStatus.iReOpenCounter = iReOpenCounter;
+	dasStatus.iTurnsInFocusCounter = iTurnsInFocusCounter;
+	return dasStatus;
+}
+
+// M: sets the completion and blocking flags and the counters (this does not
+//    propagate to the subagents; the journal records each agent separately)
+void CDialogAgent::SetStatus(TDialogAgentStatus dasAStatus)
+{
+	bCompleted = dasAStatus.bCompleted;
+	ctCompletionType = dasAStatus.ctCompletionType;
+	bBlocked = dasAStatus.bBlocked;
+	iExecuteCounter = dasAStatus.iExecuteCounter;
+	iResetCounter = dasAStatus.iResetCounter;
+	iReOpenCounter = dasAStatus.iReOpenCounter;
+	iTurnsInFocusCounter = dasAStatus.iTurnsInFocusCounter;
+	iStatusVersion++;
+}
+
+// M: returns the agent status version
+int CDialogAgent::GetStatusVersion()
+{
+	return iStatusVersion;
+}
+
+// M: accounts the memory held by the agent, its concepts and grounding 
+//    model, and (recursively) by its subagents
+void CDialogAgent::AccountMemoryUsage(TMemoryAccount& rmaAccount)
+{
+	int iBytes = sizeof(CDialogAgent) + StringHeapBytes(sName) +
+		StringHeapBytes(sType) + StringHeapBytes(sDialogAgentName) +
+		StringHeapBytes(sDynamicAgentID) +
+		StringHeapBytes(sTriggeredByCommands) +
+		StringHeapBytes(sTriggerCommandsGroundingModelSpec) +
+		S2SHeapBytes(s2sConfiguration) +
+		S2SHeapBytes(s2sInputLineConfiguration) +
+		(int)(Concepts.capacity() * sizeof(CConcept*)) +
+		(int)(SubAgents.capacity() * sizeof(CDialogAgent*));
+	// the dependencies recorded for the cached conditions
+	for (int i = 0; i < acNumConditions; i++)
+		iBytes += (int)(
+		ccConditionCache[i].cdDependencies.vpciConcepts.capacity() *
+		sizeof(pair<CConcept*, int>) +
+		ccConditionCache[i].cdDependencies.vpdaiAgents.capacity() *
+		sizeof(pair<CDialogAgent*, int>));
+	AccountMemory(rmaAccount, MA_DIALOG_AGENTS, 1, iBytes);
+
+	for (unsigned int i = 0; i < Concepts.size(); i++)
+		Concepts[i]->AccountMemoryUsage(rmaAccount);
+	if (pGroundingModel)
+		pGroundingModel->AccountMemoryUsage(rmaAccount);
+	for (unsigned int i = 0; i < SubAgents.size(); i++)
+		SubAgents[i]->AccountMemoryUsage(rmaAccount);
+}
+
+// M: records the agent status in the dialog state journal, before it gets
+//    changed
+void CDialogAgent::journalStatus()
+{
+	// the status is about to change
+	iStatusVersion++;
+	if (pDMCore)
+		pDMCore->JournalAgentChange(this);
+}
+
+//-----------------------------------------------------------------------------
+// 
+// Protected methods implementing the condition cache
+//
+//-----------------------------------------------------------------------------
+
+// M: looks up the cached value of a condition. The value is valid as long as
+//    the dialog tree, and the concepts, agents and dialog state that the
+//    condition read when it was evaluated have not changed
+bool CDialogAgent::lookupConditionCache(TAgentCondition acCondition, 
+	bool& rbValue)
+{
+	TConditionCache& rccCache = ccConditionCache[acCondition];
+	if (!rccCache.bValid)
+		return false;
+
+	// check the dependencies (the tree first, since the concepts and agents
+	// might have been destroyed if it changed)
+	TConditionDependencies& rcdDependencies = rccCache.cdDependencies;
+	if ((rcdDependencies.iTreeGeneration != iTreeGeneration) ||
+		(rcdDependencies.bDialogState && 
+		(rcdDependencies.iDialogStateGeneration != iDialogStateGeneration)))
+	{
+		rccCache.bValid = false;
+		return false;
+	}
+	for (unsigned int i = 0; i < rcdDependencies.vpdaiAgents.size(); i++)
+	if (rcdDependencies.vpdaiAgents[i].first->GetStatusVersion() != 
+		rcdDependencies.vpdaiAgents[i].second)
+	{
+		rccCache.bValid = false;
+		return false;
+	}
+	for (unsigned int i = 0; i < rcdDependencies.vpciConcepts.size(); i++)
+	if (rcdDependencies.vpciConcepts[i].first->GetVersion() != 
+		rcdDependencies.vpciConcepts[i].second)
+	{
+		rccCache.bValid = false;
+		return false;
+	}
+
+	// the value can be reused; a condition evaluated around this one
+	// depends on the same state
+	if (pcdConditionDependencies)
+		mergeConditionDependencies(*pcdConditionDependencies, 
+		rcdDependencies);
+	rbValue = rccCache.bValue;
+	return true;
+}
+
+// M: starts recording the dependencies of a condition; returns the 
+//    dependencies of the condition being evaluated around this one (if any)
+TConditionDependencies* CDialogAgent::beginConditionEvaluation(
+	TAgentCondition acCondition)
+{
+	TConditionDependencies* pcdOuterDependencies = pcdConditionDependencies;
+	TConditionDependencies& rcdDependencies = 
+		ccConditionCache[acCondition].cdDependencies;
+	ccConditionCache[acCondition].bValid = false;
+	rcdDependencies.vpciConcepts.clear();
+	rcdDependencies.vpdaiAgents.clear();
+	rcdDependencies.bDialogState = false;
+	rcdDependencies.iDialogStateGeneration = iDialogStateGeneration;
+	rcdDependencies.iTreeGeneration = iTreeGeneration;
+	rcdDependencies.bUncacheable = !CachesConditions();
+	pcdConditionDependencies = &rcdDependencies;
+	// the condition depends on the agent's own status (e.g. the execute
+	// counter) in any case
+	RecordAgentDependency(this);
+	return pcdOuterDependencies;
+}
+
+// M: stops recording the dependencies of a condition and caches its value. 
+//    The value is not cached if the tree changed while the condition was 
+//    evaluated
+bool CDialogAgent::endConditionEvaluation(TAgentCondition acCondition, 
+	bool bValue, TConditionDependencies* pcdOuterDependencies)
+{
+	TConditionCache& rccCache = ccConditionCache[acCondition];
+	pcdConditionDependencies = pcdOuterDependencies;
+	rccCache.bValue = bValue;
+	rccCache.bValid = !rccCache.cdDependencies.bUncacheable &&
+		(rccCache.cdDependencies.iTreeGeneration == iTreeGeneration);
+	if (pcdConditionDependencies)
+		mergeConditionDependencies(*pcdConditionDependencies, 
+		rccCache.cdDependencies);
+	return bValue;
+}
+
+// M: adds the dependencies of a condition to the ones of another
+void CDialogAgent::mergeConditionDependencies(TConditionDependencies& rcdTo,
+	TConditionDependencies& rcdFrom)
+{
+	for (unsigned int i = 0; i < rcdFrom.vpciConcepts.size(); i++)
+	{
+		unsigned int j = 0;
+		while ((j < rcdTo.vpciConcepts.size()) &&
+			(rcdTo.vpciConcepts[j].first != rcdFrom.vpciConcepts[i].first))
+			j++;
+		if (j == rcdTo.vpciConcepts.size())
+			rcdTo.vpciConcepts.push_back(rcdFrom.vpciConcepts[i]);
+	}
+	for (unsigned int i = 0; i < rcdFrom.vpdaiAgents.size(); i++)
+	{
+		unsigned int j = 0;
+		while ((j < rcdTo.vpdaiAgents.size()) &&
+			(rcdTo.vpdaiAgents[j].first != rcdFrom.vpdaiAgents[i].first))
+			j++;
+		if (j == rcdTo.vpdaiAgents.size())
+			rcdTo.vpdaiAgents.push_back(rcdFrom.vpdaiAgents[i]);
+	}
+	if (rcdFrom.bDialogState)
+		rcdTo.bDialogState = true;
+	if (rcdFrom.bUncacheable || 
+		(rcdFrom.iTreeGeneration != rcdTo.iTreeGeneration))
+		rcdTo.bUncacheable = true;
+}
+
 //-----------------------------------------------------------------------------
 // 
 // Protected methods for parsing various declarative constructs
@@ -1820,7 +2364,7 @@ void CDialogAgent::parseGrammarMapping(string sConceptNames,
 		{
 			//		if a simple concept mapping, then we declare it only if it's under the main topic (disable it otherwise)
 			// <4>	һ򵥵ĸӳ䣬ôֻͬ¿ã
-			ceExpectation.bDisabled = !pDTTManager->IsAncestorOrEqualOf( pDMCore->GetCurrentMainTopicAgent()->GetName(), sName);
+			ceExpectation.bDisabled = !pDTTManager->IsAncestorOrEqualOf(pDMCore->GetCurrentMainTopicAgent(), this);
 			if (ceExpectation.bDisabled)
 			{
 				ceExpectation.sReasonDisabled = "[] not under topic";//ͬ
@@ -1863,7 +2407,6 @@ void CDialogAgent::parseGrammarMapping(string sConceptNames,
 				CDialogAgent* pdaDTSAgentInFocus = pDMCore->GetDTSAgentInFocus();
 				if (!pdaDTSAgentInFocus)
 					FatalError("Could not find a DTS agent in focus.");
-				string sFocusedAgentName = pdaDTSAgentInFocus->GetName();
 
 				//		go through the agents in the list and figure out if they contain the focus
 				// <9>	ͨбеĴȷǷ
@@ -1871,7 +2414,7 @@ void CDialogAgent::parseGrammarMapping(string sConceptNames,
 				for (unsigned int i = 0; i < vsAgents.size(); i++)
 				{
 					// <10>	(vsAgents[i])sFocusedAgentNameȻȣ򷵻true   => 
-					if (pDTTManager->IsAncestorOrEqualOf(A(vsAgents[i]).GetName(), sFocusedAgentName))
+					if (pDTTManager->IsAncestorOrEqualOf(&A(vsAgents[i]), pdaDTSAgentInFocus))
 					{
 						ceExpectation.bDisabled = false;//
 						break;
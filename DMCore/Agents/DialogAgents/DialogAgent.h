@@ -52,6 +52,20 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added LookupC
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): the agent conditions (PRECONDITION, SUCCEEDS_WHEN,
+//                            FAILS_WHEN, EXPECT_WHEN, TRIGGERED_BY) of the
+//                            agents declaring CACHES_CONDITIONS are cached
+//                            until the state they read changes
+//   [2026-10-19] (mbrenner): added AddSubAgents(), for mounting a set of 
+//                            sibling agents in one pass
+//   [2026-10-19] (mbrenner): added CConceptRef and CAgentRef handles; C() and
+//                            A() now go through per-agent handle caches
+//   [2026-10-19] (mbrenner): added pre/post-order dialog tree labels, used
+//                            by the DTT manager for fast ancestry checks
+//   [2026-10-19] (mbrenner): added GetStatus/SetStatus and status journaling
+//                            for dialog state rollbacks
 //   [2005-10-22] (antoine): Added methods RequiresFloor and 
 //							 IsConversationSynchronous to regulate turn-taking
 //                           and asynchronous agent planning/execution
@@ -222,6 +236,56 @@ typedef enum
 	ctFailed,            // completion by failure
 } TCompletionType;
 
+// M: structure holding the completion and blocking flags and the counters
+//    of a dialog agent (this is what the dialog state journal records about
+//    an agent, so that it can be rolled back)
+typedef struct
+{
+	bool bCompleted;				// the completed flag
+	TCompletionType ctCompletionType;// how the agent completed
+	bool bBlocked;					// the blocked flag
+	int iExecuteCounter;			// the execute counter
+	int iResetCounter;				// the reset counter
+	int iReOpenCounter;				// the reopen counter
+	int iTurnsInFocusCounter;		// the turns in focus counter
+} TDialogAgentStatus;
+
+// M: the agent conditions that are cached (see the PRECONDITION, 
+//    SUCCEEDS_WHEN, FAILS_WHEN, EXPECT_WHEN and TRIGGERED_BY macros)
+typedef enum
+{
+	acPrecondition,			// PreconditionsSatisfied
+	acSuccessCriteria,		// SuccessCriteriaSatisfied
+	acFailureCriteria,		// FailureCriteriaSatisfied
+	acExpectCondition,		// ExpectCondition
+	acClaimsFocus,			// ClaimsFocus
+	acNumConditions,
+} TAgentCondition;
+
+// M: the state a condition read while it was evaluated: the concepts (the 
+//    top-level ones, whose versions change when any of their items or 
+//    elements change) and the agents it accessed, with their versions, and 
+//    whether it read the dialog state (the execution stack, the turn, the 
+//    bindings, etc)
+typedef struct
+{
+	vector<pair<CConcept*, int> > vpciConcepts;
+	vector<pair<CDialogAgent*, int> > vpdaiAgents;
+	bool bDialogState;				// the dialog state was read
+	int iDialogStateGeneration;		// the dialog state generation
+	int iTreeGeneration;			// the dialog tree generation
+	bool bUncacheable;				// a condition that is not cached was 
+									//  evaluated
+} TConditionDependencies;
+
+// M: a cached condition value, together with the state it depends on
+typedef struct
+{
+	bool bValid;
+	bool bValue;
+	TConditionDependencies cdDependencies;
+} TConditionCache;
+
 //-----------------------------------------------------------------------------
 // D: Defines for binding policies
 //-----------------------------------------------------------------------------
@@ -236,6 +300,62 @@ typedef enum
 #define MIXED_INITIATIVE "bind-anything"
 
 
+//-----------------------------------------------------------------------------
+// M: Handles for concepts and agents accessed through relative paths. A 
+//    handle resolves the path once and keeps the resulting pointer for as 
+//    long as the dialog tree generation (see CDialogAgent::GetTreeGeneration)
+//    does not change; when stale, it falls back on the path lookup
+//-----------------------------------------------------------------------------
+
+// M: handle to a concept, relative to a dialog agent
+class CConceptRef
+{
+private:
+	CDialogAgent* pdaAgent;			// the agent the path is relative to
+	string sAgentPath;				// the agent part of the path (if any)
+	string sConceptName;			// the concept part of the path
+	bool bCacheConcept;				// indicates if the concept itself can be
+									//  cached (not for items in structures
+									//  and arrays, or merged history concepts)
+	CDialogAgent* pdaTarget;		// the agent the concept is looked up from
+	CConcept* pConcept;				// the concept, if cached
+	int iGeneration;				// the tree generation the pointers were 
+									//  resolved in
+
+public:
+	CConceptRef();
+	CConceptRef(CDialogAgent* pdaAAgent, string sConceptPath);
+
+	// Access to the concept
+	CConcept& Get();
+	CConcept* operator ->();
+};
+
+// M: handle to a dialog agent, relative to another dialog agent
+class CAgentRef
+{
+private:
+	CDialogAgent* pdaAgent;			// the agent the path is relative to
+	string sAgentPath;				// the agent path
+	CDialogAgent* pdaTarget;		// the agent, once resolved
+	int iGeneration;				// the tree generation pdaTarget was 
+									//  resolved in
+
+public:
+	CAgentRef();
+	CAgentRef(CDialogAgent* pdaAAgent, string sAAgentPath);
+
+	// Access to the agent
+	CDialogAgent& Get();
+	CDialogAgent* operator ->();
+};
+
+// M: maps holding the handles for the paths accessed through C() and A()
+typedef map<string, CConceptRef, less<string>,
+	allocator<CConceptRef> > TConceptRefsMap;
+typedef map<string, CAgentRef, less<string>,
+	allocator<CAgentRef> > TAgentRefsMap;
+
 //-----------------------------------------------------------------------------
 //
 // The CDialogAgent Class 
@@ -313,6 +433,11 @@ protected:
 	// a dynamic id for the agent (for dynamically generated agents)
 	string sDynamicAgentID;
 
+	// the pre-order and post-order labels of the agent in the dialog task 
+	// tree (assigned by the DTT manager; -1 if the agent was not labeled)
+	int iPreOrderLabel;
+	int iPostOrderLabel;
+
 	// holds the grammar mapping for the commands that trigger then agent
 	//津﷨ӳ
 	string sTriggeredByCommands;
@@ -361,6 +486,32 @@ protected:
 	// ʾǷѱ̳
 	bool bInheritedParentInputConfiguration;//#define INPUT_LINE_CONFIGURATION(CONFIG_LINE)
 
+	// handles for the concepts and agents accessed through C() and A(), 
+	// indexed by their path relative to this agent (the paths formatted by
+	// the printf-like versions are not kept, so the maps only hold the 
+	// paths that appear in the code)
+	TConceptRefsMap s2crConceptRefs;
+	TAgentRefsMap s2arAgentRefs;
+
+	// the dialog tree generation: incremented whenever a change in the tree 
+	// can make a resolved concept or agent handle stale
+	static int iTreeGeneration;
+
+	// the agent status version: incremented whenever the agent status 
+	// (completion and blocking flags, counters) changes
+	int iStatusVersion;
+
+	// the cached values of the agent conditions
+	TConditionCache ccConditionCache[acNumConditions];
+
+	// the dialog state generation: incremented by the dialog manager core 
+	// whenever the execution stack, the turn or the bindings change
+	static int iDialogStateGeneration;
+
+	// the dependencies of the condition currently being evaluated (NULL 
+	// if no condition is being evaluated)
+	static TConditionDependencies* pcdConditionDependencies;
+
 public:
 
 	//---------------------------------------------------------------------
@@ -475,6 +626,10 @@ public:
 	// while grounding is in progress
 	virtual bool ClaimsFocusDuringGrounding();
 
+	// Virtual function which indicates if the values of the agent 
+	// conditions can be cached (see CACHES_CONDITIONS)
+	virtual bool CachesConditions();
+
 	// Virtual function indicating if this agent is to be triggered by
 	// a command from the user. The function returns as a string the
 	// grammar concept(s) corresponding to that user command
@@ -605,10 +760,30 @@ public:
 	CDialogAgent& A(string sDialogAgentPath);
 	CDialogAgent& A(const char* lpszDialogAgentPath, ...);
 
+	// Path lookup for agents and concepts (bypasses the handles)
+	//
+	CDialogAgent& LookupA(string sDialogAgentPath);
+	CConcept& LookupC(string sConceptPath);
+
+	// Access to the dialog tree generation
+	//
+	static int GetTreeGeneration();
+	static void IncrementTreeGeneration();
+
+	// Access to the dialog state generation, and recording of the 
+	// dependencies of the condition being evaluated
+	//
+	static void IncrementDialogStateGeneration();
+	static void RecordDialogStateDependency();
+	static void RecordConceptDependency(CConcept* pConcept);
+	static void RecordAgentDependency(CDialogAgent* pdaAgent);
+	static void RecordUncacheableDependency();
+
 	// Methods for adding and deleting subagents
 	//
 	void AddSubAgent(CDialogAgent* pdaWho, CDialogAgent* pdaWhere,
 		TAddSubAgentMethod asamMethod);
+	void AddSubAgents(TAgentsVector& rvpdaWho);
 	void DeleteSubAgent(CDialogAgent* pdaWho);
 	void DeleteDynamicSubAgents();
 
@@ -618,6 +793,12 @@ public:
 	CDialogAgent* GetParent();
 	void UpdateName();
 
+	// Access to the dialog task tree labels
+	//
+	int AssignTreeLabels(int iNextLabel);
+	int GetPreOrderLabel();
+	int GetPostOrderLabel();
+
 	// Access to context dialog agent information
 	//
 	void SetContextAgent(CDialogAgent* pdaAContextAgent);
@@ -683,6 +864,18 @@ public:
 	void SetLastBindingsIndex(int iBindingsIndex);
 	int GetLastBindingsIndex();
 
+	// Access to the agent status (completion and blocking flags, counters), 
+	// used by the dialog state journal
+	//
+	TDialogAgentStatus GetStatus();
+	void SetStatus(TDialogAgentStatus dasAStatus);
+	int GetStatusVersion();
+
+	// Accounts the memory held by the agent, its concepts and grounding 
+	// model, and (recursively) by its subagents
+	//
+	virtual void AccountMemoryUsage(TMemoryAccount& rmaAccount);
+
 	// J: Access to s2sInputLineConfiguration
 	// TODO: Merge this code with the same-named functions in Agent.[cpp|h]
 	// Begin copy
@@ -717,6 +910,20 @@ protected:
 	// grammar mapping 淶expectationб
 	void parseGrammarMapping(string sConceptNames, string sGrammarMapping,
 		TConceptExpectationList& rcelExpectationList);
+
+	// Records the agent status in the dialog state journal, before it
+	// gets changed
+	void journalStatus();
+
+	// Methods implementing the condition cache (used by the condition 
+	// macros)
+	bool lookupConditionCache(TAgentCondition acCondition, bool& rbValue);
+	TConditionDependencies* beginConditionEvaluation(
+		TAgentCondition acCondition);
+	bool endConditionEvaluation(TAgentCondition acCondition, bool bValue,
+		TConditionDependencies* pcdOuterDependencies);
+	static void mergeConditionDependencies(TConditionDependencies& rcdTo,
+		TConditionDependencies& rcdFrom);
 };
 
 // NULL dialog agent: this object is used designate invalid dialog agent
@@ -731,6 +938,22 @@ extern CDialogAgent NULLDialogAgent;
 //
 //-----------------------------------------------------------------------------
 
+// M: macro for evaluating a condition through the condition cache (the 
+//    value is reused until the state the condition read changes)
+#define CACHED_CONDITION(acCondition, Condition)\
+	if (!CachesConditions()) \
+	{ \
+		RecordUncacheableDependency(); \
+		return (Condition); \
+	} \
+	bool bCachedValue; \
+	if (lookupConditionCache(acCondition, bCachedValue)) \
+		return bCachedValue; \
+	TConditionDependencies* pcdOuterDependencies = \
+		beginConditionEvaluation(acCondition); \
+	return endConditionEvaluation(acCondition, (Condition), \
+		pcdOuterDependencies); \
+
 // D: macro for defining preconditions for agents
 // Dڶǰĺ
 #define PRECONDITION(Condition)\
@@ -738,13 +961,26 @@ extern CDialogAgent NULLDialogAgent;
 	virtual bool PreconditionsSatisfied()
 {
 		\
-			return (Condition); \
+			CACHED_CONDITION(acPrecondition, Condition) \
 	}\
 
 	// D: macro for defining preconditions that are the same as the triggers
 #define SAME_AS_TRIGGER \
 	ClaimsFocus()\
 
+	// M: macro which indicates that the values of the agent conditions can 
+	//    be cached (only for conditions that read nothing but concepts and 
+	//    agents obtained through C() and A(), the agent's own status and 
+	//    the dialog manager core state; not member variables, raw concept
+	//    pointers or the agents registry)
+#define CACHES_CONDITIONS \
+	public:\
+	virtual bool CachesConditions()
+{
+		\
+			return true; \
+	}\
+
 	// D: macro which indicates that the agent can claim the focus during grounding
 #define CAN_TRIGGER_DURING_GROUNDING \
 	public:\
@@ -761,7 +997,7 @@ extern CDialogAgent NULLDialogAgent;
 	virtual bool SuccessCriteriaSatisfied()
 		{
 		\
-			return (Condition); \
+			CACHED_CONDITION(acSuccessCriteria, Condition) \
 	}\
 
 	// D: macro for defining failure criteria (when an agency completes with failure)
@@ -770,7 +1006,7 @@ extern CDialogAgent NULLDialogAgent;
 	virtual bool FailureCriteriaSatisfied()
 		{
 		\
-			return (Condition); \
+			CACHED_CONDITION(acFailureCriteria, Condition) \
 	}\
 
 	// D: macro for defining the maximum number of attempts for an agent
@@ -797,7 +1033,7 @@ extern CDialogAgent NULLDialogAgent;
 	virtual bool ExpectCondition()
 		{  
 		\
-			return(Condition); \
+			CACHED_CONDITION(acExpectCondition, Condition) \
 	}; \
 
 	// D: macro for specifying code on the creation of each agent
@@ -860,7 +1096,7 @@ extern CDialogAgent NULLDialogAgent;
 	virtual bool ClaimsFocus()
 		{
 		\
-			return (Condition); \
+			CACHED_CONDITION(acClaimsFocus, Condition) \
 	}\
 
 	// D: macro for definiting the user commands which trigger this agent
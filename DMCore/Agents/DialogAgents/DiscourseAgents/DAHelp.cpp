@@ -51,6 +51,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
 //	 [2004-12-24] (antoine): added the possibility to define a DTMF key to
 //                           trigger this agent using the agent configuration
 //   [2004-04-24] (dbohus): changed agents to reopen (instead of reset) on
@@ -84,6 +87,7 @@
 // A: HelpExecutionAgency
 //    the help agent. 
 DEFINE_AGENCY(CHelpExecutionAgency,
+	CACHES_CONDITIONS
 	PRECONDITION(false)
 
 	public:
@@ -198,6 +202,7 @@ public:
 		// D: /Help
 		//    the help trigger agent. 
 		DEFINE_EXECUTE_AGENT(CHelp,
+		CACHES_CONDITIONS
 		PRECONDITION(false)
 
 	private:
@@ -273,6 +278,7 @@ public:
 			// D: /EstablishContext
 			//    establishes the context of the current topic. 
 			DEFINE_INFORM_AGENT(CHelpEstablishContext,
+			CACHES_CONDITIONS
 			PRECONDITION(false)
 			CAN_TRIGGER_DURING_GROUNDING
 			EXPECT_WHEN(pDMCore->GetDTSAgentInFocus()->EstablishContextPrompt() != "")
@@ -295,6 +301,7 @@ public:
 			// D: /HelpGetTips
 			//    provides generic tips for using the dialog system
 			DEFINE_INFORM_AGENT(CHelpGetTips,
+			CACHES_CONDITIONS
 			PRECONDITION(false)
 			DEFINE_CONCEPTS(
 			INT_SYSTEM_CONCEPT(_tips_counter))
@@ -311,6 +318,7 @@ public:
 			//    the whay can i say agent: it reacts only if the previously focused agent
 			//    has a "what can i say" prompt on it
 			DEFINE_INFORM_AGENT(CHelpWhatCanISay,
+			CACHES_CONDITIONS
 			PRECONDITION(false)
 			CAN_TRIGGER_DURING_GROUNDING
 			TRIGGERED_BY_COMMANDS("@[Help.what_can_i_say]", "")
@@ -335,6 +343,7 @@ public:
 			//    provides generic information about the capabilities of the spoken 
 			//    dialogue system
 			DEFINE_INFORM_AGENT(CHelpSystemCapabilities,
+			CACHES_CONDITIONS
 			PRECONDITION(false)
 			CAN_TRIGGER_DURING_GROUNDING
 			TRIGGERED_BY_COMMANDS("@[Help.system_capabilities]", "")
@@ -51,6 +51,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
 //	 [2003-06-25] (antoine): created the NonUnderstanding agency and its subagent
 //							 based on the NonUnderstanding code in RoomLine 
 //							(by dbohus) and the Help discourse agent.
@@ -67,6 +70,7 @@
 #include "../../../../DialogTask/DialogTask.h"
 
 DEFINE_AGENCY(CNonUnderstanding,
+	CACHES_CONDITIONS
 	PRECONDITION(false)
 	ON_CREATION(C("last_nonunderstood_turn") = -2)
 	DEFINE_CONCEPTS(
@@ -83,6 +87,7 @@ DEFINE_AGENCY(CNonUnderstanding,
 
 	// NonUnderstanding/FirstNonUnderstanding
 	DEFINE_INFORM_AGENT(CFirstNonUnderstanding,
+	CACHES_CONDITIONS
 	TRIGGERED_BY((pDMCore->LastTurnNonUnderstanding()) &&
 	((int)C("last_nonunderstood_turn") < pDMCore->GetLastInputTurnNumber() - 1));
 
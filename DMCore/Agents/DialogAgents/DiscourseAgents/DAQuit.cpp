@@ -51,6 +51,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
 //   [2004-12-30] (antoine): added the possibility to define the language
 //                           model and/or DTMF keys for confirmation
 //	 [2004-12-24] (antoine): added the possibility to define a DTMF key to
@@ -73,6 +76,7 @@
 DEFINE_AGENCY(CQuit,
 
 	CAN_TRIGGER_DURING_GROUNDING
+	CACHES_CONDITIONS
 
 	public:
 		virtual string TriggeredByCommands()
@@ -52,6 +52,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
 //	 [2004-12-24] (antoine): added the possibility to define a DTMF key to
 //                           trigger this agent using the agent configuration
 //   [2003-03-10] (dbohus): adapted so that it also informs the user that it's
@@ -77,6 +80,7 @@
 //    defines the Suspend Agency. this agency is activated on a Suspend request, 
 //    and will just block everything until it hears a resume
 DEFINE_AGENCY(CSuspend,
+	CACHES_CONDITIONS
 	PRECONDITION(false)
 	CAN_TRIGGER_DURING_GROUNDING
 	public:
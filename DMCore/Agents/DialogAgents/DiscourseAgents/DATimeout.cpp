@@ -54,6 +54,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
 //	 [2005-02-08] (antoine): added a Sleep before TT_Terminate returns so that
 //							 the system doesn't hang up before saying its last
 //							 utterance
@@ -88,6 +91,7 @@
 //    The agency handles timeouts, and suspends the execution when the user is
 //    not responding any more
 DEFINE_AGENCY(CTimeoutSuspend,
+	CACHES_CONDITIONS
 	PRECONDITION(false)
 	DEFINE_CONCEPTS(
 
@@ -104,6 +108,7 @@ DEFINE_AGENCY(CTimeoutSuspend,
 	//    Handles the first aparition of a timeout by issuing the timeout prompt'
 	//    of the previously focused agent
 	DEFINE_EXECUTE_AGENT(CTS_HandleFirstTimeout,
+	CACHES_CONDITIONS
 	EXPECT_WHEN(pDMCore->GetLastInputTurnNumber() >	(int)C("LastTimeoutTurnNumber"))
 	CAN_TRIGGER_DURING_GROUNDING
 	TRIGGERED_BY_COMMANDS("@"TIMEOUT_ELAPSED, "none")
@@ -136,6 +141,7 @@ DEFINE_AGENCY(CTimeoutSuspend,
 //    channel reestablishment dialog, and eventually suspend execution if
 //    the user is not there
 DEFINE_AGENCY(CTS_ReestablishChannel,
+CACHES_CONDITIONS
 EXPECT_WHEN(pDMCore->GetLastInputTurnNumber() ==
 (int)C("LastTimeoutTurnNumber"))
 CAN_TRIGGER_DURING_GROUNDING
@@ -172,6 +178,7 @@ GRAMMAR_MAPPING("[Yes]>true")
 // D: /TimeoutSuspend/TS_ReestablishChannel/TS_SuspendOnTimeout
 //    Suspends execution on the third successive timeout
 DEFINE_AGENCY(CTS_SuspendOnTimeout,
+CACHES_CONDITIONS
 PRECONDITION(false)
 CAN_TRIGGER_DURING_GROUNDING
 CONCEPT_BINDING_POLICY(WITHIN_TOPIC_ONLY)
@@ -229,6 +236,7 @@ void RegisterTimeoutSuspendAgency()
 // D: /TimeoutTerminate
 DEFINE_AGENCY(CTimeoutTerminate,
 	IS_NOT_DTS_AGENT()
+	CACHES_CONDITIONS
 
 	PRECONDITION(false)
 	DEFINE_CONCEPTS(
@@ -246,6 +254,7 @@ DEFINE_AGENCY(CTimeoutTerminate,
 	//    of the previously focused agent
 	DEFINE_EXECUTE_AGENT(CTT_HandleFirstTimeout,
 	IS_NOT_DTS_AGENT()
+	CACHES_CONDITIONS
 
 	EXPECT_WHEN(pDMCore->GetLastInputTurnNumber() >
 	(int)C("LastTimeoutTurnNumber"))
@@ -280,6 +289,7 @@ DEFINE_AGENCY(CTimeoutTerminate,
 //    the user is not there
 DEFINE_AGENCY(CTT_ReestablishChannel,
 IS_NOT_DTS_AGENT()
+CACHES_CONDITIONS
 
 EXPECT_WHEN(iExecuteCounter == 0)
 TRIGGERED_BY_COMMANDS("@"TIMEOUT_ELAPSED, "none")
@@ -322,6 +332,7 @@ GRAMMAR_MAPPING("[Yes]>true")
 //    Terminates execution on the third successive timeout
 DEFINE_AGENCY(CTT_TerminateOnTimeout,
 IS_NOT_DTS_AGENT()
+CACHES_CONDITIONS
 
 PRECONDITION(false)
 CONCEPT_BINDING_POLICY(WITHIN_TOPIC_ONLY)
@@ -53,6 +53,12 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the handles and the interned names of 
+//                            unregistered agents are reused
+//   [2026-10-19] (mbrenner): replaced the std::map based agents and agent
+//                            types hashes with open-addressing tables over
+//                            interned names; added agent handles and lookup
+//                            by (parent handle, child name)
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
 //   [2001-12-30] (dbohus): started working on this
 // 
@@ -71,7 +77,8 @@ CRegistry AgentsRegistry;
 // D: Constructor
 CRegistry::CRegistry()
 {
-	// nothing here
+	viAgentsByParent.assign(16, -1);
+	iAgentsByParentUsed = 0;
 }
 
 // D: Initializes the registry, empties everything
@@ -83,18 +90,30 @@ void CRegistry::Clear()
 	// go through the agents hash and deallocate the remaining registered agents
 	//ͨagent hash ͷʣעagent
 	Log(REGISTRY_STREAM, "Deallocating remaining registered agents ...");
-	while (!AgentsHash.empty())
+	for (unsigned int ah = 0; ah < vraAgents.size(); ah++)
 	{
-		// deallocate the agents
-		// ͷagentڴ <agentName,  *agent>
-		delete AgentsHash.begin()->second;  // ??ֻͷһ ⣡  
+		// deallocate the agents (this also unregisters them, and their
+		// subagents)
+		CAgent* pAgent = vraAgents[ah].pAgent;
+		if (pAgent)
+		{
+			delete pAgent;
+			vraAgents[ah].pAgent = NULL;
+		}
 	}
 	Log(REGISTRY_STREAM, "Deallocating remaining registered agents completed.");
 
 	// clear the hashes
 	//hash
-	AgentsHash.clear(); //agent
-	AgentsTypeHash.clear(); //agentĹ캯
+	stAgentNames.Clear();
+	vraAgents.clear();
+	viFreeAgentHandles.clear();
+	viAgentsByName.clear();
+	viAgentsByParent.assign(16, -1);
+	iAgentsByParentUsed = 0;
+	// and the agent types
+	stAgentTypeNames.Clear(); //agent
+	vfcaAgentTypes.clear(); //agentĹ캯
 }
 
 //-----------------------------------------------------------------------------
@@ -107,12 +126,12 @@ void CRegistry::Clear()
 // agent NameǷѾע
 bool CRegistry::IsRegisteredAgent(string sAgentName)
 {
-	return (AgentsHash.find(sAgentName) != AgentsHash.end());
+	return (GetAgentHandle(sAgentName) != NULL_AGENT_HANDLE);
 }
 
 // D: register an agent into the registry.
 //עעagent
-void CRegistry::RegisterAgent(string sAgentName, CAgent* pAgent)
+TAgentHandle CRegistry::RegisterAgent(string sAgentName, CAgent* pAgent)
 {
 	// check that there's no agent already registered under the same name
 	//ǷѾע agentname
@@ -123,10 +142,42 @@ void CRegistry::RegisterAgent(string sAgentName, CAgent* pAgent)
 
 	// register the agent
 	//עagent
-	AgentsHash.insert(TAgentsHash::value_type(sAgentName, pAgent));
+	TRegisteredAgent raAgent;
+	raAgent.pAgent = pAgent;
+	raAgent.iNameID = stAgentNames.Intern(sAgentName);
+	raAgent.ahParent = NULL_AGENT_HANDLE;
+	raAgent.iChildNameID = -1;
+	raAgent.iIndexedChildren = 0;
+	// if the name is a path in the tree, index it under the parent too
+	string sParentName, sChildName;
+	if (SplitOnLast(sAgentName, "/", sParentName, sChildName))
+	{
+		raAgent.ahParent = GetAgentHandle(sParentName);
+		if (raAgent.ahParent != NULL_AGENT_HANDLE)
+			raAgent.iChildNameID = stAgentNames.Intern(sChildName);
+	}
+	TAgentHandle ahAgent;
+	if (!viFreeAgentHandles.empty())
+	{
+		ahAgent = viFreeAgentHandles.back();
+		viFreeAgentHandles.pop_back();
+		vraAgents[ahAgent] = raAgent;
+	}
+	else
+	{
+		ahAgent = (TAgentHandle)vraAgents.size();
+		vraAgents.push_back(raAgent);
+	}
+	if ((int)viAgentsByName.size() < stAgentNames.GetSize())
+		viAgentsByName.resize(stAgentNames.GetSize(), NULL_AGENT_HANDLE);
+	viAgentsByName[raAgent.iNameID] = ahAgent;
+	if (raAgent.ahParent != NULL_AGENT_HANDLE)
+		insertChild(ahAgent);
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent %s registered successfully.", sAgentName.c_str());
+
+	return ahAgent;
 }
 
 // D: unregister an agent 
@@ -134,10 +185,29 @@ void CRegistry::RegisterAgent(string sAgentName, CAgent* pAgent)
 //עɾע<nane, agent>
 void CRegistry::UnRegisterAgent(string sAgentName)
 {
-	if (AgentsHash.erase(sAgentName) == 0)
+	TAgentHandle ahAgent = GetAgentHandle(sAgentName);
+	if (ahAgent == NULL_AGENT_HANDLE)
 	{
 		FatalError("Could not find agent " + sAgentName + " to unregister.");
 	}
+	else
+	{
+		TRegisteredAgent& raAgent = vraAgents[ahAgent];
+		if (raAgent.ahParent != NULL_AGENT_HANDLE)
+		{
+			removeChild(ahAgent);
+			stAgentNames.Release(raAgent.iChildNameID);
+			// the parent's handle might have been waiting on this child
+			TAgentHandle ahParent = raAgent.ahParent;
+			raAgent.ahParent = NULL_AGENT_HANDLE;
+			vraAgents[ahParent].iIndexedChildren--;
+			releaseAgentHandle(ahParent);
+		}
+		viAgentsByName[raAgent.iNameID] = NULL_AGENT_HANDLE;
+		stAgentNames.Release(raAgent.iNameID);
+		raAgent.pAgent = NULL;
+		releaseAgentHandle(ahAgent);
+	}
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent %s unregistered successfully.", sAgentName.c_str());
@@ -148,8 +218,8 @@ void CRegistry::UnRegisterAgent(string sAgentName)
 //Dָagentָ룬agentname Ҳagent򷵻NULL
 CAgent* CRegistry::operator [](string sAgentName)
 {
-	TAgentsHash::iterator iPtr;
-	if ((iPtr = AgentsHash.find(sAgentName)) == AgentsHash.end())
+	TAgentHandle ahAgent = GetAgentHandle(sAgentName);
+	if (ahAgent == NULL_AGENT_HANDLE)
 	{
 		// if the agent is not found, return NULL
 		return NULL;
@@ -158,10 +228,159 @@ CAgent* CRegistry::operator [](string sAgentName)
 	{
 		// otherwise, return the pointer to the agent
 		//agentָ
-		return iPtr->second;
+		return vraAgents[ahAgent].pAgent;
 	}
 }
 
+// M: returns the handle of an agent, given the agent's name. Returns 
+//    NULL_AGENT_HANDLE if the agent is not registered
+TAgentHandle CRegistry::GetAgentHandle(string sAgentName)
+{
+	int iNameID = stAgentNames.Find(sAgentName);
+	if ((iNameID == -1) || (iNameID >= (int)viAgentsByName.size()))
+		return NULL_AGENT_HANDLE;
+	return viAgentsByName[iNameID];
+}
+
+// M: returns the handle of the agent named sChildName under the agent 
+//    ahParent (i.e. /a/b given the handle of /a and b), without building 
+//    the full path
+TAgentHandle CRegistry::GetChildAgentHandle(TAgentHandle ahParent, string sChildName)
+{
+	if ((ahParent < 0) || (ahParent >= (int)vraAgents.size()) ||
+		!vraAgents[ahParent].pAgent)
+		return NULL_AGENT_HANDLE;
+
+	int iChildNameID = stAgentNames.Find(sChildName);
+	if (iChildNameID != -1)
+	{
+		unsigned int uiMask = (unsigned int)viAgentsByParent.size() - 1;
+		unsigned int uiSlot = hashChild(ahParent, iChildNameID) & uiMask;
+		while (viAgentsByParent[uiSlot] != -1)
+		{
+			TAgentHandle ahAgent = viAgentsByParent[uiSlot];
+			if ((ahAgent >= 0) &&
+				(vraAgents[ahAgent].ahParent == ahParent) &&
+				(vraAgents[ahAgent].iChildNameID == iChildNameID))
+				return ahAgent;
+			uiSlot = (uiSlot + 1) & uiMask;
+		}
+	}
+
+	// the child might have been registered before its parent was (in 
+	// which case it's not indexed by parent), so fall back on the full path
+	return GetAgentHandle(
+		stAgentNames.GetString(vraAgents[ahParent].iNameID) + "/" + sChildName);
+}
+
+// M: returns the handle of the agent at the relative path sRelativePath 
+//    (i.e. b/c) under the agent ahAncestor
+TAgentHandle CRegistry::GetDescendantAgentHandle(TAgentHandle ahAncestor, string sRelativePath)
+{
+	TAgentHandle ahAgent = ahAncestor;
+	unsigned int iStart = 0;
+	while (ahAgent != NULL_AGENT_HANDLE)
+	{
+		string::size_type iEnd = sRelativePath.find('/', iStart);
+		if (iEnd == string::npos)
+			return GetChildAgentHandle(ahAgent, sRelativePath.substr(iStart));
+		ahAgent = GetChildAgentHandle(ahAgent,
+			sRelativePath.substr(iStart, iEnd - iStart));
+		iStart = (unsigned int)iEnd + 1;
+	}
+	return NULL_AGENT_HANDLE;
+}
+
+// M: returns the agent for a handle, or NULL if the handle is invalid or 
+//    the agent was unregistered
+CAgent* CRegistry::GetAgent(TAgentHandle ahAgent)
+{
+	if ((ahAgent < 0) || (ahAgent >= (int)vraAgents.size()))
+		return NULL;
+	return vraAgents[ahAgent].pAgent;
+}
+
+// M: hash function for the (parent handle, child name id) table
+unsigned int CRegistry::hashChild(TAgentHandle ahParent, int iChildNameID)
+{
+	return ((unsigned int)ahParent * 2654435761u) ^
+		((unsigned int)iChildNameID * 40503u);
+}
+
+// M: inserts an agent in the (parent handle, child name id) table
+void CRegistry::insertChild(TAgentHandle ahAgent)
+{
+	// keep the load (including deleted slots) under 3/4
+	if ((unsigned int)(iAgentsByParentUsed + 1) * 4 > viAgentsByParent.size() * 3)
+		rehashChildren();
+
+	unsigned int uiMask = (unsigned int)viAgentsByParent.size() - 1;
+	unsigned int uiSlot = hashChild(vraAgents[ahAgent].ahParent,
+		vraAgents[ahAgent].iChildNameID) & uiMask;
+	while (viAgentsByParent[uiSlot] >= 0)
+		uiSlot = (uiSlot + 1) & uiMask;
+	if (viAgentsByParent[uiSlot] == -1)
+		iAgentsByParentUsed++;
+	viAgentsByParent[uiSlot] = ahAgent;
+	vraAgents[vraAgents[ahAgent].ahParent].iIndexedChildren++;
+}
+
+// M: removes an agent from the (parent handle, child name id) table, 
+//    leaving a deleted marker in its slot
+void CRegistry::removeChild(TAgentHandle ahAgent)
+{
+	unsigned int uiMask = (unsigned int)viAgentsByParent.size() - 1;
+	unsigned int uiSlot = hashChild(vraAgents[ahAgent].ahParent,
+		vraAgents[ahAgent].iChildNameID) & uiMask;
+	while (viAgentsByParent[uiSlot] != -1)
+	{
+		if (viAgentsByParent[uiSlot] == ahAgent)
+		{
+			viAgentsByParent[uiSlot] = -2;
+			return;
+		}
+		uiSlot = (uiSlot + 1) & uiMask;
+	}
+}
+
+// M: releases the handle of an unregistered agent for reuse. The handle is
+//    kept while agents are still indexed under it (they are unregistered 
+//    later on), since a new agent with the same handle would otherwise 
+//    find them as its children
+void CRegistry::releaseAgentHandle(TAgentHandle ahAgent)
+{
+	if (!vraAgents[ahAgent].pAgent && (vraAgents[ahAgent].iIndexedChildren == 0))
+		viFreeAgentHandles.push_back(ahAgent);
+}
+
+// M: rebuilds the (parent handle, child name id) table, dropping the 
+//    deleted markers; the new table is sized so that it is at most half 
+//    full
+void CRegistry::rehashChildren()
+{
+	TIntVector viOldSlots = viAgentsByParent;
+	unsigned int uiLive = 0;
+	for (unsigned int i = 0; i < viOldSlots.size(); i++)
+		if (viOldSlots[i] >= 0) uiLive++;
+	unsigned int uiNewSize = 16;
+	while ((uiLive + 1) * 2 > uiNewSize)
+		uiNewSize *= 2;
+	viAgentsByParent.assign(uiNewSize, -1);
+	iAgentsByParentUsed = 0;
+	unsigned int uiMask = uiNewSize - 1;
+	for (unsigned int i = 0; i < viOldSlots.size(); i++)
+		if (viOldSlots[i] >= 0)
+		{
+			TAgentHandle ahAgent = viOldSlots[i];
+			unsigned int uiSlot = hashChild(vraAgents[ahAgent].ahParent,
+				vraAgents[ahAgent].iChildNameID) & uiMask;
+			while (viAgentsByParent[uiSlot] != -1)
+				uiSlot = (uiSlot + 1) & uiMask;
+			viAgentsByParent[uiSlot] = ahAgent;
+			iAgentsByParentUsed++;
+		}
+}
+
 //-----------------------------------------------------------------------------
 //
 // Registry specific functions for registered agent types
@@ -172,7 +391,8 @@ CAgent* CRegistry::operator [](string sAgentName)
 //agent Type Ƿע
 bool CRegistry::IsRegisteredAgentType(string sAgentTypeName)
 {
-	return (AgentsTypeHash.find(sAgentTypeName) != AgentsTypeHash.end());
+	int iTypeID = stAgentTypeNames.Find(sAgentTypeName);
+	return (iTypeID != -1) && (vfcaAgentTypes[iTypeID] != NULL);
 }
 
 // D: register an agent type into the registry.
@@ -187,7 +407,10 @@ void CRegistry::RegisterAgentType(string sAgentTypeName, FCreateAgent fctCreateA
 
 	// register the agent type
 	// עAgent Type
-	AgentsTypeHash.insert(TAgentsTypeHash::value_type(sAgentTypeName, fctCreateAgent));
+	int iTypeID = stAgentTypeNames.Intern(sAgentTypeName);
+	if ((int)vfcaAgentTypes.size() <= iTypeID)
+		vfcaAgentTypes.resize(iTypeID + 1, NULL);
+	vfcaAgentTypes[iTypeID] = fctCreateAgent;
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent type %s registered successfully.", sAgentTypeName.c_str());
@@ -197,10 +420,16 @@ void CRegistry::RegisterAgentType(string sAgentTypeName, FCreateAgent fctCreateA
 // Agent Type
 void CRegistry::UnRegisterAgentType(string sAgentTypeName)
 {
-	if (AgentsTypeHash.erase(sAgentTypeName) == 0)
+	if (!IsRegisteredAgentType(sAgentTypeName))
 	{
 		FatalError("Could not find agent type" + sAgentTypeName + " to unregister.");
 	}
+	else
+	{
+		int iTypeID = stAgentTypeNames.Find(sAgentTypeName);
+		vfcaAgentTypes[iTypeID] = NULL;
+		stAgentTypeNames.Release(iTypeID);
+	}
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent type %s unregistered successfully.", sAgentTypeName.c_str());
@@ -211,9 +440,9 @@ void CRegistry::UnRegisterAgentType(string sAgentTypeName)
 CAgent* CRegistry::CreateAgent(string sAgentTypeName, string sAgentName, string sAgentConfiguration)
 {
 
-	TAgentsTypeHash::iterator iPtr;
+	int iTypeID = stAgentTypeNames.Find(sAgentTypeName);
 
-	if ((iPtr = AgentsTypeHash.find(sAgentTypeName)) == AgentsTypeHash.end())
+	if ((iTypeID == -1) || (vfcaAgentTypes[iTypeID] == NULL))
 	{
 		// if the agent type is not in the registry, we're in bad shape
 		FatalError("Could not create agent of type " + sAgentTypeName + ". Type not found in the registry.");
@@ -225,7 +454,7 @@ CAgent* CRegistry::CreateAgent(string sAgentTypeName, string sAgentName, string
 		// AgentĴ
 		// ˷AgentRegistry.CreateAgentʱá
 		// CAgent::virtual void Create();
-		CAgent* pNewAgent = (*(iPtr->second))(sAgentName, sAgentConfiguration);
+		CAgent* pNewAgent = (*(vfcaAgentTypes[iTypeID]))(sAgentName, sAgentConfiguration);
 		if (pNewAgent)
 		{
 			//###################################<1>	Create ################################################
@@ -53,6 +53,12 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the handles and the interned names of 
+//                            unregistered agents are reused
+//   [2026-10-19] (mbrenner): replaced the std::map based agents and agent
+//                            types hashes with open-addressing tables over
+//                            interned names; added agent handles and lookup
+//                            by (parent handle, child name)
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
 //   [2001-12-30] (dbohus): started working on this
 // 
@@ -77,9 +83,6 @@
 
 class CAgent;		// forward class declaration
 
-// D: definition of hash type to hold mapping from agent names to agents
-typedef map <string, CAgent*, less<string>, allocator<CAgent*> > TAgentsHash;
-
 // D: definition of function type for creating an agent
 //	agentĺָ
 typedef CAgent* (*FCreateAgent)(string, string);
@@ -99,9 +102,27 @@ typedef void(*FRegisterAgent)(void);
 */
 
 
-// D: definition of a hash type to hold mappings from agent type names to 
-//   create functions (see Agent.h) for those agents
-typedef map <string, FCreateAgent, less<string>, allocator<FCreateAgent>> TAgentsTypeHash;
+// M: handle to a registered agent. A handle stays valid (and refers to the
+//    same agent) for as long as the agent is registered; the handles of 
+//    unregistered agents are reused, so handles should not be kept past
+//    that point
+typedef int TAgentHandle;
+#define NULL_AGENT_HANDLE (-1)
+
+// M: an entry in the registry's agents table
+typedef struct
+{
+	CAgent* pAgent;					// the agent (NULL once unregistered)
+	int iNameID;					// the interned name of the agent
+	TAgentHandle ahParent;			// for agents named by a path in the tree
+									//  (i.e. /a/b), the handle of the parent
+									//  (/a), if it was registered
+	int iChildNameID;				// the interned last component of the 
+									//  path (b)
+	int iIndexedChildren;			// the number of agents indexed under 
+									//  this one (the handle is not reused
+									//  while there are any)
+} TRegisteredAgent;
 
 class CRegistry
 {
@@ -109,14 +130,33 @@ class CRegistry
 private:
 	//	hash holding agent name -> agent mapping
 	//	#Hash agent -> agent[thisָ]
-	TAgentsHash AgentsHash;
+	CStringTable stAgentNames;			// the interned agent names (and the
+										//  last components of agent paths)
+	vector<TRegisteredAgent> vraAgents;	// the agents, indexed by handle
+	TIntVector viFreeAgentHandles;		// the handles that can be reused
+	TIntVector viAgentsByName;			// name id -> agent handle
+	TIntVector viAgentsByParent;		// open-addressing table over (parent 
+										//  handle, child name id), holding 
+										//  agent handles (-1 empty, -2 deleted)
+	int iAgentsByParentUsed;			// number of used or deleted slots
 
 	//	hash holding agent type name -> agent creation function mapping
 	//	#Hash  Agent -> 캯ӳ
 	//	typedef CAgent* (*FCreateAgent)(string, string);
 	//		أCAgent*				ָ
 	//		string, string		string
-	TAgentsTypeHash AgentsTypeHash;
+	CStringTable stAgentTypeNames;		// the interned agent type names
+	vector<FCreateAgent> vfcaAgentTypes;// type name id -> creation function 
+										//  (NULL if not registered)
+
+	// private methods for the (parent handle, child name id) table
+	unsigned int hashChild(TAgentHandle ahParent, int iChildNameID);
+	void insertChild(TAgentHandle ahAgent);
+	void removeChild(TAgentHandle ahAgent);
+	void rehashChildren();
+
+	// releases the handle of an unregistered agent for reuse
+	void releaseAgentHandle(TAgentHandle ahAgent);
 
 public:
 	// Constructors and Destructor
@@ -134,10 +174,20 @@ public:
 
 	// Register and unregister an agent
 	// עagent
-	void RegisterAgent(string sAgentName, CAgent* pAgent);
+	TAgentHandle RegisterAgent(string sAgentName, CAgent* pAgent);
 	void UnRegisterAgent(string sAgentName);
 	bool IsRegisteredAgent(string sAgentName);
 
+	// Access to agent handles: by name, and by parent handle and child 
+	// name (for agents named by their path in the dialog tree), or by 
+	// ancestor handle and relative path (i.e. b/c)
+	TAgentHandle GetAgentHandle(string sAgentName);
+	TAgentHandle GetChildAgentHandle(TAgentHandle ahParent, string sChildName);
+	TAgentHandle GetDescendantAgentHandle(TAgentHandle ahAncestor, string sRelativePath);
+
+	// Obtain a pointer to the agent from a handle
+	CAgent* GetAgent(TAgentHandle ahAgent);
+
 	// Obtain a pointer to the agent
 	// []ȡagentָ
 	CAgent* operator[](string sAgentName);
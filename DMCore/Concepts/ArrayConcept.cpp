@@ -50,6 +50,13 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added InsertRangeAt() and DeleteRangeAt()
+//   [2026-10-19] (mbrenner): added the binary encoding of the hypset
+//   [2026-10-19] (mbrenner): concept updates use the update type enum
+//   [2026-10-19] (mbrenner): the history is now kept as an indexed vector of
+//                            versions (constant time append and indexed
+//                            access, bulk free) instead of a linked chain
 //   [2004-12-06] (antoine): fixed inconsistencies so that an array is always
 //                           considered as an atomic concept when reopened,
 //                           tested for availability, etc.
@@ -146,9 +153,7 @@ CArrayConcept::~CArrayConcept()
 	ConceptArray.clear();
 
 	// and destroy the history
-	if (pPrevConcept != NULL)
-		delete pPrevConcept;
-	pPrevConcept = NULL;
+	freeHistory();
 	// and the grounding model (if any)
 	if (pGroundingModel != NULL)
 	{
@@ -222,18 +227,11 @@ CConcept& CArrayConcept::operator [](int iIndex)
 	// if a negative index into history, deal with that
 	if (iIndex < 0)
 	{
-		if (pPrevConcept != NULL)
+		CConcept* pHistoryConcept = historyVersionAt(iIndex);
+		if (pHistoryConcept != NULL)
 		{
-			// if adressing previous in history, return that
-			if (iIndex == -1)
-			{
-				return *pPrevConcept;
-			}
-			else
-			{
-				// o/w go recursively
-				return pPrevConcept->operator [](iIndex + 1);
-			}
+			// if adressing a version in history, return that
+			return *pHistoryConcept;
 		}
 		else
 		{
@@ -339,10 +337,8 @@ CConcept* CArrayConcept::Clone(bool bCloneHistory)
 	// a clone does not wait for conveyance
 	pConcept->bWaitingConveyance = false;
 	pConcept->SetHistoryConcept(bHistoryConcept);
-	if (bCloneHistory && (pPrevConcept != NULL))
-		pConcept->pPrevConcept = pPrevConcept->Clone();
-	else
-		pConcept->pPrevConcept = NULL;
+	if (bCloneHistory)
+		cloneHistoryInto(pConcept);
 
 	// finally, return the clone
 	return pConcept;
@@ -486,14 +482,14 @@ void CArrayConcept::Update_NPU_AssignFromString(void* pUpdateData)
 			if (sConfidence != "")
 				sElementValue = sElementValue +
 				VAL_CONF_SEPARATOR + sConfidence;
-			pElement->Update(CU_ASSIGN_FROM_STRING, &sElementValue);
+			pElement->Update(cuAssignFromString, &sElementValue);
 		}
 		else
 		{
 			if (sConfidence != "")
 				sElementValue = sElementValue +
 				VAL_CONF_SEPARATOR + sConfidence;
-			pElement->Update(CU_ASSIGN_FROM_STRING, &sElementValue);
+			pElement->Update(cuAssignFromString, &sElementValue);
 		}
 
 		// set its name accordingly
@@ -550,7 +546,7 @@ void CArrayConcept::Update_NPU_CollapseToMode(void* pUpdateData)
 {
 	// call it for all the elements of the array
 	for (int i = 0; i < GetSize(); i++)
-		ConceptArray[i]->Update(CU_COLLAPSE_TO_MODE, pUpdateData);
+		ConceptArray[i]->Update(cuCollapseToMode, pUpdateData);
 }
 
 //-----------------------------------------------------------------------------
@@ -571,7 +567,7 @@ void CArrayConcept::Update_Calista_CollapseToMode(void* pUpdateData)
 {
 	// call it for all the elements of the array
 	for (int i = 0; i < GetSize(); i++)
-		ConceptArray[i]->Update(CU_COLLAPSE_TO_MODE, pUpdateData);
+		ConceptArray[i]->Update(cuCollapseToMode, pUpdateData);
 }
 
 //-----------------------------------------------------------------------------
@@ -1073,6 +1069,55 @@ void CArrayConcept::SetHistoryConcept(bool bAHistoryConcept)
 		ConceptArray[i]->SetHistoryConcept(bAHistoryConcept);
 }
 
+//-----------------------------------------------------------------------------
+// Overwritten methods implementing the binary encoding
+//-----------------------------------------------------------------------------
+
+// M: writes the current hypset: the number of elements, followed by the 
+//    full state of each element
+void CArrayConcept::writeBinaryHypSet(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteUInt32((unsigned int)ConceptArray.size());
+	for (unsigned int i = 0; i < ConceptArray.size(); i++)
+		ConceptArray[i]->WriteBinaryState(rbwWriter);
+}
+
+// M: reads the current hypset (the elements are created like in 
+//    CopyCurrentHypSetFrom)
+void CArrayConcept::readBinaryHypSet(CBinaryReader& rbrReader)
+{
+	ClearCurrentHypSet();
+	int iSize = (int)rbrReader.ReadUInt32();
+	for (int i = 0; (i < iSize) && !rbrReader.Failed(); i++)
+	{
+		CConcept* pAConcept = CreateElement();
+		pAConcept->SetChangeNotification(bChangeNotification);
+		pAConcept->SetName(FormatString("%s.%d", sName.c_str(), i));
+		pAConcept->SetOwnerDialogAgent(pOwnerDialogAgent);
+		pAConcept->SetOwnerConcept(this);
+		pAConcept->ReadBinaryState(rbrReader);
+		ConceptArray.push_back(pAConcept);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Overwritten methods for memory accounting
+//-----------------------------------------------------------------------------
+
+// M: accounts the memory held by the array, and by its elements
+void CArrayConcept::AccountMemoryUsage(TMemoryAccount& rmaAccount,
+	const string& sComponent)
+{
+	CConcept::AccountMemoryUsage(rmaAccount, sComponent);
+
+	AccountMemory(rmaAccount, sComponent, 0,
+		(int)(sizeof(CArrayConcept) - sizeof(CConcept)) +
+		(int)(ConceptArray.capacity() * sizeof(CConcept*)));
+
+	for (unsigned int i = 0; i < ConceptArray.size(); i++)
+		ConceptArray[i]->AccountMemoryUsage(rmaAccount, sComponent);
+}
+
 
 //-----------------------------------------------------------------------------
 // Overwritten methods that are array-specific
@@ -1086,6 +1131,22 @@ int CArrayConcept::GetSize()
 
 // D: DeleteAt method
 void CArrayConcept::DeleteAt(unsigned int iIndex)
+{
+	DeleteRangeAt(iIndex, 1);
+}
+
+// J: InsertAt() method: inserts the element in the array at a particular 
+//    position
+void CArrayConcept::InsertAt(unsigned int iIndex, CConcept &rAConcept)
+{
+	TConceptPointersVector vcpConcepts(1, &rAConcept);
+	InsertRangeAt(iIndex, vcpConcepts);
+}
+
+// M: deletes iCount elements starting at a given index. The elements are 
+//    removed from the array in one pass, the ones that follow are renamed 
+//    once, and the change is notified once
+void CArrayConcept::DeleteRangeAt(unsigned int iIndex, unsigned int iCount)
 {
 	// check that it's not a history concept
 	if (bHistoryConcept)
@@ -1093,19 +1154,25 @@ void CArrayConcept::DeleteAt(unsigned int iIndex)
 		sName.c_str()));
 
 	// o/w 
-	if (iIndex >= ConceptArray.size())
+	if ((iIndex >= ConceptArray.size()) || 
+		(iCount > ConceptArray.size() - iIndex))
 		// an index outside the array limits was provided
 		FatalError(FormatString("Index (%d) out of bounds in DeleteAt on concept %s.",
-		iIndex, sName));
+		iIndex + iCount - 1, sName.c_str()));
+
+	if (iCount == 0)
+		return;
 
-	// destroy the concept at the index
-	delete (ConceptArray[iIndex]);
+	// destroy the concepts in the range
+	for (unsigned int i = iIndex; i < iIndex + iCount; i++)
+		delete (ConceptArray[i]);
 
-	// delete the element in the array
-	ConceptArray.erase(ConceptArray.begin() + iIndex);
+	// delete the elements in the array
+	ConceptArray.erase(ConceptArray.begin() + iIndex, 
+		ConceptArray.begin() + iIndex + iCount);
 
 	// fix the name numbering of the rest of the elements in the vector
-	for (iIndex++; iIndex < ConceptArray.size(); iIndex++)
+	for (; iIndex < ConceptArray.size(); iIndex++)
 		ConceptArray[iIndex]->SetName(FormatString("%s.%d", \
 		sName.c_str(), iIndex));
 
@@ -1113,9 +1180,11 @@ void CArrayConcept::DeleteAt(unsigned int iIndex)
 	NotifyChange();
 }
 
-// J: InsertAt() method: inserts the element in the array at a particular 
-//    position
-void CArrayConcept::InsertAt(unsigned int iIndex, CConcept &rAConcept)
+// M: inserts copies of a set of concepts starting at a given index. The 
+//    elements are inserted in the array in one pass, the ones that follow 
+//    are renamed once, and the change is notified once
+void CArrayConcept::InsertRangeAt(unsigned int iIndex, 
+	TConceptPointersVector& rvcpConcepts)
 {
 
 	// check that it's not a history concept
@@ -1127,25 +1196,32 @@ void CArrayConcept::InsertAt(unsigned int iIndex, CConcept &rAConcept)
 	if (iIndex > ConceptArray.size())
 		// an index outside the array limits was provided
 		FatalError(FormatString("Index (%d) out of bounds in InsertAt on concept %s.",
-		iIndex, sName));
-
-	// create a blank Concept and copy stuff from rAConcept into it
-	CConcept* pAConcept = CreateElement();
-	// set the change notifications flag
-	pAConcept->SetChangeNotification(bChangeNotification);
-	*pAConcept = rAConcept;
-	pAConcept->SetName(FormatString("%s.%d", sName.c_str(), iIndex));
-	pAConcept->SetOwnerDialogAgent(pOwnerDialogAgent);
-	pAConcept->SetOwnerConcept(pOwnerConcept);
-
-	// check if we want to push it at the end of the array
-	if (iIndex == ConceptArray.size())
-		ConceptArray.push_back(pAConcept);
-	else // insert the element in the array
-		ConceptArray.insert(ConceptArray.begin() + iIndex, pAConcept);
+		iIndex, sName.c_str()));
 
-	// fix the name numbering of the rest of the elements in the vector
-	for (iIndex++; iIndex < ConceptArray.size(); iIndex++)
+	if (rvcpConcepts.empty())
+		return;
+
+	// create blank concepts and copy stuff from the given ones into them
+	TConceptPointersVector vcpElements;
+	vcpElements.reserve(rvcpConcepts.size());
+	for (unsigned int i = 0; i < rvcpConcepts.size(); i++)
+	{
+		CConcept* pAConcept = CreateElement();
+		// set the change notifications flag
+		pAConcept->SetChangeNotification(bChangeNotification);
+		*pAConcept = *rvcpConcepts[i];
+		pAConcept->SetOwnerDialogAgent(pOwnerDialogAgent);
+		pAConcept->SetOwnerConcept(this);
+		vcpElements.push_back(pAConcept);
+	}
+
+	// insert the elements in the array
+	ConceptArray.insert(ConceptArray.begin() + iIndex, 
+		vcpElements.begin(), vcpElements.end());
+
+	// fix the name numbering of the new elements and of the rest of the 
+	// elements in the vector
+	for (; iIndex < ConceptArray.size(); iIndex++)
 		ConceptArray[iIndex]->SetName(FormatString("%s.%d", \
 		sName.c_str(), iIndex));
 
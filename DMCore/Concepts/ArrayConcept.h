@@ -50,6 +50,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added InsertRangeAt() and DeleteRangeAt()
+//   [2026-10-19] (mbrenner): added the binary encoding of the hypset
 //   [2004-12-06] (antoine): fixed inconsistencies so that an array is always
 //                           considered as an atomic concept when reopened,
 //                           tested for availability, etc.
@@ -340,6 +343,14 @@ public:
 	// set the history concept flag
 	virtual void SetHistoryConcept(bool bAHistoryConcept = true);
 
+	//---------------------------------------------------------------------
+	// Overwritten methods for memory accounting
+	//---------------------------------------------------------------------
+
+	// account the memory held by the array and its elements
+	virtual void AccountMemoryUsage(TMemoryAccount& rmaAccount,
+		const string& sComponent = MA_CONCEPTS);
+
 	//---------------------------------------------------------------------
 	// Overwritten methods that are array-specific 
 	//---------------------------------------------------------------------
@@ -353,6 +364,24 @@ public:
 	// inserts an element at a give index in the array
 	virtual void InsertAt(unsigned int iIndex, CConcept &rAConcept);
 
+	// deletes iCount elements starting at a given index in the array
+	virtual void DeleteRangeAt(unsigned int iIndex, unsigned int iCount);
+
+	// inserts copies of a set of concepts starting at a given index in 
+	// the array
+	virtual void InsertRangeAt(unsigned int iIndex, 
+		TConceptPointersVector& rvcpConcepts);
+
+protected:
+
+	//---------------------------------------------------------------------
+	// Overwritten methods implementing the binary encoding
+	//---------------------------------------------------------------------
+
+	// write / read the binary encoding of the current hypset
+	virtual void writeBinaryHypSet(CBinaryWriter& rbwWriter);
+	virtual void readBinaryHypSet(CBinaryReader& rbrReader);
+
 };
 
 //-----------------------------------------------------------------------------
@@ -50,6 +50,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the binary encoding of the value
+//   [2026-10-19] (mbrenner): CBoolHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -97,6 +99,9 @@ CBoolConcept cFalse("_system_False", false, 1, csSystem);
 // CBoolHyp: Constructors and Destructors
 //-----------------------------------------------------------------------------
 
+// M: pooled allocation operators
+DEFINE_HYP_POOL(CBoolHyp)
+
 // D: default constructor
 CBoolHyp::CBoolHyp()
 {
@@ -209,6 +214,12 @@ CHyp* CBoolHyp::operator [] (string sItem)
 	return NULL;
 }
 
+// M: Value hash
+unsigned int CBoolHyp::ValueHash()
+{
+	return HashCombine(FNV_HASH_SEED, bValue ? 1 : 0);
+}
+
 // D: Convert value to string
 string CBoolHyp::ValueToString()
 {
@@ -267,6 +278,18 @@ void CBoolHyp::FromString(string sString)
 	}
 }
 
+// M: Write the value in the binary format
+void CBoolHyp::WriteValueBinary(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteUInt8(bValue ? 1 : 0);
+}
+
+// M: Read the value from the binary format
+void CBoolHyp::ReadValueBinary(CBinaryReader& rbrReader)
+{
+	bValue = (rbrReader.ReadUInt8() != 0);
+}
+
 
 //-----------------------------------------------------------------------------
 // CBoolConcept class - this is the boolean concept class. It overloads and
@@ -301,7 +324,6 @@ CBoolConcept::CBoolConcept(string sAName, bool bAValue, float fAConfidence,
 	bWaitingConveyance = false;
 	cConveyance = cNotConveyed;
 	SetHistoryConcept(false);
-	pPrevConcept = NULL;
 }
 
 //-----------------------------------------------------------------------------
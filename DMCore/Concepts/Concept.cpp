@@ -50,6 +50,47 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the hypotheses are the only storage for the 
+//                            confidences (the sweeps gather them), and freed
+//                            slots are reused only on request
+//   [2026-10-19] (mbrenner): the journal records only the parts of the concept
+//                            state that are about to change, and restores all
+//                            of them (including the conveyance notification
+//                            request and the explicitly (dis)confirmed hyps)
+//   [2026-10-19] (mbrenner): the Calista update scores through the compiled belief
+//                            updating model (no more copy of the model per update)
+//   [2026-10-19] (mbrenner): the hypsets of atomic concepts are shared 
+//                            (reference counted, copy-on-write) by 
+//                            CopyCurrentHypSetFrom, and therefore by Clone,
+//                            Restore and the snapshots
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added the concept version (GetVersion), used for
+//                            caching agent conditions
+//   [2026-10-19] (mbrenner): added InsertRangeAt() and DeleteRangeAt()
+//   [2026-10-19] (mbrenner): added the cached merged history view of the 
+//                            concept (GetMergedHistoryConcept)
+//   [2026-10-19] (mbrenner): added the binary encoding of concepts (ToBinary
+//                            and FromBinary)
+//   [2026-10-19] (mbrenner): Update dispatches on the update type enum and
+//                            the belief updating model through a table; the
+//                            value dumps are built only if they are logged
+//   [2026-10-19] (mbrenner): the history is now kept as an indexed vector of
+//                            versions (constant time append and indexed
+//                            access, bulk free) instead of a linked chain
+//   [2026-10-19] (mbrenner): the NPU update now uses the vectorized float 
+//                            vector kernels for products and sums
+//   [2026-10-19] (mbrenner): the NPU merge and GetHypIndex now find hyps
+//                            through the value hash index
+//   [2026-10-19] (mbrenner): top and second hyp indices are now maintained
+//                            incrementally as the hypset changes
+//   [2026-10-19] (mbrenner): freed hyp slots can be reused when adding new
+//                            hypotheses (compact hyp storage, off by
+//                            default)
+//   [2026-10-19] (mbrenner): the explicit confirmation update looks up the
+//                            RequestConfirm agent by its parent's registry
+//                            handle
+//   [2026-10-19] (mbrenner): concepts are now recorded in the dialog state journal
+//                            before they change, which allows fast rollbacks
 //	 [2005-11-07] (antoine): added support for partial concept update
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
@@ -112,6 +153,10 @@
 // NULL˶ָЧ
 CConcept NULLConcept("NULL");
 
+// counters for the top/second hyp index queries
+unsigned long CConcept::ulTopHypQueries = 0;
+unsigned long CConcept::ulTopHypSweeps = 0;
+
 //-----------------------------------------------------------------------------
 // CHyp class - this is the base class for the hierarchy of hypothesis
 //              classes. It essentially implements a type and an associated 
@@ -218,6 +263,12 @@ CHyp* CHyp::operator [] (string sItem)
 	return NULL;
 }
 
+// M: Value hash - by default, hash the string representation of the value
+unsigned int CHyp::ValueHash()
+{
+	return HashString(ValueToString());
+}
+
 // D: Convert value to string
 string CHyp::ValueToString()
 {
@@ -238,6 +289,20 @@ void CHyp::FromString(string sString)
 	FatalError("FromString called on abstract CHyp. Call failed.");
 }
 
+// M: Write the value in the binary format - by default, as the string 
+//    representation of the value
+void CHyp::WriteValueBinary(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteString(ValueToString());
+}
+
+// M: Read the value from the binary format - by default, from the string
+//    representation of the value (the confidence is set by the caller)
+void CHyp::ReadValueBinary(CBinaryReader& rbrReader)
+{
+	FromString(rbrReader.ReadString());
+}
+
 
 //-----------------------------------------------------------------------------
 //
@@ -266,12 +331,22 @@ CConcept::CConcept(string sAName, TConceptSource csAConceptSource, int iACardina
 	bSealed = false;
 	bChangeNotification = true;
 	iNumValidHyps = 0;
+	piHypSetRefCount = NULL;
+	bCompactHypStorage = false;
+	// derived constructors may fill in the hypset directly, so start with
+	// a dirty top hyps cache
+	iCachedTopHypIndex = -1;
+	iCached2ndHypIndex = -1;
+	bTopHypsDirty = true;
+	bHypValueIndexDirty = true;
 	iCardinality = iACardinality;
 	iTurnLastUpdated = -1;
 	cConveyance = cNotConveyed;
 	bWaitingConveyance = false;
-	pPrevConcept = NULL;
 	bHistoryConcept = false;
+	pMergedHistoryCache = NULL;
+	bMergedHistoryCacheDirty = true;
+	iVersion = 0;
 	sExplicitlyConfirmedHyp = "";
 	sExplicitlyDisconfirmedHyp = "";
 }
@@ -281,9 +356,14 @@ CConcept::CConcept(string sAName, TConceptSource csAConceptSource, int iACardina
 CConcept::~CConcept()
 {
 	// delete the history
-	if (pPrevConcept != NULL)
-		delete pPrevConcept;
-	pPrevConcept = NULL;
+	freeHistory();
+	// delete the cached merged history view
+	if (pMergedHistoryCache != NULL)
+		delete pMergedHistoryCache;
+	pMergedHistoryCache = NULL;
+	// drop the reference to the hypotheses, if they are shared (the 
+	// hypotheses themselves are not deleted here, as before)
+	releaseHypSet();
 	// delete the grounding model
 	if (pGroundingModel != NULL)
 	{
@@ -297,6 +377,9 @@ CConcept::~CConcept()
 	if (bWaitingConveyance) ClearWaitingConveyance();
 	// clear the concept notification pointer
 	ClearConceptNotificationPointer();
+	// and make sure the dialog state journal no longer refers to it
+	if (pDMCore)
+		pDMCore->ForgetJournaledConcept(this);
 }
 
 //-----------------------------------------------------------------------------
@@ -310,7 +393,7 @@ CConcept& CConcept::operator = (CConcept& rAConcept)
 	if (&rAConcept != this)
 	{
 		// call on the update from concept
-		Update(CU_ASSIGN_FROM_CONCEPT, &rAConcept);
+		Update(cuAssignFromConcept, &rAConcept);
 	}
 	return *this;
 }
@@ -355,7 +438,7 @@ CConcept& CConcept::operator = (double dAValue)
 CConcept& CConcept::operator = (string sAValue)
 {
 	// call upon the AssignFromString update
-	Update(CU_ASSIGN_FROM_STRING, &sAValue);
+	Update(cuAssignFromString, &sAValue);
 	return *this;
 }
 
@@ -447,18 +530,10 @@ CConcept& CConcept::operator [](int iIndex)
 	if (iIndex == 0)
 		return *this;
 	// check if index is negative, then return the concept in history
-	if ((iIndex < 0) && (pPrevConcept != NULL))
+	CConcept* pHistoryConcept = historyVersionAt(iIndex);
+	if (pHistoryConcept != NULL)
 	{
-		// if adressing previous in history, return that
-		if (iIndex == -1)
-		{
-			return *pPrevConcept;
-		}
-		else
-		{
-			// o/w go recursively
-			return pPrevConcept->operator [](iIndex + 1);
-		}
+		return *pHistoryConcept;
 	}
 	else
 	{
@@ -550,26 +625,25 @@ void CConcept::Clear()
 		FatalError(FormatString("Cannot perform Clear on concept (%s) history.",
 		sName.c_str()));
 
+	// record the concept in the journal
+	journalChange(CJ_HYPSET | CJ_HISTORY);
+
 	// record the initial value of the concept (if the concept has a grounding model)
 	// ¼ǰ ֵ иGroudingModel
 	string sInitialValue;
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		sInitialValue = TrimRight(HypSetToString());
 
 	// o/w delete all it's history
 	// ɾеʷ
-	if (pPrevConcept != NULL)
-	{
-		delete pPrevConcept;
-		pPrevConcept = NULL;
-	}
+	freeHistory();
 
 	// and clear the current value (notifies the change)
 	// յǰֵ Hypϡ
 	ClearCurrentHypSet();
 
 	// now log the update (if the concept has a grounding model
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		Log(CONCEPT_STREAM, FormatString(
 		"Concept update [clear] on %s:\nInitial value dumped below:\n%s\n"
 		"Updated value dumped below:\n%s",
@@ -594,17 +668,20 @@ void CConcept::ClearCurrentValue()
 		"Cannot perform ClearCurrentValue on concept (%s) history.",
 		sName.c_str()));
 
+	// record the concept in the journal
+	journalChange(CJ_HYPSET);
+
 	// record the initial value of the concept (if the concept has a grounding
 	//  model)
 	string sInitialValue;
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		sInitialValue = TrimRight(HypSetToString());
 
 	// o/w clear the current value (this notifies the change)
 	ClearCurrentHypSet();
 
 	// now log the update (if the concept has a grounding model
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		Log(CONCEPT_STREAM, FormatString(
 		"Concept update [clear_current_value] on %s:\nInitial value dumped below:\n%s\n"
 		"Updated value dumped below:\n%s",
@@ -652,10 +729,8 @@ CConcept* CConcept::Clone(bool bCloneHistory)
 	pConcept->bWaitingConveyance = false;
 	pConcept->SetHistoryConcept(bHistoryConcept);
 	// now clone the history if required
-	if (bCloneHistory && (pPrevConcept != NULL))
-		pConcept->pPrevConcept = pPrevConcept->Clone();
-	else
-		pConcept->pPrevConcept = NULL;
+	if (bCloneHistory)
+		cloneHistoryInto(pConcept);
 	// set the explicitly confirmed and disconfirmed hyps
 	pConcept->sExplicitlyConfirmedHyp = sExplicitlyConfirmedHyp;
 	pConcept->sExplicitlyDisconfirmedHyp = sExplicitlyDisconfirmedHyp;
@@ -690,65 +765,82 @@ CConcept* CConcept::EmptyClone()
 //pUpdateData = sBindingString =>  ʽ slotValue|confidence    ==>  value/confidence
 void CConcept::Update(string sUpdateType, void* pUpdateData)
 {
-
-	//		record the initial value of the concept (if the concept has a grounding model
-	// <1>	¼ĳʼֵнӵģͣ
+	TConceptUpdateType cuUpdateType = StringToConceptUpdateType(sUpdateType);
+	if (cuUpdateType == cuUnknown)
+		FatalError(FormatString(
+		"Unknown update type (%s) in updating concept %s.",
+		sUpdateType.c_str(), GetAgentQualifiedName().c_str()));
+	Update(cuUpdateType, pUpdateData);
+}
+
+// M: the update functions, by belief updating model and update type
+CConcept::FConceptUpdateFunction 
+	CConcept::pfUpdateFunctions[BUM_NUM_MODELS][cuUnknown] = {
+	// BUM_NPU
+	{ &CConcept::Update_NPU_AssignFromString,
+	  &CConcept::Update_NPU_AssignFromConcept,
+	  &CConcept::Update_NPU_UpdateWithConcept,
+	  &CConcept::Update_NPU_CollapseToMode,
+	  &CConcept::Update_PartialFromString },
+	// BUM_CALISTA
+	{ &CConcept::Update_Calista_AssignFromString,
+	  &CConcept::Update_Calista_AssignFromConcept,
+	  &CConcept::Update_Calista_UpdateWithConcept,
+	  &CConcept::Update_Calista_CollapseToMode,
+	  NULL }
+};
+
+// M: update the concept: calls the update function for the belief updating 
+//    model and the update type
+void CConcept::Update(TConceptUpdateType cuUpdateType, void* pUpdateData)
+{
+	// record the concept in the journal
+	journalChange(CJ_HYPSET);
+
+	// record the initial value of the concept (if the update is logged)
 	string sInitialValue;
-	string sInitialPartialValue;
-	if (pGroundingModel)
+	bool bLogUpdate = isUpdateLogged();
+	if (bLogUpdate)
 		sInitialValue = TrimRight(HypSetToString());
 
-	//		call the appropriate function based on the belief updating model and on the update type
-	// <2>	ģ͵Ӧĺ => ģ ["npu", "calista" ]
-	string sBeliefUpdatingModelName = pGroundingManager->GetBeliefUpdatingModelName();
-	if (sBeliefUpdatingModelName == "npu")
-	{
-		if (sUpdateType == CU_ASSIGN_FROM_STRING)
-			Update_NPU_AssignFromString(pUpdateData);
-		else if (sUpdateType == CU_ASSIGN_FROM_CONCEPT)
-			Update_NPU_AssignFromConcept(pUpdateData);
-		else if (sUpdateType == CU_UPDATE_WITH_CONCEPT)
-			Update_NPU_UpdateWithConcept(pUpdateData);
-		else if (sUpdateType == CU_COLLAPSE_TO_MODE)
-			Update_NPU_CollapseToMode(pUpdateData);
-		else if (sUpdateType == CU_PARTIAL_FROM_STRING)
-			Update_PartialFromString(pUpdateData);
-		else FatalError(FormatString(
+	// call the appropriate function based on the belief updating model and 
+	// on the update type
+	int iBeliefUpdatingModel = pGroundingManager->GetBeliefUpdatingModel();
+	if (iBeliefUpdatingModel != BUM_UNKNOWN)
+	{
+		if ((cuUpdateType < 0) || (cuUpdateType >= cuUnknown) ||
+			(pfUpdateFunctions[iBeliefUpdatingModel][cuUpdateType] == NULL))
+			FatalError(FormatString(
 			"Unknown update type (%s) in updating concept %s.",
-			sUpdateType.c_str(), GetAgentQualifiedName().c_str()));
+			ConceptUpdateTypeToString(cuUpdateType).c_str(),
+			GetAgentQualifiedName().c_str()));
+		else
+			(this->*pfUpdateFunctions[iBeliefUpdatingModel][cuUpdateType])(
+			pUpdateData);
 
 		// if we got a final update, erase the previous partial one
-		if (sUpdateType != CU_PARTIAL_FROM_STRING)
-		{
+		if ((iBeliefUpdatingModel == BUM_NPU) && 
+			(cuUpdateType != cuPartialFromString))
 			ClearPartialHypSet();
-		}
-
-	}
-	else if (sBeliefUpdatingModelName == "calista")
-	{
-		if (sUpdateType == CU_ASSIGN_FROM_STRING)
-			Update_Calista_AssignFromString(pUpdateData);
-		else if (sUpdateType == CU_ASSIGN_FROM_CONCEPT)
-			Update_Calista_AssignFromConcept(pUpdateData);
-		else if (sUpdateType == CU_UPDATE_WITH_CONCEPT)
-			Update_Calista_UpdateWithConcept(pUpdateData);
-		else if (sUpdateType == CU_COLLAPSE_TO_MODE)
-			Update_Calista_CollapseToMode(pUpdateData);
-		else FatalError(FormatString(
-			"Unknown update type (%s) in updating concept %s.",
-			sUpdateType.c_str(), GetAgentQualifiedName().c_str()));
 	}
 
-	// now log the update (if the concept has a grounding model
-	if (pGroundingModel)
+	// now log the update (if the update is logged)
+	if (bLogUpdate)
 		Log(CONCEPT_STREAM, FormatString(
 		"Concept update [%s] on %s:\nInitial value dumped below:\n%s\n"
 		"Updated value dumped below:\n%s",
-		sUpdateType.c_str(), GetAgentQualifiedName().c_str(),
+		ConceptUpdateTypeToString(cuUpdateType).c_str(),
+		GetAgentQualifiedName().c_str(),
 		sInitialValue.c_str(),
 		TrimRight(HypSetToString()).c_str()));
 }
 
+// M: returns true if the updates on the concept are logged
+bool CConcept::isUpdateLogged()
+{
+	return (pGroundingModel != NULL) && IsLoggingStreamActive(CONCEPT_STREAM);
+}
+
 // ----------------------------------------------------------------------------
 // D: Update function for the Naive Probabilistic update model
 // ----------------------------------------------------------------------------
@@ -783,6 +875,7 @@ void CConcept::Update_NPU_AssignFromString(void* pUpdateData)
 
 		// acquire it from string
 		vhCurrentHypSet[iIndex]->FromString(sValConf);
+		syncHypSlot(iIndex);
 	}
 }
 
@@ -838,28 +931,22 @@ void CConcept::Update_NPU_UpdateWithConcept(void* pUpdateData)
 		// hold the confidences in 2 arrays vfConf1, vfConf2
 		vector<float, allocator<float> > vfConf1, vfConf2;
 
-		// copy the confidences for the first set and sum them up
-		float fConf1Sum = 0;
+		// gather the confidences for the first set and sum them up (the 
+		// null hypotheses are marked by NULL_HYP_CONFIDENCE)
+		gatherHypConfidences(vfConf1);
+		float fConf1Sum = SumFloatVector(vfConf1, NULL_HYP_CONFIDENCE);
 		for (int i = 0; i < (int)vhCurrentHypSet.size(); i++)
 		{
-			if (vhCurrentHypSet[i] != NULL)
-			{
-				vfConf1.push_back(vhCurrentHypSet[i]->GetConfidence());
-				fConf1Sum += vfConf1[i];
-			}
-			else
-			{
-				vfConf1.push_back(0);
-			}
+			if (vhCurrentHypSet[i] == NULL)
+				vfConf1[i] = 0;
 
 			Log(CONCEPT_STREAM, "vfConf1[%d]=%f", i, vfConf1[i]);
 		}
 
-		// sum up the confidences for the second set
-		float fConf2Sum = 0;
-		for (int i = 0; i < (int)pConcept->vhCurrentHypSet.size(); i++)
-		if (pConcept->vhCurrentHypSet[i] != NULL)
-			fConf2Sum += pConcept->vhCurrentHypSet[i]->GetConfidence();
+		// gather and sum up the confidences for the second set
+		vector<float, allocator<float> > vfConfSource;
+		pConcept->gatherHypConfidences(vfConfSource);
+		float fConf2Sum = SumFloatVector(vfConfSource, NULL_HYP_CONFIDENCE);
 
 		// compute the confidences for the "unknown" values in sets 1 and 2
 		float fUnkConf1;
@@ -879,28 +966,28 @@ void CConcept::Update_NPU_UpdateWithConcept(void* pUpdateData)
 			vfConf2.push_back(fUnkConf2);
 
 		// now go through the second vector, and add the values one by one, checking
-		// if they are already in the set
+		// if they are already in the set (through the value hash index, which
+		// is built once, over the original set)
 		unsigned int iOrigSetSize = vhCurrentHypSet.size();
+		refreshHypValueIndex();
 		for (int i = 0; i < (int)pConcept->vhCurrentHypSet.size(); i++)
 		{
 			bool bFound = false;
 			unsigned int j = 0;
 			if (pConcept->vhCurrentHypSet[i] != NULL)
 			{
-				for (j = 0; j < iOrigSetSize; j++)
+				int iMatch = lookupHypValue(pConcept->vhCurrentHypSet[i]);
+				if ((iMatch != -1) && (iMatch < (int)iOrigSetSize))
 				{
-					if (*(pConcept->vhCurrentHypSet[i]) == *(vhCurrentHypSet[j]))
-					{
-						bFound = true;
-						break;
-					}
+					j = (unsigned int)iMatch;
+					bFound = true;
 				}
 			}
 			// if found in the set
 			if (bFound)
 			{
 				// just set the appropriate confidence value
-				vfConf2[j] = pConcept->vhCurrentHypSet[i]->GetConfidence();
+				vfConf2[j] = vfConfSource[i];
 			}
 			else
 			{
@@ -910,9 +997,19 @@ void CConcept::Update_NPU_UpdateWithConcept(void* pUpdateData)
 					// add a new hypothesis (this will notify the change)
 					int iIndex = AddNewHyp();
 					*(vhCurrentHypSet[iIndex]) = *(pConcept->vhCurrentHypSet[i]);
-					// and set the confidences right
-					vfConf1.push_back(fUnkConf1);
-					vfConf2.push_back(pConcept->vhCurrentHypSet[i]->GetConfidence());
+					syncHypSlot(iIndex);
+					// and set the confidences right (the new hypothesis 
+					// might have reused a freed slot)
+					if (iIndex < (int)vfConf1.size())
+					{
+						vfConf1[iIndex] = fUnkConf1;
+						vfConf2[iIndex] = vfConfSource[i];
+					}
+					else
+					{
+						vfConf1.push_back(fUnkConf1);
+						vfConf2.push_back(vfConfSource[i]);
+					}
 				}
 				else
 				{
@@ -924,40 +1021,43 @@ void CConcept::Update_NPU_UpdateWithConcept(void* pUpdateData)
 			}
 		}
 
-		// finally, multiply the scores in 
+		// all the confidences change below, so simply mark the top hyps
+		// cache dirty instead of maintaining it on each update
+		bTopHypsDirty = true;
+
+		// finally, multiply the scores in (the product kernel also computes
+		// the normalizing factor for the known hypotheses)
+		vector<float, allocator<float> > vfProduct;
+		float fNormalizer = MultiplyFloatVectors(vfProduct, vfConf1, vfConf2);
 		for (int i = 0; i < (int)vhCurrentHypSet.size(); i++)
 		{
 			if (vhCurrentHypSet[i] != NULL)
 				// this will also notify the change
-				SetHypConfidence(i, vfConf1[i] * vfConf2[i]);
+				SetHypConfidence(i, vfProduct[i]);
 		}
 
 		// compute the normalizing factor
-		float fNormalizer = 0;
-		for (int i = 0; i < (int)vfConf1.size(); i++)
-			fNormalizer += vfConf1[i] * vfConf2[i];
 		fNormalizer += (iCardinality - vfConf1.size())*fUnkConf1*fUnkConf2;
 
 		// and update the confidences
+		ScaleFloatVector(vfProduct, 1 / fNormalizer, NULL_HYP_CONFIDENCE);
 		for (int i = 0; i < (int)vhCurrentHypSet.size(); i++)
 		if (vhCurrentHypSet[i] != NULL)
 			// this will also notify the change
-			SetHypConfidence(i, (vfConf1[i] * vfConf2[i]) / fNormalizer);
+			SetHypConfidence(i, vfProduct[i]);
 
 		// now, make sure that at least FREE_PROB_MASS is allocated to the rest
-		fNormalizer = 0;
-		for (int i = 0; i < (int)vhCurrentHypSet.size(); i++)
-		if (vhCurrentHypSet[i] != NULL)
-			fNormalizer += vhCurrentHypSet[i]->GetConfidence();
+		gatherHypConfidences(vfProduct);
+		fNormalizer = SumFloatVector(vfProduct, NULL_HYP_CONFIDENCE);
 		if (fNormalizer > 1 - FREE_PROB_MASS)
 		{
 			// if we're over the limit
+			ScaleFloatVector(vfProduct, (1 - FREE_PROB_MASS) / fNormalizer,
+				NULL_HYP_CONFIDENCE);
 			for (int i = 0; i < (int)vhCurrentHypSet.size(); i++)
 			if (vhCurrentHypSet[i] != NULL)
 				// this will also notify the change
-				SetHypConfidence(i,
-				vhCurrentHypSet[i]->GetConfidence() *
-				(1 - FREE_PROB_MASS) / fNormalizer);
+				SetHypConfidence(i, vfProduct[i]);
 		}
 	}//if (pConcept && pConcept->IsUpdated())
 
@@ -976,12 +1076,14 @@ void CConcept::Update_NPU_UpdateWithConcept(void* pUpdateData)
 			// check if the confirm was bound with a YES or a NO
 			string sAgencyName = FormatString("/_ExplicitConfirm[%s]",
 				GetAgentQualifiedName().c_str());
+			TAgentHandle ahExplConfirmAgency =
+				AgentsRegistry.GetAgentHandle(sAgencyName);
 			CDialogAgent *pdaExplConfirmAgency =
-				((CDialogAgent *)AgentsRegistry[sAgencyName]);
-			string sRequestAgentName = FormatString("/_ExplicitConfirm[%s]/RequestConfirm",
-				GetAgentQualifiedName().c_str());
+				((CDialogAgent *)AgentsRegistry.GetAgent(ahExplConfirmAgency));
 			CDialogAgent *pdaRequestConfirmAgent =
-				((CDialogAgent *)AgentsRegistry[sRequestAgentName]);
+				((CDialogAgent *)AgentsRegistry.GetAgent(
+				AgentsRegistry.GetChildAgentHandle(ahExplConfirmAgency,
+				"RequestConfirm")));
 			CConcept& rConfirmConcept =
 				pdaExplConfirmAgency->C("confirm");
 			bool bYes = rConfirmConcept.IsAvailableAndGrounded() &&
@@ -1186,11 +1288,6 @@ void CConcept::Update_Calista_UpdateWithConcept(void* pUpdateData)
 	TSystemActionOnConcept saocAction =
 		pDMCore->GetSystemActionOnConcept(this);
 
-	// now get the model based on the system action
-	STRING2FLOATVECTOR s2vfModel =
-		pGroundingManager->GetBeliefUpdatingModelForAction(
-		saocAction.sSystemAction);
-
 	// if we are doing a request on this concept or an other type update, 
 	// and we don't have a new value, 
 	if ((!pConcept || !pConcept->IsUpdated()) &&
@@ -1200,12 +1297,13 @@ void CConcept::Update_Calista_UpdateWithConcept(void* pUpdateData)
 		return;
 
 	// now identify the top hypothesis from history
-	int iIndexH_TH = pPrevConcept ? pPrevConcept->GetTopHypIndex() : -1;
+	CConcept* pHistoryConcept = getPrevConcept();
+	int iIndexH_TH = pHistoryConcept ? pHistoryConcept->GetTopHypIndex() : -1;
 	CHyp* phH_TH = NULL;
 	float fConfH_TH = 0;
 	if (iIndexH_TH != -1)
 	{
-		phH_TH = pPrevConcept->GetHyp(iIndexH_TH);
+		phH_TH = pHistoryConcept->GetHyp(iIndexH_TH);
 		fConfH_TH = phH_TH->GetConfidence();
 	}
 
@@ -1252,20 +1350,9 @@ void CConcept::Update_Calista_UpdateWithConcept(void* pUpdateData)
 	// go through each feature of the model and compute the sums
 	pGroundingManager->PrecomputeBeliefUpdatingFeatures(
 		this, pConcept, saocAction.sSystemAction);
-	STRING2FLOATVECTOR::iterator iPtr;
 	string sLogString;
-	for (iPtr = s2vfModel.begin(); iPtr != s2vfModel.end(); iPtr++)
-	{
-		// get the feature value
-		float fFeatureValue =
-			pGroundingManager->GetGroundingFeature(iPtr->first);
-		vfConfs[1] += fFeatureValue * (iPtr->second)[0];
-		vfConfs[2] += fFeatureValue * (iPtr->second)[1];
-		sLogString += FormatString("  %s = %.4f\t%.4f\t%.4f\n",
-			iPtr->first.c_str(), fFeatureValue,
-			fFeatureValue * (iPtr->second)[0],
-			fFeatureValue * (iPtr->second)[1]);
-	}
+	pGroundingManager->ComputeBeliefUpdatingScores(
+		saocAction.sSystemAction, vfConfs[1], vfConfs[2], sLogString);
 	sLogString += FormatString("  [TOTAL] = 1.0\t%.4f\t%.4f\n",
 		vfConfs[1], vfConfs[2]);
 	pGroundingManager->ClearBeliefUpdatingFeatures();
@@ -1532,10 +1619,10 @@ bool CConcept::IsAvailable()
 {
 	if (IsUpdated())
 		return true;
-	if (pPrevConcept)
-		return pPrevConcept->IsAvailable();
-	else
-		return false;
+	for (int i = (int)vpHistory.size() - 1; i >= 0; i--)
+	if (vpHistory[i]->IsAvailable())
+		return true;
+	return false;
 }
 
 // D: returns true if the concept is available and grounded. By default, this 
@@ -1547,10 +1634,10 @@ bool CConcept::IsAvailableAndGrounded()
 {
 	if (IsUpdatedAndGrounded())
 		return true;
-	if (pPrevConcept)
-		return pPrevConcept->IsAvailableAndGrounded();
-	else
-		return false;
+	for (int i = (int)vpHistory.size() - 1; i >= 0; i--)
+	if (vpHistory[i]->IsAvailableAndGrounded())
+		return true;
+	return false;
 }
 
 // D: returns true if the concept is grounded
@@ -1595,7 +1682,11 @@ bool CConcept::IsUndergoingGrounding()
 {
 	// if it has a grounding model
 	if (pGroundingModel)
+	{
+		// (the answer depends on the grounding manager, not on the concept)
+		CDialogAgent::RecordDialogStateDependency();
 		return pGroundingManager->GroundingInProgressOnConcept(this);
+	}
 	else
 		return false;
 }
@@ -1765,8 +1856,8 @@ CDialogAgent* CConcept::GetOwnerDialogAgent()
 void CConcept::SetOwnerConcept(CConcept* pAConcept)
 {
 	pOwnerConcept = pAConcept;
-	if (pPrevConcept)
-		pPrevConcept->SetOwnerConcept(pAConcept);
+	for (unsigned int i = 0; i < vpHistory.size(); i++)
+		vpHistory[i]->SetOwnerConcept(pAConcept);
 }
 
 // D: Access to the owner concept
@@ -1854,22 +1945,27 @@ CGMConcept* CConcept::GetGroundingModel()
 // D: Sets the grounded flag on the concept
 void CConcept::SetGroundedFlag(bool bAGrounded)
 {
+	// grounding a concept restored for grounding also changes the hypset 
+	// and the history
+	journalChange((bAGrounded && bRestoredForGrounding)?
+		(CJ_HYPSET | CJ_HISTORY):0);
 	bGrounded = bAGrounded;
 	// now if the concept was set to grounded and it was restored for grounding
 	if (bGrounded && bRestoredForGrounding)
 	{
 		// check that we indeed have a previous concept 
-		if (!pPrevConcept)
+		CConcept* pHistoryConcept = getPrevConcept();
+		if (!pHistoryConcept)
 			FatalError(FormatString("Concept %s was restored for grounding, "
 			"now it's grounded, but has no history.", GetName().c_str()));
 		// check if the top hypothesis of the previous concept is the same
 		// as the top hypothesis of he current one
-		CHyp* pHTopHyp = pPrevConcept->GetTopHyp();
+		CHyp* pHTopHyp = pHistoryConcept->GetTopHyp();
 		CHyp* pTopHyp = GetTopHyp();
 		if (pHTopHyp && pTopHyp && (*pHTopHyp == *pTopHyp))
 		{
 			// if they are equal, then just copy the current hypset in history
-			pPrevConcept->CopyCurrentHypSetFrom(*this);
+			pHistoryConcept->CopyCurrentHypSetFrom(*this);
 			// and delete the current hypset, but do not notify the change
 			if (bChangeNotification)
 			{
@@ -1933,14 +2029,16 @@ void CConcept::DeclareConcepts(TConceptPointersVector& rcpvConcepts,
 // D: set the invalidated flag
 void CConcept::SetInvalidatedFlag(bool bAInvalidated)
 {
-	// set the flag
+	// set the flag (the history is changed too, if the concept has been 
+	// restored for grounding)
+	journalChange(IsRestoredForGrounding()?CJ_HISTORY:0);
 	bInvalidated = bAInvalidated;
 	// if the concept has been restored for grounding, and how has just been
 	// invalidated, then invalidate the history value
-	if (IsRestoredForGrounding() && pPrevConcept)
+	if (IsRestoredForGrounding() && getPrevConcept())
 	{
 		// set the invalidated flag on the history also
-		pPrevConcept->SetInvalidatedFlag(bAInvalidated);
+		getPrevConcept()->SetInvalidatedFlag(bAInvalidated);
 		// then if the concept is set to invalidated, clear the restored for
 		// grounding flag
 		if (bAInvalidated)
@@ -2029,6 +2127,8 @@ void CConcept::SetChangeNotification(
 // DÿθıʱĴ
 void CConcept::NotifyChange()
 {
+	// the concept version and the merged history view are now out of date
+	markChanged();
 	// set the grounded flag to false
 	SetGroundedFlag(false);
 	// set the invalidated flag to false
@@ -2062,22 +2162,46 @@ CHyp* CConcept::HypFactory()
 // D: adds a hypothesis to the current set of hypotheses
 int CConcept::AddHyp(CHyp* pAHyp)
 {
-	vhCurrentHypSet.push_back(pAHyp);
+	// the hypset is about to change
+	unshareHypSet();
+	// reuse a freed slot if there is one, o/w append
+	int iIndex = acquireFreeHypSlot();
+	if (iIndex == -1)
+	{
+		vhCurrentHypSet.push_back(pAHyp);
+		iIndex = (int)(vhCurrentHypSet.size() - 1);
+	}
+	else
+		vhCurrentHypSet[iIndex] = pAHyp;
+	syncHypSlot(iIndex);
+	bHypValueIndexDirty = true;
 	iNumValidHyps++;
 	// notify the concept change
 	NotifyChange();
-	return (int)(vhCurrentHypSet.size() - 1);
+	return iIndex;
 }
 
 // D: adds a new hypothesis to the current set of hypotheses
 // һHypǰHyp Set
 int CConcept::AddNewHyp()
 {
-	vhCurrentHypSet.push_back(HypFactory());
+	// the hypset is about to change
+	unshareHypSet();
+	// reuse a freed slot if there is one, o/w append
+	int iIndex = acquireFreeHypSlot();
+	if (iIndex == -1)
+	{
+		vhCurrentHypSet.push_back(HypFactory());
+		iIndex = (int)(vhCurrentHypSet.size() - 1);
+	}
+	else
+		vhCurrentHypSet[iIndex] = HypFactory();
+	syncHypSlot(iIndex);
+	bHypValueIndexDirty = true;
 	iNumValidHyps++;
 	// notify the concept change
 	NotifyChange();
-	return (int)(vhCurrentHypSet.size() - 1);
+	return iIndex;
 }
 
 // D: adds a null hypothesis to the current set of hypotheses
@@ -2092,6 +2216,8 @@ int CConcept::AddNullHyp()
 // D: sets a hypothesis into a location
 void CConcept::SetHyp(int iIndex, CHyp* pHyp)
 {
+	// the hypset is about to change
+	unshareHypSet();
 	// first set it to null
 	SetNullHyp(iIndex);
 	// check if pHyp is null, then return
@@ -2100,6 +2226,9 @@ void CConcept::SetHyp(int iIndex, CHyp* pHyp)
 	vhCurrentHypSet[iIndex] = HypFactory();
 	// copy the contents
 	*(vhCurrentHypSet[iIndex]) = *pHyp;
+	// (this also takes the slot off the free list)
+	syncHypSlot(iIndex);
+	bHypValueIndexDirty = true;
 	iNumValidHyps++;
 	// notify the change
 	NotifyChange();
@@ -2110,10 +2239,16 @@ void CConcept::SetNullHyp(int iIndex)
 {
 	// if it's already null, return
 	if (vhCurrentHypSet[iIndex] == NULL) return;
+	// the hypset is about to change
+	unshareHypSet();
 	// o/w delete it
 	delete vhCurrentHypSet[iIndex];
 	// and set it to null
 	vhCurrentHypSet[iIndex] = NULL;
+	syncHypSlot(iIndex);
+	bHypValueIndexDirty = true;
+	// and remember the slot so that it can be reused
+	viFreeHypSlots.push_back(iIndex);
 	iNumValidHyps--;
 	// notify the change
 	NotifyChange();
@@ -2122,6 +2257,8 @@ void CConcept::SetNullHyp(int iIndex)
 // D: deletes a hypothesis at a given location
 void CConcept::DeleteHyp(int iIndex)
 {
+	// the hypset is about to change
+	unshareHypSet();
 	if (vhCurrentHypSet[iIndex] != NULL)
 	{
 		// if it's not null, destroy it
@@ -2130,6 +2267,7 @@ void CConcept::DeleteHyp(int iIndex)
 	}
 	// then delete it from the array
 	vhCurrentHypSet.erase(vhCurrentHypSet.begin() + iIndex);
+	eraseHypSlot(iIndex);
 	// notify the change
 	NotifyChange();
 }
@@ -2149,12 +2287,9 @@ CHyp* CConcept::GetHyp(int iIndex)
 // D: return the index of a given hypothesis
 int CConcept::GetHypIndex(CHyp* pHyp)
 {
-	for (int i = 0; i < (int)vhCurrentHypSet.size(); i++)
-	if ((vhCurrentHypSet[i] != NULL) &&
-		(*pHyp == *(vhCurrentHypSet[i])))
-		return i;
-	// o/w if we reached the end return -1
-	return -1;
+	if (pHyp == NULL) return -1;
+	refreshHypValueIndex();
+	return lookupHypValue(pHyp);
 }
 
 // D: return the confidence of a certain hypothesis (specified by index)
@@ -2172,10 +2307,16 @@ void CConcept::SetHypConfidence(int iIndex, float fConfidence)
 	{
 		if (pHyp->GetConfidence() != fConfidence)
 		{
+			// the hypothesis is about to change
+			unshareHypSet();
+			pHyp = GetHyp(iIndex);
 			pHyp->SetConfidence(fConfidence);
 			// notify the concept change
 			NotifyChange();
 		}
+		// the hyp might have been assigned to directly, so always resync
+		// the top hyps cache
+		syncHypSlot(iIndex);
 	}
 	else
 	{
@@ -2200,50 +2341,23 @@ CHyp* CConcept::GetTopHyp()
 // Dضhyp
 int CConcept::GetTopHypIndex()
 {
+	ulTopHypQueries++;
 	// if no valid hyps, return -1
 	if (iNumValidHyps == 0) return -1;
-	// o/w compute the item with the max confidence
-	float fMaxConfidence = 0;
-	int iSelected = -1;
-	for (int h = 0; h < (int)vhCurrentHypSet.size(); h++)
-	{
-		if (vhCurrentHypSet[h] != NULL)
-		{
-			if (vhCurrentHypSet[h]->GetConfidence() > fMaxConfidence)
-			{
-				fMaxConfidence = vhCurrentHypSet[h]->GetConfidence();
-				iSelected = h;
-			}
-		}
-	}
-	// return the computed one
-	return iSelected;
+	// o/w return the cached one (recomputing it if necessary)
+	if (bTopHypsDirty) recomputeTopHyps();
+	return iCachedTopHypIndex;
 }
 
 // D: return the second best hyp index
 int CConcept::Get2ndHypIndex()
 {
+	ulTopHypQueries++;
 	// if we don't have at least 2 valid hyps, return -1
 	if (iNumValidHyps < 2) return -1;
-
-	// o/w get the top hypothesis index
-	int iTopHypIndex = GetTopHypIndex();
-
-	float fMaxConfidence = 0;
-	int iSelected = -1;
-	for (int h = 0; h < (int)vhCurrentHypSet.size(); h++)
-	{
-		if ((h != iTopHypIndex) && vhCurrentHypSet[h] != NULL)
-		{
-			if (vhCurrentHypSet[h]->GetConfidence() > fMaxConfidence)
-			{
-				fMaxConfidence = vhCurrentHypSet[h]->GetConfidence();
-				iSelected = h;
-			}
-		}
-	}
-	// return the computed one
-	return iSelected;
+	// o/w return the cached one (recomputing it if necessary)
+	if (bTopHypsDirty) recomputeTopHyps();
+	return iCached2ndHypIndex;
 }
 
 // D: return the confidence score of the top hypothesis
@@ -2284,13 +2398,20 @@ void CConcept::ClearCurrentHypSet()
 {
 	// if it's already clear, return
 	if (vhCurrentHypSet.size() == 0) return;
-	// go through all the valconfs and deallocate them
-	for (int h = 0; h < (int)vhCurrentHypSet.size(); h++)
-	{
-		if (vhCurrentHypSet[h] != NULL)
-			delete vhCurrentHypSet[h];
-	}
+	// go through all the valconfs and deallocate them (unless other 
+	// concepts still hold them)
+	if (releaseHypSet())
+		for (int h = 0; h < (int)vhCurrentHypSet.size(); h++)
+		{
+			if (vhCurrentHypSet[h] != NULL)
+				delete vhCurrentHypSet[h];
+		}
 	vhCurrentHypSet.clear();
+	viFreeHypSlots.clear();
+	iCachedTopHypIndex = -1;
+	iCached2ndHypIndex = -1;
+	bTopHypsDirty = false;
+	bHypValueIndexDirty = true;
 	// finally, reset the number of valid hypotheses
 	iNumValidHyps = 0;
 	// and notify the change
@@ -2302,7 +2423,21 @@ void CConcept::CopyCurrentHypSetFrom(CConcept& rAConcept)
 {
 	// first clear it
 	ClearCurrentHypSet();
-	// then go through all the hypotheses from the source concept
+	// atomic concepts of the same type simply share the hypotheses; they
+	// are copied only when one of the concepts changes them
+	if ((rAConcept.ctConceptType == ctConceptType) &&
+		((ctConceptType == ctInt) || (ctConceptType == ctBool) ||
+		(ctConceptType == ctString) || (ctConceptType == ctFloat)))
+	{
+		shareHypSetFrom(rAConcept);
+		// copy the explicitly confirmed and disconfirmed hyps
+		sExplicitlyConfirmedHyp = 
+			rAConcept.GetExplicitlyConfirmedHypAsString();
+		sExplicitlyDisconfirmedHyp = 
+			rAConcept.GetExplicitlyDisconfirmedHypAsString();
+		return;
+	}
+	// o/w go through all the hypotheses from the source concept
 	for (int h = 0; h < rAConcept.GetNumHyps(); h++)
 	{
 		CHyp* pHyp;
@@ -2311,6 +2446,7 @@ void CConcept::CopyCurrentHypSetFrom(CConcept& rAConcept)
 			// this will notify the change
 			AddNewHyp();
 			*(vhCurrentHypSet[h]) = *pHyp;
+			syncHypSlot(h);
 		}
 		else
 		{
@@ -2324,6 +2460,308 @@ void CConcept::CopyCurrentHypSetFrom(CConcept& rAConcept)
 	sExplicitlyDisconfirmedHyp = rAConcept.GetExplicitlyDisconfirmedHypAsString();
 }
 
+// M: sets whether freed hypothesis slots are reused
+void CConcept::SetCompactHypStorage(bool bACompactHypStorage)
+{
+	bCompactHypStorage = bACompactHypStorage;
+}
+
+// M: returns whether freed hypothesis slots are reused
+bool CConcept::GetCompactHypStorage()
+{
+	return bCompactHypStorage;
+}
+
+// M: maintains the free slots and the top hyps cache after the hypothesis 
+//    in a slot, or its confidence, changed (the confidence itself is only
+//    stored in the hypothesis)
+void CConcept::syncHypSlot(int iIndex)
+{
+	if ((iIndex < 0) || (iIndex >= (int)vhCurrentHypSet.size()))
+		return;
+	// a slot that holds a hypothesis is no longer free
+	if (vhCurrentHypSet[iIndex] != NULL)
+		for (int i = (int)viFreeHypSlots.size() - 1; i >= 0; i--)
+		if (viFreeHypSlots[i] == iIndex)
+			viFreeHypSlots.erase(viFreeHypSlots.begin() + i);
+	// and maintain the top hyps cache
+	updateTopHyps(iIndex);
+}
+
+// M: resets the free slots and the top hyps cache for the whole hypset 
+//    (used after the hypset was constructed directly)
+void CConcept::syncHypSlots()
+{
+	viFreeHypSlots.clear();
+	bTopHypsDirty = true;
+	bHypValueIndexDirty = true;
+}
+
+// M: shifts the free slots that followed an erased slot, and the cached
+//    top hyp indices
+void CConcept::eraseHypSlot(int iIndex)
+{
+	bHypValueIndexDirty = true;
+	for (int i = (int)viFreeHypSlots.size() - 1; i >= 0; i--)
+	{
+		if (viFreeHypSlots[i] == iIndex)
+			viFreeHypSlots.erase(viFreeHypSlots.begin() + i);
+		else if (viFreeHypSlots[i] > iIndex)
+			viFreeHypSlots[i]--;
+	}
+	// erasing the top or second hyp requires a sweep, o/w the cached 
+	// indices simply shift
+	if (bTopHypsDirty) return;
+	if ((iIndex == iCachedTopHypIndex) || (iIndex == iCached2ndHypIndex))
+	{
+		bTopHypsDirty = true;
+		return;
+	}
+	if (iCachedTopHypIndex > iIndex) iCachedTopHypIndex--;
+	if (iCached2ndHypIndex > iIndex) iCached2ndHypIndex--;
+}
+
+// M: returns a freed slot that can hold a new hypothesis, or -1. Slots 
+//    are not reused on structures and their items, since those keep 
+//    hypotheses aligned by index
+int CConcept::acquireFreeHypSlot()
+{
+	if (!bCompactHypStorage || viFreeHypSlots.empty() ||
+		(ctConceptType == ctStruct) ||
+		(pOwnerConcept && (pOwnerConcept->GetConceptType() == ctStruct)))
+		return -1;
+	int iIndex = viFreeHypSlots.back();
+	viFreeHypSlots.pop_back();
+	return iIndex;
+}
+
+// M: shares the hypotheses of another concept (the current hypset is 
+//    assumed to be clear). The hypotheses are not copied: both concepts 
+//    hold the same hypotheses, and a shared reference count, until one of
+//    them changes its hypset (see unshareHypSet)
+void CConcept::shareHypSetFrom(CConcept& rAConcept)
+{
+	if (rAConcept.vhCurrentHypSet.size() == 0) return;
+	// start counting the references on the source, if not already shared
+	if (rAConcept.piHypSetRefCount == NULL)
+		rAConcept.piHypSetRefCount = new int(1);
+	piHypSetRefCount = rAConcept.piHypSetRefCount;
+	(*piHypSetRefCount)++;
+	// copy the hyp pointers, and the storage that goes with them
+	vhCurrentHypSet = rAConcept.vhCurrentHypSet;
+	viFreeHypSlots = rAConcept.viFreeHypSlots;
+	iNumValidHyps = rAConcept.iNumValidHyps;
+	iCachedTopHypIndex = rAConcept.iCachedTopHypIndex;
+	iCached2ndHypIndex = rAConcept.iCached2ndHypIndex;
+	bTopHypsDirty = rAConcept.bTopHypsDirty;
+	bHypValueIndexDirty = true;
+	// and notify the change
+	NotifyChange();
+}
+
+// M: makes private copies of the hypotheses, if they are shared with other
+//    concepts; called before the hypset (or one of its hypotheses) is 
+//    changed. The copies have the same values and confidences, so the rest
+//    of the hypset storage stays valid
+void CConcept::unshareHypSet()
+{
+	if (piHypSetRefCount == NULL) return;
+	if (*piHypSetRefCount > 1)
+	{
+		(*piHypSetRefCount)--;
+		for (unsigned int h = 0; h < vhCurrentHypSet.size(); h++)
+		if (vhCurrentHypSet[h] != NULL)
+		{
+			CHyp* pHyp = HypFactory();
+			*pHyp = *(vhCurrentHypSet[h]);
+			vhCurrentHypSet[h] = pHyp;
+		}
+	}
+	else
+		delete piHypSetRefCount;
+	piHypSetRefCount = NULL;
+}
+
+// M: drops the reference to the hypotheses; returns true if the concept
+//    was the last one holding them (and should therefore delete them)
+bool CConcept::releaseHypSet()
+{
+	if (piHypSetRefCount == NULL) return true;
+	bool bLastReference = (--(*piHypSetRefCount) == 0);
+	if (bLastReference)
+		delete piHypSetRefCount;
+	piHypSetRefCount = NULL;
+	return bLastReference;
+}
+
+// M: maintains the cached top and second hyp indices after the confidence
+//    of a slot changed. A slot that moves into the top two is handled in 
+//    place, as is a top hyp that stays above the second one; any other 
+//    change of the top or second hyp marks the cache dirty
+void CConcept::updateTopHyps(int iIndex)
+{
+	if (bTopHypsDirty) return;
+	if (iIndex == iCachedTopHypIndex)
+	{
+		if (!ranksAbove(iIndex, iCached2ndHypIndex))
+			bTopHypsDirty = true;
+		return;
+	}
+	if (iIndex == iCached2ndHypIndex)
+	{
+		if (ranksAbove(iIndex, iCachedTopHypIndex))
+		{
+			iCached2ndHypIndex = iCachedTopHypIndex;
+			iCachedTopHypIndex = iIndex;
+		}
+		else
+			bTopHypsDirty = true;
+		return;
+	}
+	if (ranksAbove(iIndex, iCachedTopHypIndex))
+	{
+		iCached2ndHypIndex = iCachedTopHypIndex;
+		iCachedTopHypIndex = iIndex;
+	}
+	else if ((iIndex != iCached2ndHypIndex) &&
+		ranksAbove(iIndex, iCached2ndHypIndex))
+	{
+		iCached2ndHypIndex = iIndex;
+	}
+}
+
+// M: recomputes the top and second hyp indices with one sweep over the 
+//    hyp slots (on ties, the lowest index wins; null slots and zero 
+//    confidence hyps are never selected)
+void CConcept::recomputeTopHyps()
+{
+	ulTopHypSweeps++;
+	float fTopConfidence = 0;
+	float f2ndConfidence = 0;
+	iCachedTopHypIndex = -1;
+	iCached2ndHypIndex = -1;
+	int iNumSlots = (int)vhCurrentHypSet.size();
+	for (int h = 0; h < iNumSlots; h++)
+	{
+		float fConfidence = getHypSlotConfidence(h);
+		if (fConfidence > fTopConfidence)
+		{
+			iCached2ndHypIndex = iCachedTopHypIndex;
+			f2ndConfidence = fTopConfidence;
+			iCachedTopHypIndex = h;
+			fTopConfidence = fConfidence;
+		}
+		else if (fConfidence > f2ndConfidence)
+		{
+			iCached2ndHypIndex = h;
+			f2ndConfidence = fConfidence;
+		}
+	}
+	bTopHypsDirty = false;
+}
+
+// M: checks if a hyp ranks above another one in the top hyps order (an 
+//    index of -1 stands for "no hyp", which any positive confidence beats)
+bool CConcept::ranksAbove(int iIndex, int iOtherIndex)
+{
+	float fConfidence = getHypSlotConfidence(iIndex);
+	if (iOtherIndex == -1)
+		return fConfidence > 0;
+	float fOtherConfidence = getHypSlotConfidence(iOtherIndex);
+	return (fConfidence > fOtherConfidence) ||
+		((fConfidence == fOtherConfidence) && (iIndex < iOtherIndex));
+}
+
+// M: returns the confidence of a slot (NULL_HYP_CONFIDENCE for null slots)
+float CConcept::getHypSlotConfidence(int iIndex)
+{
+	CHyp* pHyp = vhCurrentHypSet[iIndex];
+	return pHyp ? pHyp->GetConfidence() : NULL_HYP_CONFIDENCE;
+}
+
+// M: copies the confidences of all the slots into a vector (one entry per
+//    slot, NULL_HYP_CONFIDENCE for null slots), for the vector kernels
+void CConcept::gatherHypConfidences(
+	vector<float, allocator<float> >& rvfConfidences)
+{
+	int iNumSlots = (int)vhCurrentHypSet.size();
+	rvfConfidences.resize(iNumSlots);
+	for (int h = 0; h < iNumSlots; h++)
+		rvfConfidences[h] = getHypSlotConfidence(h);
+}
+
+// M: (re)builds the value hash index over the current hypset, if the 
+//    hypset changed since it was last built. Structure hyps take their
+//    values from the items, which can change independently, so the index
+//    is always rebuilt for structures
+void CConcept::refreshHypValueIndex()
+{
+	if (!bHypValueIndexDirty && (ctConceptType != ctStruct))
+		return;
+	int iNumSlots = (int)vhCurrentHypSet.size();
+	vuiHypValueHashes.resize(iNumSlots);
+	// size the table so that it's at most half full
+	int iTableSize = 8;
+	while (iTableSize < 2 * iNumSlots)
+		iTableSize <<= 1;
+	viHypValueIndex.assign(iTableSize, -1);
+	// insert the slots in increasing order, so that probing finds the 
+	// first matching slot first
+	for (int h = 0; h < iNumSlots; h++)
+	{
+		if (vhCurrentHypSet[h] == NULL)
+			continue;
+		unsigned int uiHash = vhCurrentHypSet[h]->ValueHash();
+		vuiHypValueHashes[h] = uiHash;
+		int iPos = (int)(uiHash & (iTableSize - 1));
+		while (viHypValueIndex[iPos] != -1)
+			iPos = (iPos + 1) & (iTableSize - 1);
+		viHypValueIndex[iPos] = h;
+	}
+	bHypValueIndexDirty = false;
+}
+
+// M: looks up a hyp by value in the value hash index (as it was last 
+//    built), and returns the index of the first slot that holds an equal
+//    value, or -1
+int CConcept::lookupHypValue(CHyp* pHyp)
+{
+	int iTableSize = (int)viHypValueIndex.size();
+	if (iTableSize == 0)
+		return -1;
+	unsigned int uiHash = pHyp->ValueHash();
+	int iPos = (int)(uiHash & (iTableSize - 1));
+	while (viHypValueIndex[iPos] != -1)
+	{
+		int h = viHypValueIndex[iPos];
+		if ((vuiHypValueHashes[h] == uiHash) && (vhCurrentHypSet[h] != NULL) &&
+			(*pHyp == *(vhCurrentHypSet[h])))
+			return h;
+		iPos = (iPos + 1) & (iTableSize - 1);
+	}
+	return -1;
+}
+
+// M: returns the number of top/second hyp index queries
+unsigned long CConcept::GetTopHypQueries()
+{
+	return ulTopHypQueries;
+}
+
+// M: returns the number of top/second hyp index queries that required a
+//    full sweep of the hypset
+unsigned long CConcept::GetTopHypSweeps()
+{
+	return ulTopHypSweeps;
+}
+
+// M: resets the top/second hyp index query counters
+void CConcept::ResetTopHypCounters()
+{
+	ulTopHypQueries = 0;
+	ulTopHypSweeps = 0;
+}
+
 // D: sets the cardinality of the hypset
 void CConcept::SetCardinality(int iACardinality)
 {
@@ -2387,6 +2825,7 @@ void CConcept::SetExplicitlyConfirmedHyp(CHyp* pHyp)
 // D: alternate function for settting the explicitly confirmed hyp
 void CConcept::SetExplicitlyConfirmedHyp(string sAExplicitlyConfirmedHyp)
 {
+	journalChange(0);
 	sExplicitlyConfirmedHyp = sAExplicitlyConfirmedHyp;
 }
 
@@ -2399,6 +2838,7 @@ void CConcept::SetExplicitlyDisconfirmedHyp(CHyp* pHyp)
 // D: alternate function for settting the explicitly disconfirmed hyp
 void CConcept::SetExplicitlyDisconfirmedHyp(string sAExplicitlyDisconfirmedHyp)
 {
+	journalChange(0);
 	sExplicitlyDisconfirmedHyp = sAExplicitlyDisconfirmedHyp;
 }
 
@@ -2417,13 +2857,15 @@ string CConcept::GetExplicitlyDisconfirmedHypAsString()
 // D: clears the explicitly confirmed hyp
 void CConcept::ClearExplicitlyConfirmedHyp()
 {
+	journalChange(0);
 	sExplicitlyConfirmedHyp = "";
 }
 
 // D: clears the explicitly confirmed hyp
 void CConcept::ClearExplicitlyDisconfirmedHyp()
 {
-	sExplicitlyConfirmedHyp = "";
+	journalChange(0);
+	sExplicitlyDisconfirmedHyp = "";
 }
 
 //---------------------------------------------------------------------
@@ -2603,6 +3045,18 @@ void CConcept::ClearWaitingConveyance()
 	}
 }
 
+// M: sets the waiting for conveyance flag when restoring a saved state, and
+//    renews the notification requests the outputs hold for the concept 
+//    (cancelled when the flag was cleared)
+void CConcept::restoreWaitingConveyance()
+{
+	if (bWaitingConveyance)
+		return;
+	SetWaitingConveyance();
+	if (pOutputManager)
+		pOutputManager->RenewConceptNotificationRequest(this);
+}
+
 // A: set the conveyance information
 void CConcept::SetConveyance(TConveyance cAConveyance)
 {
@@ -2638,10 +3092,13 @@ void CConcept::ReOpen()
 		FatalError(FormatString("Cannot perform ReOpen on concept (%s) history.",
 		sName.c_str()));
 
+	// record the concept in the journal
+	journalChange(CJ_HYPSET | CJ_HISTORY);
+
 	// record the initial value of the concept (if the concept has a grounding model)
 	//¼ĳʼֵһӵģͣ
 	string sInitialValue;
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		sInitialValue = TrimRight(HypSetToString());
 
 	// create a clone of the current concept (without the history)
@@ -2649,16 +3106,13 @@ void CConcept::ReOpen()
 
 	// collapse it to the mode (this also sets it to grounded)
 	// ۵ģʽҲΪӵأ
-	pConcept->Update(CU_COLLAPSE_TO_MODE, NULL);
+	pConcept->Update(cuCollapseToMode, NULL);
 
 	// set the flag on it that it's a history concept
 	pConcept->SetHistoryConcept(true);
 
-	// links it to the current history
-	pConcept->pPrevConcept = pPrevConcept;
-
 	// and push it into the history
-	pPrevConcept = pConcept;
+	pushHistoryVersion(pConcept);
 
 	// finally, clear the current value (which notifies the change)
 	// finallyǰֵ֪ͨģ
@@ -2666,7 +3120,7 @@ void CConcept::ReOpen()
 
 	// now log the update (if the concept has a grounding model
 	// ڼ¼£һӵģ
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		Log(CONCEPT_STREAM, FormatString(
 		"Concept update [reopen] on %s:\nInitial value dumped below:\n%s\n"
 		"Updated value dumped below:\n%s",
@@ -2686,10 +3140,13 @@ void CConcept::Restore(int iIndex)
 		FatalError(FormatString("Cannot perform Restore on concept (%s) history.",
 		sName.c_str()));
 
+	// record the concept in the journal
+	journalChange(CJ_HYPSET | CJ_HISTORY);
+
 	// record the initial value of the concept (if the concept has a grounding
 	//  model)
 	string sInitialValue;
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		sInitialValue = TrimRight(HypSetToString());
 
 	// check that the index is not zero 
@@ -2708,7 +3165,7 @@ void CConcept::Restore(int iIndex)
 	ClearHistory();
 
 	// now log the update (if the concept has a grounding model)
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		Log(CONCEPT_STREAM, FormatString(
 		"Concept update [restore] on %s:\nInitial value dumped below:\n%s\n"
 		"Updated value dumped below:\n%s",
@@ -2725,12 +3182,11 @@ void CConcept::ClearHistory()
 		FatalError(FormatString("Cannot perform ClearHistory on concept (%s) history.",
 		sName.c_str()));
 
+	// record the concept in the journal
+	journalChange(CJ_HISTORY);
+
 	// o/w merely delete all its history
-	if (pPrevConcept != NULL)
-	{
-		delete pPrevConcept;
-		pPrevConcept = NULL;
-	}
+	freeHistory();
 }
 
 // D: merges the history on the concept, and returns a new concept containing  that 
@@ -2754,29 +3210,48 @@ CConcept* CConcept::CreateMergedHistoryConcept()
 	else
 	{
 
-		// o/w check for a previous concept
-		if (pPrevConcept == NULL)
+		// o/w go back through the history versions, and return the merged
+		// history of the most recent one which has a value
+		for (int i = (int)vpHistory.size() - 1; i >= 0; i--)
 		{
-			// and if there's no history then just return NULL
-			return NULL;
-		}
-		else
-		{
-			// o/w defer to previous concept in history
-			return pPrevConcept->CreateMergedHistoryConcept();
+			CConcept* pMergedHistory = vpHistory[i]->CreateMergedHistoryConcept();
+			if (pMergedHistory)
+				return pMergedHistory;
 		}
+		// and if there's no history then just return NULL
+		return NULL;
 	}
 }
 
+// M: returns the merged history view of the concept. The view is cached, 
+//    so repeated accesses (i.e. @concept in prompts and preconditions) do 
+//    not clone the concept again until it changes
+CConcept& CConcept::GetMergedHistoryConcept()
+{
+	if (bMergedHistoryCacheDirty)
+	{
+		if (pMergedHistoryCache != NULL)
+			delete pMergedHistoryCache;
+		pMergedHistoryCache = CreateMergedHistoryConcept();
+		bMergedHistoryCacheDirty = false;
+	}
+
+	if (pMergedHistoryCache == NULL)
+		return NULLConcept;
+	return *pMergedHistoryCache;
+}
+
 // D: merges the history of the concept into the current value
 // Dʷϲǰֵ
 void CConcept::MergeHistory()
 {
+	// record the concept in the journal
+	journalChange(CJ_HYPSET | CJ_HISTORY);
 
 	// record the initial value of the concept (if the concept has a grounding model)
 	// ¼ĳʼֵһӵģͣ
 	string sInitialValue;
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		sInitialValue = TrimRight(HypSetToString());
 
 	// if the concept is updated or is invalidated, then we just clear it's history
@@ -2812,7 +3287,7 @@ void CConcept::MergeHistory()
 	}
 
 	// now log the update (if the concept has a grounding model)
-	if (pGroundingModel)
+	if (isUpdateLogged())
 		Log(CONCEPT_STREAM, FormatString(
 		"Concept update [merge_history] on %s:\nInitial value dumped below:\n%s\n"
 		"Updated value dumped below:\n%s",
@@ -2824,11 +3299,7 @@ void CConcept::MergeHistory()
 // D: returns the size of the history on the concept
 int CConcept::GetHistorySize()
 {
-	// recursively compute history size
-	if (pPrevConcept == NULL)
-		return 0;
-	else
-		return pPrevConcept->GetHistorySize() + 1;
+	return (int)vpHistory.size();
 }
 
 // D: returns a certain historical version of a concept
@@ -2851,6 +3322,385 @@ bool CConcept::IsHistoryConcept()
 	return bHistoryConcept;
 }
 
+// M: returns the most recent history version, or NULL if there's no history
+CConcept* CConcept::getPrevConcept()
+{
+	if (vpHistory.empty())
+		return NULL;
+	return vpHistory.back();
+}
+
+// M: returns the history version at a given (negative) index, or NULL if
+//    the index is out of the bounds of the history
+CConcept* CConcept::historyVersionAt(int iIndex)
+{
+	int iPosition = (int)vpHistory.size() + iIndex;
+	if ((iIndex >= 0) || (iPosition < 0))
+		return NULL;
+	return vpHistory[iPosition];
+}
+
+// M: appends a version to the history (the concept takes ownership of it)
+void CConcept::pushHistoryVersion(CConcept* pConcept)
+{
+	vpHistory.push_back(pConcept);
+	markChanged();
+}
+
+// M: fills in the history of a clone with clones of the history versions
+void CConcept::cloneHistoryInto(CConcept* pConcept)
+{
+	pConcept->freeHistory();
+	pConcept->vpHistory.reserve(vpHistory.size());
+	for (unsigned int i = 0; i < vpHistory.size(); i++)
+		pConcept->vpHistory.push_back(vpHistory[i]->Clone(false));
+}
+
+// M: deletes all the history versions in one pass
+void CConcept::freeHistory()
+{
+	for (unsigned int i = 0; i < vpHistory.size(); i++)
+		delete vpHistory[i];
+	vpHistory.clear();
+	markChanged();
+}
+
+// M: marks the concept as changed: increments the version and marks the 
+//    merged history view as out of date. The view is not deleted here, since
+//    the result of an earlier access might still be in use; it is rebuilt on
+//    the next access. The owner concepts are marked too, as their state 
+//    includes this concept
+void CConcept::markChanged()
+{
+	for (CConcept* pConcept = this; pConcept != NULL; 
+		pConcept = pConcept->pOwnerConcept)
+	{
+		pConcept->iVersion++;
+		pConcept->bMergedHistoryCacheDirty = true;
+	}
+}
+
+// M: returns the version of the concept
+int CConcept::GetVersion()
+{
+	return iVersion;
+}
+
+//-----------------------------------------------------------------------------
+// Methods implementing the binary encoding
+//-----------------------------------------------------------------------------
+
+// M: encodes the concept in the binary format: the header (magic number and
+//    version), followed by the concept state
+void CConcept::ToBinary(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteUInt32(CONCEPT_BINARY_MAGIC);
+	rbwWriter.WriteUInt8(CONCEPT_BINARY_VERSION);
+	WriteBinaryState(rbwWriter);
+}
+
+// M: restores the concept from the binary format. The change is not 
+//    notified, since that would reset the grounding state just decoded
+void CConcept::FromBinary(CBinaryReader& rbrReader)
+{
+	// check the header
+	unsigned int uiMagic = rbrReader.ReadUInt32();
+	int iVersion = rbrReader.ReadUInt8();
+	if ((uiMagic != CONCEPT_BINARY_MAGIC) || 
+		(iVersion != CONCEPT_BINARY_VERSION))
+	{
+		FatalError(FormatString(
+			"Cannot restore concept %s from binary: unknown format (version "
+			"%d, expected %d).", sName.c_str(), iVersion, 
+			CONCEPT_BINARY_VERSION));
+		return;
+	}
+
+	// record the concept in the journal
+	journalChange(CJ_HYPSET);
+
+	// restore the state, without notifying the intermediate changes
+	bool bAChangeNotification = bChangeNotification;
+	SetChangeNotification(false);
+	ReadBinaryState(rbrReader);
+	SetChangeNotification(bAChangeNotification);
+
+	if (rbrReader.Failed())
+		FatalError(FormatString(
+		"Cannot restore concept %s from binary: the data is truncated.",
+		sName.c_str()));
+}
+
+// M: writes the concept state: type, flags, conveyance, explicitly 
+//    (dis)confirmed hyps, the current hypset and the history versions
+void CConcept::WriteBinaryState(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteUInt8((unsigned char)ctConceptType);
+	unsigned char ucFlags = 0;
+	if (bGrounded) ucFlags |= CBF_GROUNDED;
+	if (bInvalidated) ucFlags |= CBF_INVALIDATED;
+	if (bRestoredForGrounding) ucFlags |= CBF_RESTORED_FOR_GROUNDING;
+	if (bSealed) ucFlags |= CBF_SEALED;
+	if (bHistoryConcept) ucFlags |= CBF_HISTORY_CONCEPT;
+	if (bWaitingConveyance) ucFlags |= CBF_WAITING_CONVEYANCE;
+	rbwWriter.WriteUInt8(ucFlags);
+	rbwWriter.WriteInt32(iTurnLastUpdated);
+	rbwWriter.WriteUInt8((unsigned char)cConveyance);
+	rbwWriter.WriteString(sExplicitlyConfirmedHyp);
+	rbwWriter.WriteString(sExplicitlyDisconfirmedHyp);
+
+	// the current hypset
+	writeBinaryHypSet(rbwWriter);
+
+	// and the history versions, from the oldest to the most recent one
+	rbwWriter.WriteUInt32((unsigned int)vpHistory.size());
+	for (unsigned int i = 0; i < vpHistory.size(); i++)
+		vpHistory[i]->WriteBinaryState(rbwWriter);
+}
+
+// M: reads the concept state. The hypset and the history are restored 
+//    first, since changing the hypset notifies the change, which resets the
+//    grounding flags and the conveyance; the decoded flags are set last
+void CConcept::ReadBinaryState(CBinaryReader& rbrReader)
+{
+	// check the type
+	int iType = rbrReader.ReadUInt8();
+	if (iType != (int)ctConceptType)
+	{
+		FatalError(FormatString(
+			"Cannot restore concept %s (%s type) from binary: the encoded "
+			"concept has a different type (%d).", sName.c_str(), 
+			ConceptTypeAsString[ctConceptType].c_str(), iType));
+		return;
+	}
+
+	unsigned char ucFlags = rbrReader.ReadUInt8();
+	int iATurnLastUpdated = rbrReader.ReadInt32();
+	TConveyance cAConveyance = (TConveyance)rbrReader.ReadUInt8();
+	string sAExplicitlyConfirmedHyp = rbrReader.ReadString();
+	string sAExplicitlyDisconfirmedHyp = rbrReader.ReadString();
+
+	// the current hypset
+	readBinaryHypSet(rbrReader);
+
+	// and the history versions (set up like the clones that ReOpen pushes
+	// into the history)
+	freeHistory();
+	int iHistorySize = (int)rbrReader.ReadUInt32();
+	for (int i = 0; (i < iHistorySize) && !rbrReader.Failed(); i++)
+	{
+		CConcept* pVersion = EmptyClone();
+		pVersion->SetConceptType(ctConceptType);
+		pVersion->SetConceptSource(csConceptSource);
+		pVersion->sName = sName;
+		pVersion->pOwnerDialogAgent = pOwnerDialogAgent;
+		pVersion->SetOwnerConcept(pOwnerConcept);
+		pVersion->DisableChangeNotification();
+		pVersion->ReadBinaryState(rbrReader);
+		pushHistoryVersion(pVersion);
+	}
+
+	// now set the decoded flags
+	bGrounded = (ucFlags & CBF_GROUNDED) != 0;
+	bInvalidated = (ucFlags & CBF_INVALIDATED) != 0;
+	bRestoredForGrounding = (ucFlags & CBF_RESTORED_FOR_GROUNDING) != 0;
+	bSealed = (ucFlags & CBF_SEALED) != 0;
+	bHistoryConcept = (ucFlags & CBF_HISTORY_CONCEPT) != 0;
+	iTurnLastUpdated = iATurnLastUpdated;
+	cConveyance = cAConveyance;
+	sExplicitlyConfirmedHyp = sAExplicitlyConfirmedHyp;
+	sExplicitlyDisconfirmedHyp = sAExplicitlyDisconfirmedHyp;
+	if (ucFlags & CBF_WAITING_CONVEYANCE)
+		restoreWaitingConveyance();
+	else
+		ClearWaitingConveyance();
+}
+
+// M: writes the current hypset: the number of slots, and for each slot 
+//    whether it holds a hypothesis, its confidence and its value
+void CConcept::writeBinaryHypSet(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteUInt32((unsigned int)vhCurrentHypSet.size());
+	for (unsigned int i = 0; i < vhCurrentHypSet.size(); i++)
+	{
+		if (vhCurrentHypSet[i] == NULL)
+		{
+			rbwWriter.WriteUInt8(0);
+			continue;
+		}
+		rbwWriter.WriteUInt8(1);
+		rbwWriter.WriteFloat(vhCurrentHypSet[i]->GetConfidence());
+		vhCurrentHypSet[i]->WriteValueBinary(rbwWriter);
+	}
+}
+
+// M: reads the current hypset (the slots keep their positions)
+void CConcept::readBinaryHypSet(CBinaryReader& rbrReader)
+{
+	ClearCurrentHypSet();
+	int iNumSlots = (int)rbrReader.ReadUInt32();
+	for (int i = 0; (i < iNumSlots) && !rbrReader.Failed(); i++)
+	{
+		if (rbrReader.ReadUInt8() == 0)
+		{
+			AddNullHyp();
+			continue;
+		}
+		float fConfidence = rbrReader.ReadFloat();
+		CHyp* pHyp = HypFactory();
+		pHyp->ReadValueBinary(rbrReader);
+		pHyp->SetConfidence(fConfidence);
+		AddHyp(pHyp);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Memory accounting
+//-----------------------------------------------------------------------------
+
+// M: accounts the memory held by the concept (under sComponent), by its
+//    grounding model, and by its history versions and merged history view 
+//    (under MA_CONCEPT_HISTORY). The hypotheses are not included, since all
+//    of them are accounted for through their pools
+void CConcept::AccountMemoryUsage(TMemoryAccount& rmaAccount,
+	const string& sComponent)
+{
+	int iBytes = sizeof(CConcept) + StringHeapBytes(sName) +
+		StringHeapBytes(sExplicitlyConfirmedHyp) +
+		StringHeapBytes(sExplicitlyDisconfirmedHyp) +
+		(int)(vhCurrentHypSet.capacity() * sizeof(CHyp*)) +
+		(int)(viFreeHypSlots.capacity() * sizeof(int)) +
+		(int)(vuiHypValueHashes.capacity() * sizeof(unsigned int)) +
+		(int)(viHypValueIndex.capacity() * sizeof(int)) +
+		(int)(vhPartialHypSet.capacity() * sizeof(CHyp*)) +
+		(int)(vpHistory.capacity() * sizeof(CConcept*));
+	AccountMemory(rmaAccount, sComponent, 1, iBytes);
+
+	if (pGroundingModel)
+		pGroundingModel->AccountMemoryUsage(rmaAccount);
+
+	for (unsigned int i = 0; i < vpHistory.size(); i++)
+		vpHistory[i]->AccountMemoryUsage(rmaAccount, MA_CONCEPT_HISTORY);
+	if (pMergedHistoryCache)
+		pMergedHistoryCache->AccountMemoryUsage(rmaAccount, 
+		MA_CONCEPT_HISTORY);
+}
+
+//-----------------------------------------------------------------------------
+// Methods supporting the dialog state journal
+//-----------------------------------------------------------------------------
+
+// M: creates a snapshot of the concept for the dialog state journal. The 
+//    flags, the conveyance information and the explicitly (dis)confirmed 
+//    hyps are always recorded; the hypset (a clone without history, which 
+//    shares the hypset of atomic concepts) and the history versions only 
+//    when requested through iParts
+TConceptJournalSnapshot* CConcept::CreateJournalSnapshot(int iParts)
+{
+	TConceptJournalSnapshot* pSnapshot = new TConceptJournalSnapshot;
+	pSnapshot->iParts = iParts;
+	pSnapshot->bGrounded = bGrounded;
+	pSnapshot->bInvalidated = bInvalidated;
+	pSnapshot->bRestoredForGrounding = bRestoredForGrounding;
+	pSnapshot->bSealed = bSealed;
+	pSnapshot->bWaitingConveyance = bWaitingConveyance;
+	pSnapshot->iTurnLastUpdated = iTurnLastUpdated;
+	pSnapshot->cConveyance = cConveyance;
+	pSnapshot->sExplicitlyConfirmedHyp = sExplicitlyConfirmedHyp;
+	pSnapshot->sExplicitlyDisconfirmedHyp = sExplicitlyDisconfirmedHyp;
+	pSnapshot->pHypSetCopy = (iParts & CJ_HYPSET)?Clone(false):NULL;
+	if (iParts & CJ_HISTORY)
+	{
+		pSnapshot->vpHistory.reserve(vpHistory.size());
+		for (unsigned int i = 0; i < vpHistory.size(); i++)
+			pSnapshot->vpHistory.push_back(vpHistory[i]->Clone(false));
+	}
+	return pSnapshot;
+}
+
+// M: restores the concept from a journal snapshot. The change is not 
+//    notified (we are going back to a state the dialog manager has already 
+//    been in), and the history versions of the snapshot are moved into the 
+//    concept. The flags are restored last, since restoring the hypset resets
+//    them
+void CConcept::RestoreFromJournalSnapshot(TConceptJournalSnapshot* pSnapshot)
+{
+	// restore the current hypset, without notifying the change (the
+	// restored for grounding flag is cleared first, so that resetting the 
+	// flags doesn't touch the history)
+	if (pSnapshot->iParts & CJ_HYPSET)
+	{
+		bool bAChangeNotification = bChangeNotification;
+		SetChangeNotification(false);
+		bRestoredForGrounding = false;
+		CopyCurrentHypSetFrom(*(pSnapshot->pHypSetCopy));
+		SetChangeNotification(bAChangeNotification);
+	}
+
+	// swap in the history
+	if (pSnapshot->iParts & CJ_HISTORY)
+	{
+		freeHistory();
+		vpHistory.swap(pSnapshot->vpHistory);
+	}
+
+	// restore the flags (directly, since the setters have side effects)
+	bGrounded = pSnapshot->bGrounded;
+	bInvalidated = pSnapshot->bInvalidated;
+	bRestoredForGrounding = pSnapshot->bRestoredForGrounding;
+	bSealed = pSnapshot->bSealed;
+	iTurnLastUpdated = pSnapshot->iTurnLastUpdated;
+	cConveyance = pSnapshot->cConveyance;
+	sExplicitlyConfirmedHyp = pSnapshot->sExplicitlyConfirmedHyp;
+	sExplicitlyDisconfirmedHyp = pSnapshot->sExplicitlyDisconfirmedHyp;
+
+	// and the conveyance notification request
+	if (pSnapshot->bWaitingConveyance)
+		restoreWaitingConveyance();
+	else
+		ClearWaitingConveyance();
+	markChanged();
+}
+
+// M: deletes a journal snapshot, together with the copies it holds
+void CConcept::DeleteJournalSnapshot(TConceptJournalSnapshot* pSnapshot)
+{
+	if (pSnapshot->pHypSetCopy)
+		delete pSnapshot->pHypSetCopy;
+	for (unsigned int i = 0; i < pSnapshot->vpHistory.size(); i++)
+		delete pSnapshot->vpHistory[i];
+	delete pSnapshot;
+}
+
+// M: accounts for the memory used by a journal snapshot
+void CConcept::AccountJournalSnapshotMemory(
+	TConceptJournalSnapshot* pSnapshot, TMemoryAccount& rmaAccount, 
+	const string& sComponent)
+{
+	AccountMemory(rmaAccount, sComponent, 1, 
+		(int)(sizeof(TConceptJournalSnapshot) +
+		StringHeapBytes(pSnapshot->sExplicitlyConfirmedHyp) +
+		StringHeapBytes(pSnapshot->sExplicitlyDisconfirmedHyp) +
+		pSnapshot->vpHistory.capacity() * sizeof(CConcept*)));
+	if (pSnapshot->pHypSetCopy)
+		pSnapshot->pHypSetCopy->AccountMemoryUsage(rmaAccount, sComponent);
+	for (unsigned int i = 0; i < pSnapshot->vpHistory.size(); i++)
+		pSnapshot->vpHistory[i]->AccountMemoryUsage(rmaAccount, sComponent);
+}
+
+// M: records the concept in the dialog state journal. Only concepts that 
+//    live in the dialog task tree are recorded: clones (which do not notify
+//    changes), history versions and temporary concepts are not. Since all 
+//    the changes to the concept state go through here, this also marks the
+//    concept as changed
+void CConcept::journalChange(int iParts)
+{
+	markChanged();
+	if (pDMCore && bChangeNotification && !bHistoryConcept &&
+		(pOwnerDialogAgent || pOwnerConcept))
+		pDMCore->JournalConceptChange(this, iParts);
+}
+
 //-----------------------------------------------------------------------------
 // Virtual methods that are array-specific
 //-----------------------------------------------------------------------------
@@ -2880,4 +3730,55 @@ void CConcept::InsertAt(unsigned int iIndex, CConcept &rAConcept)
 		ConceptTypeAsString[ctConceptType].c_str()));
 }
 
-#pragma warning (default:4100)
\ No newline at end of file
+// M: DeleteRangeAt method
+void CConcept::DeleteRangeAt(unsigned int iIndex, unsigned int iCount)
+{
+	FatalError(FormatString("DeleteRangeAt cannot be called on concept %s "\
+		"(%s type).", sName.c_str(),
+		ConceptTypeAsString[ctConceptType].c_str()));
+}
+
+// M: InsertRangeAt method
+void CConcept::InsertRangeAt(unsigned int iIndex, 
+	TConceptPointersVector& rvcpConcepts)
+{
+	FatalError(FormatString("InsertRangeAt cannot be called on concept %s "\
+		"(%s type).", sName.c_str(),
+		ConceptTypeAsString[ctConceptType].c_str()));
+}
+
+#pragma warning (default:4100)
+
+//-----------------------------------------------------------------------------
+// Concept update types
+//-----------------------------------------------------------------------------
+
+// M: converts an update type string (CU_*) into the enum
+TConceptUpdateType StringToConceptUpdateType(string sUpdateType)
+{
+	if (sUpdateType == CU_ASSIGN_FROM_STRING)
+		return cuAssignFromString;
+	else if (sUpdateType == CU_ASSIGN_FROM_CONCEPT)
+		return cuAssignFromConcept;
+	else if (sUpdateType == CU_UPDATE_WITH_CONCEPT)
+		return cuUpdateWithConcept;
+	else if (sUpdateType == CU_COLLAPSE_TO_MODE)
+		return cuCollapseToMode;
+	else if (sUpdateType == CU_PARTIAL_FROM_STRING)
+		return cuPartialFromString;
+	return cuUnknown;
+}
+
+// M: converts an update type enum into its string (CU_*)
+string ConceptUpdateTypeToString(TConceptUpdateType cuUpdateType)
+{
+	switch (cuUpdateType)
+	{
+	case cuAssignFromString: return CU_ASSIGN_FROM_STRING;
+	case cuAssignFromConcept: return CU_ASSIGN_FROM_CONCEPT;
+	case cuUpdateWithConcept: return CU_UPDATE_WITH_CONCEPT;
+	case cuCollapseToMode: return CU_COLLAPSE_TO_MODE;
+	case cuPartialFromString: return CU_PARTIAL_FROM_STRING;
+	default: return "unknown";
+	}
+}
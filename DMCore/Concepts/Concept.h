@@ -50,6 +50,40 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the hypotheses are the only storage for the 
+//                            confidences (the sweeps gather them), and freed
+//                            slots are reused only on request
+//   [2026-10-19] (mbrenner): the journal snapshots of concepts are 
+//                            TConceptJournalSnapshot structures holding only
+//                            the parts of the state that are about to change
+//   [2026-10-19] (mbrenner): the hypsets of atomic concepts are shared 
+//                            (reference counted, copy-on-write) by 
+//                            CopyCurrentHypSetFrom, and therefore by Clone,
+//                            Restore and the snapshots
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added the concept version (GetVersion), used for
+//                            caching agent conditions
+//   [2026-10-19] (mbrenner): added InsertRangeAt() and DeleteRangeAt()
+//   [2026-10-19] (mbrenner): added the cached merged history view of the 
+//                            concept (GetMergedHistoryConcept)
+//   [2026-10-19] (mbrenner): added the binary encoding of concepts (ToBinary
+//                            and FromBinary)
+//   [2026-10-19] (mbrenner): added the enum version of Update, dispatched 
+//                            through a table of update functions
+//   [2026-10-19] (mbrenner): added DEFINE_HYP_POOL for pooled allocation of
+//                            hypotheses
+//   [2026-10-19] (mbrenner): the history is now kept as an indexed vector of
+//                            versions (constant time append and indexed
+//                            access, bulk free) instead of a linked chain
+//   [2026-10-19] (mbrenner): added CHyp::ValueHash and the value hash index
+//                            over the current hypset
+//   [2026-10-19] (mbrenner): added cached top and second hypothesis 
+//                            indices, and the top hyp query counters
+//   [2026-10-19] (mbrenner): added the optional reuse of freed hypothesis
+//                            slots (compact hyp storage, off by default)
+//   [2026-10-19] (mbrenner): added support for the dialog state journal
+//                            (CreateJournalSnapshot and
+//                            RestoreFromJournalSnapshot)
 //   [2006-06-15] (antoine): merged with Calista belief updating framework
 //							 (from RavenClaw 1)
 //	 [2005-11-07] (antoine): added support for partial concept update
@@ -150,6 +184,22 @@ static string ConveyanceAsString[] = { "Conveyed", "Not conveyed", "Failed" };
 #define INVALIDATED_CONCEPT "<INVALIDATED>\n"
 #define UNDEFINED_VALUE "<UNDEF_VAL>"
 
+//-----------------------------------------------------------------------------
+// Definitions for the binary encoding of concepts. The encoding starts with
+//  the magic number and the version, which is increased whenever the 
+//  encoding changes
+//-----------------------------------------------------------------------------
+#define CONCEPT_BINARY_MAGIC 0x42435652		// "RVCB"
+#define CONCEPT_BINARY_VERSION 1
+
+// M: the flags in the binary encoding of a concept
+#define CBF_GROUNDED				0x01
+#define CBF_INVALIDATED				0x02
+#define CBF_RESTORED_FOR_GROUNDING	0x04
+#define CBF_SEALED					0x08
+#define CBF_HISTORY_CONCEPT			0x10
+#define CBF_WAITING_CONVEYANCE		0x20
+
 //-----------------------------------------------------------------------------
 // CHyp class - this is the base class for the hierarchy of hypothesis
 //              classes. It essentially implements a type and an associated 
@@ -213,11 +263,20 @@ public:
 	//
 	virtual CHyp* operator [](string sItem);
 
+	// Value hash (consistent with the equality operator)
+	//
+	virtual unsigned int ValueHash();
+
 	// String conversion functions
 	//
 	virtual string ValueToString();
 	virtual string ToString();
 	virtual void FromString(string sString);
+
+	// Binary conversion functions (for the value only)
+	//
+	virtual void WriteValueBinary(CBinaryWriter& rbwWriter);
+	virtual void ReadValueBinary(CBinaryReader& rbrReader);
 };
 
 
@@ -234,6 +293,29 @@ public:
 //    to others)
 #define FREE_PROB_MASS ((float)0.05)
 
+// M: definition of the confidence value used for null hypothesis slots in
+//    confidence sweeps (never wins a max-confidence sweep)
+#define NULL_HYP_CONFIDENCE ((float)-1.0)
+
+// M: Macro for defining the pooled allocation operators of a hypothesis 
+//    class (each hypothesis type is allocated from its own free list pool; 
+//    the pool is never destroyed, since hypotheses can outlive the static 
+//    objects)
+#define DEFINE_HYP_POOL(HypClassName)\
+	CFixedSizePool& HypClassName::GetPool()\
+	{\
+		static CFixedSizePool* pPool = new CFixedSizePool(sizeof(HypClassName));\
+		return *pPool;\
+	}\
+	void* HypClassName::operator new(size_t stSize)\
+	{\
+		return GetPool().Allocate(stSize);\
+	}\
+	void HypClassName::operator delete(void* pBlock, size_t stSize)\
+	{\
+		GetPool().Free(pBlock, stSize);\
+	}
+
 // D: forward declaration
 class CDialogAgent;
 
@@ -245,6 +327,30 @@ typedef vector <CConcept *> TConceptPointersVector;
 typedef set < CConcept *, less < CConcept * >,
 	allocator < CConcept * > > TConceptPointersSet;
 
+// M: the parts of the concept state recorded in the dialog state journal, 
+//    besides the flags, the conveyance information and the explicitly 
+//    (dis)confirmed hyps, which are always recorded
+#define CJ_HYPSET				1
+#define CJ_HISTORY				2
+
+// M: structure holding a journal snapshot of a concept
+typedef struct
+{
+	int iParts;							// the recorded parts (CJ_*)
+	bool bGrounded;
+	bool bInvalidated;
+	bool bRestoredForGrounding;
+	bool bSealed;
+	bool bWaitingConveyance;
+	int iTurnLastUpdated;
+	TConveyance cConveyance;
+	string sExplicitlyConfirmedHyp;
+	string sExplicitlyDisconfirmedHyp;
+	CConcept* pHypSetCopy;				// a copy of the hypset (CJ_HYPSET)
+	TConceptPointersVector vpHistory;	// copies of the history versions
+										//  (CJ_HISTORY)
+} TConceptJournalSnapshot;
+
 
 // D: define concept update types
 // D
@@ -254,10 +360,32 @@ typedef set < CConcept *, less < CConcept * >,
 #define CU_COLLAPSE_TO_MODE         "collapse_to_mode"
 #define CU_PARTIAL_FROM_STRING		"partial_from_string"
 
+// M: the concept update types, as an enum (the string version of Update
+//    maps the CU_* constants above onto these)
+typedef enum {
+	cuAssignFromString, cuAssignFromConcept, cuUpdateWithConcept, 
+	cuCollapseToMode, cuPartialFromString, cuUnknown
+} TConceptUpdateType;
+
+// M: conversion functions between update type strings and enums
+TConceptUpdateType StringToConceptUpdateType(string sUpdateType);
+string ConceptUpdateTypeToString(TConceptUpdateType cuUpdateType);
+
+// M: the belief updating models (see the grounding manager)
+#define BUM_UNKNOWN -1			// unknown model (concepts are not updated)
+#define BUM_NPU 0				// naive probabilistic updating
+#define BUM_CALISTA 1			// calista
+#define BUM_NUM_MODELS 2
+
 // D: now, the CConcept class
 class CConcept
 {
 
+	// declare the CStructHyp class as a friend (structure hyps set the 
+	// confidences of their items directly)
+	//
+	friend class CStructHyp;
+
 protected:
 
 	//---------------------------------------------------------------------
@@ -322,6 +450,38 @@ protected:
 	vector<CHyp*, allocator<CHyp*> > vhCurrentHypSet;
 	int iNumValidHyps;
 
+	// the reference count of the hypotheses in the current hypset, when 
+	// they are shared with other concepts (copy-on-write): the count is
+	// shared by all the concepts that hold the same hypotheses, and is NULL
+	// when the concept owns its hypotheses alone
+	int* piHypSetRefCount;
+
+	// the list of slots freed by SetNullHyp, and whether those slots are
+	// reused when new hypotheses are added (off by default, since reusing
+	// a slot changes the order of the hypotheses, and therefore which one
+	// wins a confidence tie)
+	TIntVector viFreeHypSlots;
+	bool bCompactHypStorage;
+
+	// cached indices of the top and second best hypotheses; they are 
+	// maintained incrementally as confidences change, and recomputed with
+	// a full sweep only when the dirty flag is set
+	int iCachedTopHypIndex;
+	int iCached2ndHypIndex;
+	bool bTopHypsDirty;
+
+	// counters for the top/second hyp index queries, and for the number 
+	// of those queries that required a full sweep of the hypset
+	static unsigned long ulTopHypQueries;
+	static unsigned long ulTopHypSweeps;
+
+	// value hash index over the current hypset: the value hash of each 
+	// slot, and an open addressing table of slot indices (-1 marks empty
+	// entries); rebuilt lazily after the hypset changes
+	vector<unsigned int, allocator<unsigned int> > vuiHypValueHashes;
+	TIntVector viHypValueIndex;
+	bool bHypValueIndexDirty;
+
 	// the set of partial hypotheses
 	// 鲿ּ
 	vector<CHyp*, allocator<CHyp*> > vhPartialHypSet;
@@ -341,9 +501,20 @@ protected:
 
 	// history information 
 	// ʷϢ
-	CConcept* pPrevConcept;
+	// (the history versions, from the oldest to the most recent one)
+	TConceptPointersVector vpHistory;
 	bool bHistoryConcept;
 
+	// the cached merged history view of the concept (see 
+	// GetMergedHistoryConcept); it is rebuilt on the first access after 
+	// the concept (or one of its items / elements) changes
+	CConcept* pMergedHistoryCache;
+	bool bMergedHistoryCacheDirty;
+
+	// the version of the concept: incremented whenever the concept (or one 
+	// of its items / elements) changes
+	int iVersion;
+
 	// store the hypothesis that has already been explicitly confirmed 
 	// for this concept (as a string);
 	// 洢ѾΪ˸ȷȷϵļ裨Ϊַ;
@@ -354,6 +525,15 @@ protected:
 	// 洢ѾΪ˸ȷ񶨵ļ裨Ϊַ;
 	string sExplicitlyDisconfirmedHyp;
 
+	// the update functions, indexed by belief updating model (BUM_*) and 
+	// update type (NULL for the updates a model does not support)
+	typedef void (CConcept::*FConceptUpdateFunction)(void* pUpdateData);
+	static FConceptUpdateFunction pfUpdateFunctions[BUM_NUM_MODELS][cuUnknown];
+
+	// returns true if the updates on the concept are logged (it has a 
+	// grounding model, and the concept logging stream is active)
+	bool isUpdateLogged();
+
 public:
 
 	//---------------------------------------------------------------------
@@ -410,6 +590,7 @@ public:
 
 	// update the concept
 	virtual void Update(string sUpdateType, void* pUpdateData);
+	virtual void Update(TConceptUpdateType cuUpdateType, void* pUpdateData);
 
 	//---------------------------------------------------------------------
 	// Virtual methods implementing various types of updates in the naive
@@ -500,6 +681,21 @@ public:
 	// Generate a string representation of the set of hypotheses
 	virtual string HypSetToString();
 
+	//---------------------------------------------------------------------
+	// Methods implementing the binary encoding
+	//---------------------------------------------------------------------
+
+	// Encode the concept (current hypset, flags and history), with the 
+	// version header, and restore it from that encoding
+	void ToBinary(CBinaryWriter& rbwWriter);
+	void FromBinary(CBinaryReader& rbrReader);
+
+	// Encode / restore the concept state without the header (used for the
+	// history versions and for the concepts nested in structures, frames 
+	// and arrays)
+	void WriteBinaryState(CBinaryWriter& rbwWriter);
+	void ReadBinaryState(CBinaryReader& rbrReader);
+
 	//---------------------------------------------------------------------
 	// Methods providing access to concept type and source
 	// ṩԸͺԴķʵķ
@@ -696,9 +892,20 @@ public:
 	// clear the current set of hypotheses for the concept
 	virtual void ClearCurrentHypSet();
 
-	// copies the current hypset from another concept
+	// copies the current hypset from another concept (atomic concepts of
+	// the same type share the hypotheses, until one of them changes)
 	virtual void CopyCurrentHypSetFrom(CConcept& rAConcept);
 
+	// sets/returns whether freed hypothesis slots are reused when adding
+	// new hypotheses (compact hypothesis storage)
+	void SetCompactHypStorage(bool bACompactHypStorage);
+	bool GetCompactHypStorage();
+
+	// access to the top/second hyp index query counters
+	static unsigned long GetTopHypQueries();
+	static unsigned long GetTopHypSweeps();
+	static void ResetTopHypCounters();
+
 	// sets the cardinality of the hypset
 	virtual void SetCardinality(int iACardinality);
 
@@ -831,6 +1038,15 @@ public:
 	// construct a new concept by merging over the history of this concept
 	virtual CConcept* CreateMergedHistoryConcept();
 
+	// access the merged history view of this concept (the view is owned 
+	// and cached by the concept, and stays valid until the next access 
+	// following a change); returns NULLConcept if there is no value
+	CConcept& GetMergedHistoryConcept();
+
+	// access the version of the concept (changes whenever the concept or
+	// one of its items / elements changes)
+	int GetVersion();
+
 	// merge history of the concept back into the current value
 	virtual void MergeHistory();
 
@@ -845,6 +1061,24 @@ public:
 	virtual void SetHistoryConcept(bool bAHistoryConcept = true);
 	virtual bool IsHistoryConcept();
 
+	//---------------------------------------------------------------------
+	// Methods supporting the dialog state journal (used for rolling back
+	// to a previous dialog state)
+	//---------------------------------------------------------------------
+
+	// create a snapshot of the flags of the concept, and of the requested
+	// parts (CJ_*) of its state
+	virtual TConceptJournalSnapshot* CreateJournalSnapshot(int iParts);
+
+	// restore the concept from a snapshot; the snapshot's history is moved
+	// into the concept
+	virtual void RestoreFromJournalSnapshot(TConceptJournalSnapshot* pSnapshot);
+
+	// delete a snapshot, and account for the memory it uses
+	static void DeleteJournalSnapshot(TConceptJournalSnapshot* pSnapshot);
+	static void AccountJournalSnapshotMemory(TConceptJournalSnapshot* pSnapshot,
+		TMemoryAccount& rmaAccount, const string& sComponent);
+
 	//---------------------------------------------------------------------
 	// Methods that are array-specific and will be implemented by arrays
 	// ضҽʵֵķ
@@ -858,6 +1092,83 @@ public:
 
 	// inserts an element at a give index in the array
 	virtual void InsertAt(unsigned int iIndex, CConcept &rAConcept);
+
+	// deletes iCount elements starting at a given index in the array
+	virtual void DeleteRangeAt(unsigned int iIndex, unsigned int iCount);
+
+	// inserts copies of a set of concepts starting at a given index in 
+	// the array
+	virtual void InsertRangeAt(unsigned int iIndex, 
+		TConceptPointersVector& rvcpConcepts);
+
+	//---------------------------------------------------------------------
+	// Memory accounting
+	//---------------------------------------------------------------------
+
+	// account the memory held by the concept, its grounding model and its 
+	// history (the hypotheses are accounted for through their pools)
+	virtual void AccountMemoryUsage(TMemoryAccount& rmaAccount,
+		const string& sComponent = MA_CONCEPTS);
+
+protected:
+
+	// records the concept in the dialog state journal, before it gets 
+	// changed; iParts indicates which parts (CJ_*) besides the flags are
+	// about to change
+	void journalChange(int iParts);
+
+	// sets the waiting_for_conveyance flag when restoring a saved state
+	void restoreWaitingConveyance();
+
+	// maintain the free slots and the top hyps cache after the hypothesis
+	// in a slot (or its confidence) changed, or after the whole hypset was
+	// constructed directly
+	void syncHypSlot(int iIndex);
+	void syncHypSlots();
+
+	// maintain the free slots and the top hyps cache after a slot was 
+	// erased from the hypset
+	void eraseHypSlot(int iIndex);
+
+	// return the confidence of a slot (NULL_HYP_CONFIDENCE for null 
+	// slots), and gather the confidences of all the slots in a vector
+	float getHypSlotConfidence(int iIndex);
+	void gatherHypConfidences(vector<float, allocator<float> >& rvfConfidences);
+
+	// returns a freed hypothesis slot that can be reused, or -1
+	int acquireFreeHypSlot();
+
+	// share the hypotheses of another concept, make private copies of the
+	// shared hypotheses before they are changed, and drop the reference
+	// to the shared hypotheses (returns true if the concept was the last
+	// one holding them)
+	void shareHypSetFrom(CConcept& rAConcept);
+	void unshareHypSet();
+	bool releaseHypSet();
+
+	// build the value hash index (if needed), and look up a hyp in it
+	void refreshHypValueIndex();
+	int lookupHypValue(CHyp* pHyp);
+
+	// maintain the cached top and second hyp indices
+	void updateTopHyps(int iIndex);
+	void recomputeTopHyps();
+	bool ranksAbove(int iIndex, int iOtherIndex);
+
+	// access and maintain the history versions
+	CConcept* getPrevConcept();
+	CConcept* historyVersionAt(int iIndex);
+	void pushHistoryVersion(CConcept* pConcept);
+	void cloneHistoryInto(CConcept* pConcept);
+	void freeHistory();
+
+	// mark this concept (and the concepts owning it) as changed: increments
+	// the versions and marks the merged history views as out of date
+	void markChanged();
+
+	// write / read the binary encoding of the current hypset
+	virtual void writeBinaryHypSet(CBinaryWriter& rbwWriter);
+	virtual void readBinaryHypSet(CBinaryReader& rbrReader);
 };
 
 // NULL concept: this object is used designate invalid concept references
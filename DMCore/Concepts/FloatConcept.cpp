@@ -50,6 +50,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the binary encoding of the value
+//   [2026-10-19] (mbrenner): CFloatHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -91,6 +93,9 @@
 // CFloatHyp: Constructors and Destructors
 //-----------------------------------------------------------------------------
 
+// M: pooled allocation operators
+DEFINE_HYP_POOL(CFloatHyp)
+
 // D: default constructor
 CFloatHyp::CFloatHyp()
 {
@@ -235,6 +240,19 @@ CHyp* CFloatHyp::operator [] (string sItem)
 	return NULL;
 }
 
+// M: Value hash (hashes the bits of the value; 0 and -0 compare equal, 
+//    so they are hashed the same)
+unsigned int CFloatHyp::ValueHash()
+{
+	union
+	{
+		float fValue;
+		unsigned int uiValue;
+	} ufBits;
+	ufBits.fValue = (fValue == 0) ? 0 : fValue;
+	return HashCombine(FNV_HASH_SEED, ufBits.uiValue);
+}
+
 // D: Convert value to string
 string CFloatHyp::ValueToString()
 {
@@ -278,6 +296,18 @@ void CFloatHyp::FromString(string sString)
 	}
 }
 
+// M: Write the value in the binary format
+void CFloatHyp::WriteValueBinary(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteFloat(fValue);
+}
+
+// M: Read the value from the binary format
+void CFloatHyp::ReadValueBinary(CBinaryReader& rbrReader)
+{
+	fValue = rbrReader.ReadFloat();
+}
+
 
 
 //-----------------------------------------------------------------------------
@@ -313,7 +343,6 @@ CFloatConcept::CFloatConcept(string sAName, float fAValue, float fAConfidence,
 	bWaitingConveyance = false;
 	cConveyance = cNotConveyed;
 	SetHistoryConcept(false);
-	pPrevConcept = NULL;
 }
 
 //-----------------------------------------------------------------------------
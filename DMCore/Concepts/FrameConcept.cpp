@@ -53,6 +53,13 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): updateFromString takes the update type enum
+//   [2026-10-19] (mbrenner): the items are now kept in a flat CItemMap (in
+//                            item order, with a sorted name index), and
+//                            accessed by position where possible
+//   [2026-10-19] (mbrenner): the history is now kept as an indexed vector of
+//                            versions (constant time append and indexed
+//                            access, bulk free) instead of a linked chain
 //   [2006-06-15] (antoine): merged Calista belief updating functions from
 //                           RavenClaw1
 //   [2006-01-01] (antoine): branched for RavenClaw2, added support for
@@ -145,9 +152,7 @@ CFrameConcept::~CFrameConcept()
 		svItems.clear();
 	}
 	// and recursively destroy previous instantiations
-	if (pPrevConcept != NULL)
-		delete pPrevConcept;
-	pPrevConcept = NULL;
+	freeHistory();
 	// and finally the grounding model (if any)
 	if (pGroundingModel != NULL)
 	{
@@ -217,15 +222,11 @@ void CFrameConcept::Clear()
 		"history.", sName.c_str()));
 
 	// o/w delete all it's history
-	if (pPrevConcept != NULL)
-	{
-		delete pPrevConcept;
-		pPrevConcept = NULL;
-	}
+	freeHistory();
 
 	// and clear all the concepts in the ItemMap    
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->Clear();
+		ItemMap.GetItemAt(i)->Clear();
 
 	// don't log the update since frames don't have grounding models
 
@@ -243,7 +244,7 @@ void CFrameConcept::ClearCurrentValue()
 
 	// o/w clear all the concepts in the ItemMap    
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->ClearCurrentValue();
+		ItemMap.GetItemAt(i)->ClearCurrentValue();
 
 	// don't log the update since frames don't have grounding models
 
@@ -368,7 +369,7 @@ void CFrameConcept::Update_NPU_AssignFromString(void* pUpdateData)
 				// and if found, update its value accordingly
 				if (sConfidence != "")
 					sValue += VAL_CONF_SEPARATOR + sConfidence;
-				iPtr->second->Update(CU_ASSIGN_FROM_STRING, &sValue);
+				iPtr->second->Update(cuAssignFromString, &sValue);
 			}
 		}
 		else
@@ -426,7 +427,7 @@ void CFrameConcept::Update_NPU_UpdateWithConcept(void* pUpdateData)
 				svItems[i].c_str(), pFrameConcept->GetName().c_str()));
 		}
 		else
-			ItemMap[svItems[i]]->Update(CU_UPDATE_WITH_CONCEPT,
+			ItemMap.GetItemAt(i)->Update(cuUpdateWithConcept,
 			pFrameConcept->ItemMap[svItems[i]]);
 	}
 
@@ -439,18 +440,19 @@ void CFrameConcept::Update_NPU_CollapseToMode(void* pUpdateData)
 {
 	// basically calls collapse to mode on all its subitems
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->Update(CU_COLLAPSE_TO_MODE, pUpdateData);
+		ItemMap.GetItemAt(i)->Update(cuCollapseToMode, pUpdateData);
 }
 
 // A: Update the partial value of a concept
 void CFrameConcept::Update_PartialFromString(void* pUpdateData)
 {
 	// traverses the frame and updates each sub-concept
-	updateFromString(pUpdateData, CU_PARTIAL_FROM_STRING);
+	updateFromString(pUpdateData, cuPartialFromString);
 }
 
 #pragma warning (disable:4189)
-void CFrameConcept::updateFromString(void* pUpdateData, string sUpdateType)
+void CFrameConcept::updateFromString(void* pUpdateData,
+	TConceptUpdateType cuUpdateType)
 {
 	// first, check that it's not a history concept
 	if (bHistoryConcept)
@@ -559,7 +561,7 @@ void CFrameConcept::updateFromString(void* pUpdateData, string sUpdateType)
 				// and if found, update its value accordingly
 				if (sConfidence != "")
 					sValue += VAL_CONF_SEPARATOR + sConfidence;
-				iPtr->second->Update(sUpdateType, &sValue);
+				iPtr->second->Update(cuUpdateType, &sValue);
 			}
 		}
 		else
@@ -619,7 +621,7 @@ void CFrameConcept::Update_Calista_UpdateWithConcept(void* pUpdateData)
 				svItems[i].c_str(), pFrameConcept->GetName().c_str()));
 		}
 		else
-			ItemMap[svItems[i]]->Update(CU_UPDATE_WITH_CONCEPT,
+			ItemMap.GetItemAt(i)->Update(cuUpdateWithConcept,
 			pFrameConcept->ItemMap[svItems[i]]);
 	}
 
@@ -632,7 +634,7 @@ void CFrameConcept::Update_Calista_CollapseToMode(void* pUpdateData)
 {
 	// basically calls collapse to mode on all its subitems
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->Update(CU_COLLAPSE_TO_MODE, pUpdateData);
+		ItemMap.GetItemAt(i)->Update(cuCollapseToMode, pUpdateData);
 }
 
 //-----------------------------------------------------------------------------
@@ -648,7 +650,7 @@ bool CFrameConcept::IsUpdated()
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
 
-		if (ItemMap[svItems[i]]->IsUpdated())
+		if (ItemMap.GetItemAt(i)->IsUpdated())
 		{
 			return true;
 		}
@@ -667,7 +669,7 @@ bool CFrameConcept::IsUpdatedAndGrounded()
 	// o/w if it's updated, check that all updated items are also grounded
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		if (ItemMap[svItems[i]]->IsUpdated() && !ItemMap[svItems[i]]->IsUpdatedAndGrounded())
+		if (ItemMap.GetItemAt(i)->IsUpdated() && !ItemMap.GetItemAt(i)->IsUpdatedAndGrounded())
 			return false;
 	}
 
@@ -680,7 +682,7 @@ bool CFrameConcept::IsUpdatedAndGrounded()
 bool CFrameConcept::IsAvailable()
 {
 	for (unsigned int i = 0; i < svItems.size(); i++)
-	if (ItemMap[svItems[i]]->IsAvailable())
+	if (ItemMap.GetItemAt(i)->IsAvailable())
 	{
 		return true;
 	}
@@ -697,7 +699,7 @@ bool CFrameConcept::IsAvailableAndGrounded()
 
 	// then check all subitems
 	for (unsigned int i = 0; i < svItems.size(); i++)
-	if (ItemMap[svItems[i]]->IsAvailableAndGrounded())
+	if (ItemMap.GetItemAt(i)->IsAvailableAndGrounded())
 	{
 		return true;
 	}
@@ -709,7 +711,7 @@ bool CFrameConcept::IsAvailableAndGrounded()
 bool CFrameConcept::IsUndergoingGrounding()
 {
 	for (unsigned int i = 0; i < svItems.size(); i++)
-	if (ItemMap[svItems[i]]->IsUndergoingGrounding())
+	if (ItemMap.GetItemAt(i)->IsUndergoingGrounding())
 	{
 		return true;
 	}
@@ -729,9 +731,9 @@ string CFrameConcept::GroundedHypToString()
 
 	// go through the items and add them to the string
 	for (unsigned int i = 0; i < svItems.size(); i++)
-	if (ItemMap[svItems[i]]->IsUpdatedAndGrounded())
+	if (ItemMap.GetItemAt(i)->IsUpdatedAndGrounded())
 	{
-		sResult += svItems[i] + "\t" + ItemMap[svItems[i]]->GroundedHypToString();
+		sResult += svItems[i] + "\t" + ItemMap.GetItemAt(i)->GroundedHypToString();
 	}
 
 	// and finally add the closing braces and return 
@@ -747,9 +749,9 @@ string CFrameConcept::TopHypToString()
 
 	// go through the items and add them to the string
 	for (unsigned int i = 0; i < svItems.size(); i++)
-	if (ItemMap[svItems[i]]->IsUpdated())
+	if (ItemMap.GetItemAt(i)->IsUpdated())
 	{
-		sResult += svItems[i] + "\t" + ItemMap[svItems[i]]->TopHypToString();
+		sResult += svItems[i] + "\t" + ItemMap.GetItemAt(i)->TopHypToString();
 	}
 
 	// and finally add the closing braces and return 
@@ -766,10 +768,10 @@ string CFrameConcept::HypSetToString()
 	// go through the items and add them to the string
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		if (ItemMap[svItems[i]]->IsUpdated())
+		if (ItemMap.GetItemAt(i)->IsUpdated())
 		{
 			sResult += svItems[i] + "\t" +
-				ItemMap[svItems[i]]->HypSetToString();
+				ItemMap.GetItemAt(i)->HypSetToString();
 		}
 	}
 
@@ -863,7 +865,7 @@ void CFrameConcept::CreateGroundingModel(string sGroundingModelSpec)
 		}
 
 		// now create the grounding model on the item
-		ItemMap[svItems[ni]]->CreateGroundingModel(
+		ItemMap.GetItemAt(ni)->CreateGroundingModel(
 			TrimRight(sItemGroundingModelSpec, ", "));
 	}
 }
@@ -879,7 +881,7 @@ void CFrameConcept::SetInvalidatedFlag(bool bAInvalidated)
 	// go through the items and set the flag
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		ItemMap[svItems[i]]->SetInvalidatedFlag(bInvalidated);
+		ItemMap.GetItemAt(i)->SetInvalidatedFlag(bInvalidated);
 	}
 	// finally, break the seal
 	BreakSeal();
@@ -893,7 +895,7 @@ bool CFrameConcept::GetInvalidatedFlag()
 	// go through the items and check the flag
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		if (ItemMap[svItems[i]]->IsInvalidated())
+		if (ItemMap.GetItemAt(i)->IsInvalidated())
 		{
 			bInvalidated = true;
 			break;
@@ -913,7 +915,7 @@ void CFrameConcept::SetRestoredForGroundingFlag(bool bARestoredForGrounding)
 	// go through the items and set the flag
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		ItemMap[svItems[i]]->SetRestoredForGroundingFlag(
+		ItemMap.GetItemAt(i)->SetRestoredForGroundingFlag(
 			bARestoredForGrounding);
 	}
 }
@@ -926,7 +928,7 @@ bool CFrameConcept::GetRestoredForGroundingFlag()
 	// go through the items and check the flag
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		if (ItemMap[svItems[i]]->GetRestoredForGroundingFlag())
+		if (ItemMap.GetItemAt(i)->GetRestoredForGroundingFlag())
 		{
 			bRestoredForGrounding = true;
 			break;
@@ -1090,7 +1092,7 @@ void CFrameConcept::ClearCurrentHypSet()
 	if (!IsUpdated()) return;
 	// clear the current hypsets for all the subsumed concepts
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->ClearCurrentHypSet();
+		ItemMap.GetItemAt(i)->ClearCurrentHypSet();
 	// notify the change
 	NotifyChange();
 }
@@ -1124,7 +1126,7 @@ void CFrameConcept::CopyCurrentHypSetFrom(CConcept& rAConcept)
 		}
 		else
 		{
-			ItemMap[svItems[i]]->CopyCurrentHypSetFrom(
+			ItemMap.GetItemAt(i)->CopyCurrentHypSetFrom(
 				*rAFrameConcept.ItemMap[svItems[i]]);
 		}
 	}
@@ -1138,7 +1140,7 @@ void CFrameConcept::ClearExplicitlyConfirmedHyp()
 {
 	// clear the explicitly confirmed hyp for all subconcepts
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->ClearExplicitlyConfirmedHyp();
+		ItemMap.GetItemAt(i)->ClearExplicitlyConfirmedHyp();
 }
 
 // D: clear the explicitly disconfirmed hyp string
@@ -1146,7 +1148,7 @@ void CFrameConcept::ClearExplicitlyDisconfirmedHyp()
 {
 	// clear the explicitly confirmed hyp for all subconcepts
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->ClearExplicitlyDisconfirmedHyp();
+		ItemMap.GetItemAt(i)->ClearExplicitlyDisconfirmedHyp();
 }
 
 //-----------------------------------------------------------------------------
@@ -1160,8 +1162,8 @@ int CFrameConcept::GetTurnLastUpdated()
 	int iTurnLastUpdated = -1;
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		if (iTurnLastUpdated < ItemMap[svItems[i]]->GetTurnLastUpdated())
-			iTurnLastUpdated = ItemMap[svItems[i]]->GetTurnLastUpdated();
+		if (iTurnLastUpdated < ItemMap.GetItemAt(i)->GetTurnLastUpdated())
+			iTurnLastUpdated = ItemMap.GetItemAt(i)->GetTurnLastUpdated();
 	}
 
 	// finally, return it
@@ -1185,9 +1187,9 @@ void CFrameConcept::ReOpen()
 	// now, reopen all the items
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
-		ItemMap[svItems[i]]->ReOpen();
+		ItemMap.GetItemAt(i)->ReOpen();
 		// and redirect the owner concept accordingly
-		ItemMap[svItems[i]]->operator[](-1).SetOwnerConcept(pPrevConcept);
+		ItemMap.GetItemAt(i)->operator[](-1).SetOwnerConcept(getPrevConcept());
 	}
 
 	// clear the current value (this will notify the change)
@@ -1203,17 +1205,14 @@ void CFrameConcept::ReOpen()
 	{
 		pConcept->svItems.push_back(svItems[i]);
 		pConcept->ItemMap.insert(TItemMap::value_type(
-			svItems[i], &(ItemMap[svItems[i]]->operator[] (-1))));
+			svItems[i], &(ItemMap.GetItemAt(i)->operator[] (-1))));
 	}
 
 	// set the flag that it's a history concept
 	pConcept->SetHistoryConcept();
 
-	// link it to the current history
-	pConcept->pPrevConcept = pPrevConcept;
-
 	// and push it into the history
-	pPrevConcept = pConcept;
+	pushHistoryVersion(pConcept);
 
 	// don't log the update since frames don't have grounding models
 }
@@ -1228,14 +1227,10 @@ void CFrameConcept::ClearHistory()
 
 	// o/w go through each item and clear its history
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->ClearHistory();
+		ItemMap.GetItemAt(i)->ClearHistory();
 
 	// and delete all its history
-	if (pPrevConcept != NULL)
-	{
-		delete pPrevConcept;
-		pPrevConcept = NULL;
-	}
+	freeHistory();
 }
 
 // D: merges the history on the concept, and returns a new concept containing 
@@ -1263,7 +1258,7 @@ void CFrameConcept::MergeHistory()
 
 	// merge all the subitems
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->MergeHistory();
+		ItemMap.GetItemAt(i)->MergeHistory();
 
 	// set it to not a history concept
 	SetHistoryConcept(false);
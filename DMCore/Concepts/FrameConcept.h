@@ -53,6 +53,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): updateFromString takes the update type enum
 //   [2006-06-15] (antoine): merged Calista belief updating functions from
 //                           RavenClaw1
 //   [2006-01-01] (antoine): branched for RavenClaw2, added support for
@@ -343,7 +344,7 @@ protected:
 	// Protected virtual methods implementing various types of updates
 	//---------------------------------------------------------------------
 
-	void updateFromString(void* pUpdateData, string sUpdateType);
+	void updateFromString(void* pUpdateData, TConceptUpdateType cuUpdateType);
 
 };
 
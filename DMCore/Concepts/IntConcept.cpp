@@ -50,6 +50,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the binary encoding of the value
+//   [2026-10-19] (mbrenner): CIntHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -91,6 +93,9 @@
 // CIntHyp: Constructors and Destructors
 //-----------------------------------------------------------------------------
 
+// M: pooled allocation operators
+DEFINE_HYP_POOL(CIntHyp)
+
 // D: default constructor
 CIntHyp::CIntHyp()
 {
@@ -235,6 +240,12 @@ CHyp* CIntHyp::operator [] (string sItem)
 	return NULL;
 }
 
+// M: Value hash
+unsigned int CIntHyp::ValueHash()
+{
+	return HashCombine(FNV_HASH_SEED, (unsigned int)iValue);
+}
+
 // D: Convert value to string
 string CIntHyp::ValueToString()
 {
@@ -279,6 +290,18 @@ void CIntHyp::FromString(string sString)
 	}
 }
 
+// M: Write the value in the binary format
+void CIntHyp::WriteValueBinary(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteInt32(iValue);
+}
+
+// M: Read the value from the binary format
+void CIntHyp::ReadValueBinary(CBinaryReader& rbrReader)
+{
+	iValue = rbrReader.ReadInt32();
+}
+
 
 
 //-----------------------------------------------------------------------------
@@ -314,7 +337,6 @@ CIntConcept::CIntConcept(string sAName, int iAValue, float fAConfidence,
 	bWaitingConveyance = false;
 	cConveyance = cNotConveyed;
 	SetHistoryConcept(false);
-	pPrevConcept = NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -50,6 +50,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the binary encoding of the value
+//   [2026-10-19] (mbrenner): CIntHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -119,6 +121,11 @@ public:
 	CIntHyp(CIntHyp& rAIntHyp);
 	CIntHyp(int iAValue, float fAConfidence = 1.0);
 
+	// Pooled allocation (see DEFINE_HYP_POOL)
+	static void* operator new(size_t stSize);
+	static void operator delete(void* pBlock, size_t stSize);
+	static CFixedSizePool& GetPool();
+
 	//---------------------------------------------------------------------
 	// Overwritten, CIntHyp specific virtual functions
 	//---------------------------------------------------------------------
@@ -140,11 +147,20 @@ public:
 	//
 	virtual CHyp* operator [](string sItem);
 
+	// Value hash (consistent with the equality operator)
+	//
+	virtual unsigned int ValueHash();
+
 	// String conversion functions
 	//
 	virtual string ValueToString();
 	virtual string ToString();
 	virtual void FromString(string sString);
+
+	// Binary conversion functions
+	//
+	virtual void WriteValueBinary(CBinaryWriter& rbwWriter);
+	virtual void ReadValueBinary(CBinaryReader& rbrReader);
 };
 
 //-----------------------------------------------------------------------------
@@ -50,6 +50,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the binary encoding of the value
+//   [2026-10-19] (mbrenner): CStringHyp values are interned, reference 
+//                            counted shared strings
+//   [2026-10-19] (mbrenner): CStringHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -92,11 +96,13 @@
 // CStringHyp: Constructors and Destructors
 //-----------------------------------------------------------------------------
 
+// M: pooled allocation operators
+DEFINE_HYP_POOL(CStringHyp)
+
 // D: default constructor
 CStringHyp::CStringHyp()
 {
 	ctHypType = ctString;
-	sValue = "";
 	fConfidence = 0.0;
 }
 
@@ -104,7 +110,7 @@ CStringHyp::CStringHyp()
 CStringHyp::CStringHyp(CStringHyp& rAStringHyp)
 {
 	ctHypType = ctString;
-	sValue = rAStringHyp.sValue;
+	ssValue = rAStringHyp.ssValue;
 	fConfidence = rAStringHyp.fConfidence;
 }
 
@@ -112,7 +118,7 @@ CStringHyp::CStringHyp(CStringHyp& rAStringHyp)
 CStringHyp::CStringHyp(string sAValue, float fAConfidence)
 {
 	ctHypType = ctString;
-	sValue = sAValue;
+	ssValue = sAValue;
 	fConfidence = fAConfidence;
 }
 
@@ -123,7 +129,7 @@ CStringHyp::CStringHyp(string sAValue, float fAConfidence)
 // D: assignment operator from string
 CHyp& CStringHyp::operator = (string sAValue)
 {
-	sValue = sAValue;
+	ssValue = sAValue;
 	fConfidence = 1.0;
 	return *this;
 }
@@ -132,7 +138,7 @@ CHyp& CStringHyp::operator = (string sAValue)
 CHyp& CStringHyp::operator = (char *lpszValue)
 {
 	string aValue(lpszValue);
-	sValue = aValue;
+	ssValue = aValue;
 	fConfidence = 1.0;
 	return *this;
 }
@@ -152,7 +158,7 @@ CHyp& CStringHyp::operator = (CHyp& rAHyp)
 		}
 
 		CStringHyp& rAStringHyp = (CStringHyp&)rAHyp;
-		sValue = rAStringHyp.sValue;
+		ssValue = rAStringHyp.ssValue;
 		fConfidence = rAStringHyp.fConfidence;
 	}
 	return *this;
@@ -171,7 +177,7 @@ bool CStringHyp::operator == (CHyp& rAHyp)
 		return false;
 	}
 
-	return sValue == ((CStringHyp&)rAHyp).sValue;
+	return ssValue == ((CStringHyp&)rAHyp).ssValue;
 }
 
 // D: Comparison operator
@@ -215,23 +221,29 @@ CHyp* CStringHyp::operator [] (string sItem)
 	return NULL;
 }
 
+// M: Value hash
+unsigned int CStringHyp::ValueHash()
+{
+	return ssValue.GetHash();
+}
+
 // D: Convert value to string
 string CStringHyp::ValueToString()
 {
-	return sValue;
+	return ssValue.Get();
 }
 
 // D: Convert hyp to string
 string CStringHyp::ToString()
 {
-	return sValue + FormatString("%s%.2f", VAL_CONF_SEPARATOR, fConfidence);
+	return ssValue.Get() + FormatString("%s%.2f", VAL_CONF_SEPARATOR, fConfidence);
 }
 
 // D: Get the hyp from a string
 void CStringHyp::FromString(string sString)
 {
 	// separate the string into value and confidence 
-	string sConfidence;
+	string sValue, sConfidence;
 	SplitOnFirst(sString, VAL_CONF_SEPARATOR, sValue, sConfidence);
 	sValue = Trim(sValue);
 	sConfidence = Trim(sConfidence);
@@ -243,6 +255,7 @@ void CStringHyp::FromString(string sString)
 	{
 		sValue = sValue.substr(1, sValue.length() - 2);
 	}
+	ssValue = sValue;
 
 	// get the confidence 
 	if (sConfidence == "")
@@ -259,6 +272,18 @@ void CStringHyp::FromString(string sString)
 	}
 }
 
+// M: Write the value in the binary format
+void CStringHyp::WriteValueBinary(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteString(ssValue.Get());
+}
+
+// M: Read the value from the binary format
+void CStringHyp::ReadValueBinary(CBinaryReader& rbrReader)
+{
+	ssValue = rbrReader.ReadString();
+}
+
 
 
 //-----------------------------------------------------------------------------
@@ -295,7 +320,6 @@ CStringConcept::CStringConcept(string sAName, string sAValue, float fAConfidence
 	bWaitingConveyance = false;
 	cConveyance = cNotConveyed;
 	SetHistoryConcept(false);
-	pPrevConcept = NULL;
 }
 
 //-----------------------------------------------------------------------------
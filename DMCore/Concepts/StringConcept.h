@@ -50,6 +50,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the binary encoding of the value
+//   [2026-10-19] (mbrenner): CStringHyp values are interned, reference 
+//                            counted shared strings
+//   [2026-10-19] (mbrenner): CStringHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -107,8 +111,9 @@ protected:
 	//---------------------------------------------------------------------
 	// Protected member variables 
 	//---------------------------------------------------------------------
-	//
-	string sValue;
+	// (the value is a shared string, so copies of string hyps share it,
+	// and equality is a pointer comparison)
+	CSharedString ssValue;
 
 public:
 
@@ -120,6 +125,11 @@ public:
 	CStringHyp(string sAValue, float fAConfidence = 1.0);
 	CStringHyp(CStringHyp& rAStringHyp);
 
+	// Pooled allocation (see DEFINE_HYP_POOL)
+	static void* operator new(size_t stSize);
+	static void operator delete(void* pBlock, size_t stSize);
+	static CFixedSizePool& GetPool();
+
 
 	//---------------------------------------------------------------------
 	// Overwritten, CIntHyp specific virtual functions
@@ -143,11 +153,20 @@ public:
 	//
 	virtual CHyp* operator [](string sItem);
 
+	// Value hash (consistent with the equality operator)
+	//
+	virtual unsigned int ValueHash();
+
 	// String conversion functions
 	//
 	virtual string ValueToString();
 	virtual string ToString();
 	virtual void FromString(string sString);
+
+	// Binary conversion functions
+	//
+	virtual void WriteValueBinary(CBinaryWriter& rbwWriter);
+	virtual void ReadValueBinary(CBinaryReader& rbrReader);
 };
 
 
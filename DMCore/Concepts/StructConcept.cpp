@@ -50,6 +50,22 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added checkNewItem (duplicate item names are
+//                            rejected)
+//   [2026-10-19] (mbrenner): CStructHyp::SetConfidence unshares the item 
+//                            hypsets before changing them
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added the binary encoding of the hypset
+//   [2026-10-19] (mbrenner): updateFromString takes the update type enum
+//   [2026-10-19] (mbrenner): the items are now kept in a flat CItemMap (in
+//                            item order, with a sorted name index), and
+//                            accessed by position where possible
+//   [2026-10-19] (mbrenner): CStructHyp is allocated from a per-type pool
+//   [2026-10-19] (mbrenner): the history is now kept as an indexed vector of
+//                            versions (constant time append and indexed
+//                            access, bulk free) instead of a linked chain
+//   [2026-10-19] (mbrenner): keep the hyp slots of the structure and its 
+//                            items in sync
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -68,6 +84,102 @@
 
 #pragma warning (disable:4100)
 
+//-----------------------------------------------------------------------------
+// CItemMap class
+//-----------------------------------------------------------------------------
+
+// M: returns the position in viSortedItems at which an item name is (or 
+//    would be inserted)
+int CItemMap::lowerBound(const string& sItem)
+{
+	int iLow = 0;
+	int iHigh = (int)viSortedItems.size();
+	while (iLow < iHigh)
+	{
+		int iMiddle = (iLow + iHigh) / 2;
+		if (vItems[viSortedItems[iMiddle]].first < sItem)
+			iLow = iMiddle + 1;
+		else
+			iHigh = iMiddle;
+	}
+	return iLow;
+}
+
+// M: iteration (in declaration order)
+CItemMap::iterator CItemMap::begin()
+{
+	return vItems.begin();
+}
+
+CItemMap::iterator CItemMap::end()
+{
+	return vItems.end();
+}
+
+int CItemMap::size()
+{
+	return (int)vItems.size();
+}
+
+// M: finds an item by name
+CItemMap::iterator CItemMap::find(const string& sItem)
+{
+	int iIndex = GetItemIndex(sItem);
+	if (iIndex == -1)
+		return vItems.end();
+	return vItems.begin() + iIndex;
+}
+
+// M: inserts an item (unless an item with the same name already exists, in
+//    which case it returns false)
+bool CItemMap::insert(const value_type& vtItem)
+{
+	int iPosition = lowerBound(vtItem.first);
+	if ((iPosition < (int)viSortedItems.size()) &&
+		(vItems[viSortedItems[iPosition]].first == vtItem.first))
+		return false;
+	vItems.push_back(vtItem);
+	viSortedItems.insert(viSortedItems.begin() + iPosition, 
+		(int)vItems.size() - 1);
+	return true;
+}
+
+// M: access by name (inserts a NULL item if the name is not found, like
+//    std::map does)
+CConcept*& CItemMap::operator [](const string& sItem)
+{
+	int iIndex = GetItemIndex(sItem);
+	if (iIndex == -1)
+	{
+		insert(value_type(sItem, (CConcept *)NULL));
+		iIndex = (int)vItems.size() - 1;
+	}
+	return vItems[iIndex].second;
+}
+
+// M: removes all the items
+void CItemMap::clear()
+{
+	vItems.clear();
+	viSortedItems.clear();
+}
+
+// M: returns the item at a given position (in declaration order)
+CConcept* CItemMap::GetItemAt(int iIndex)
+{
+	return vItems[iIndex].second;
+}
+
+// M: returns the position of an item (in declaration order), -1 if not found
+int CItemMap::GetItemIndex(const string& sItem)
+{
+	int iPosition = lowerBound(sItem);
+	if ((iPosition < (int)viSortedItems.size()) &&
+		(vItems[viSortedItems[iPosition]].first == sItem))
+		return viSortedItems[iPosition];
+	return -1;
+}
+
 //-----------------------------------------------------------------------------
 // CStructHyp class
 //-----------------------------------------------------------------------------
@@ -76,6 +188,9 @@
 // CStructHyp: Constructors and destructors
 //-----------------------------------------------------------------------------
 
+// M: pooled allocation operators
+DEFINE_HYP_POOL(CStructHyp)
+
 // D: default constructor
 CStructHyp::CStructHyp(TItemMap* pAItemMap, TStringVector* psvAItems,
 	int iAHypIndex, bool bComplete)
@@ -92,11 +207,11 @@ CStructHyp::CStructHyp(TItemMap* pAItemMap, TStringVector* psvAItems,
 		CHyp* pItemHyp;
 		if (bComplete)
 		{
-			pItemHyp = pItemMap->operator [](psvItems->operator [](i))->GetHyp(iAHypIndex);
+			pItemHyp = pItemMap->GetItemAt(i)->GetHyp(iAHypIndex);
 		}
 		else
 		{
-			pItemHyp = pItemMap->operator [](psvItems->operator [](i))->GetPartialHyp(iAHypIndex);
+			pItemHyp = pItemMap->GetItemAt(i)->GetPartialHyp(iAHypIndex);
 		}
 		if (pItemHyp != NULL)
 		{
@@ -172,7 +287,7 @@ CHyp& CStructHyp::operator = (CHyp& rAHyp)
 				return *this;
 			}
 			// then copy that hypothesis into the right location
-			pItemMap->operator [](psvItems->operator [](i))->SetHyp(iHypIndex,
+			pItemMap->GetItemAt(i)->SetHyp(iHypIndex,
 				iPtr2->second->GetHyp(rAStructHyp.iHypIndex));
 		}
 
@@ -191,11 +306,15 @@ void CStructHyp::SetConfidence(float fAConfidence)
 	for (unsigned int i = 0; i < psvItems->size(); i++)
 	{
 		// get this item hyp
-		CHyp* pItemHyp =
-			pItemMap->operator [](psvItems->operator [](i))->GetHyp(iHypIndex);
+		CConcept* pItemConcept = pItemMap->GetItemAt(i);
+		CHyp* pItemHyp = pItemConcept->GetHyp(iHypIndex);
 		if (pItemHyp != NULL)
 		{
+			// the item hypotheses might be shared with other concepts
+			pItemConcept->unshareHypSet();
+			pItemHyp = pItemConcept->GetHyp(iHypIndex);
 			pItemHyp->SetConfidence(fAConfidence);
+			pItemConcept->syncHypSlot(iHypIndex);
 		}
 	}
 }
@@ -221,7 +340,7 @@ bool CStructHyp::operator == (CHyp& rAHyp)
 	{
 		// get this item hyp
 		CHyp* pItemHyp =
-			pItemMap->operator [](psvItems->operator [](i))->GetHyp(iHypIndex);
+			pItemMap->GetItemAt(i)->GetHyp(iHypIndex);
 		// check that the other one has it
 		TItemMap::iterator iPtr2 =
 			rAStructHyp.pItemMap->find(psvItems->operator [](i));
@@ -289,6 +408,20 @@ CHyp* CStructHyp::operator [](string sItem)
 	return pItemMap->operator [](sItem)->GetHyp(iHypIndex);
 }
 
+// M: Value hash, combines the value hashes of the items (as the equality 
+//    operator does, it treats null item hyps as a value of their own)
+unsigned int CStructHyp::ValueHash()
+{
+	unsigned int uiHash = FNV_HASH_SEED;
+	for (unsigned int i = 0; i < psvItems->size(); i++)
+	{
+		CHyp* pItemHyp =
+			pItemMap->GetItemAt(i)->GetHyp(iHypIndex);
+		uiHash = HashCombine(uiHash, pItemHyp ? pItemHyp->ValueHash() : 0);
+	}
+	return uiHash;
+}
+
 // D: Convert value to string
 string CStructHyp::ValueToString()
 {
@@ -299,7 +432,7 @@ string CStructHyp::ValueToString()
 	for (unsigned int i = 0; i < psvItems->size(); i++)
 	{
 		CHyp* pItemHyp =
-			pItemMap->operator [](psvItems->operator [](i))->GetHyp(iHypIndex);
+			pItemMap->GetItemAt(i)->GetHyp(iHypIndex);
 		// and add the string representation
 		if (pItemHyp)
 			sResult += FormatString("%s\t%s\n",
@@ -323,7 +456,7 @@ string CStructHyp::ToString()
 	for (unsigned int i = 0; i < psvItems->size(); i++)
 	{
 		CHyp* pItemHyp =
-			pItemMap->operator [](psvItems->operator [](i))->GetHyp(iHypIndex);
+			pItemMap->GetItemAt(i)->GetHyp(iHypIndex);
 		// and add the string representation
 		if (pItemHyp)
 			sResult += FormatString("%s\t%s\n",
@@ -367,9 +500,7 @@ CStructConcept::~CStructConcept()
 	// call destroy structure to destroy the current instantiation
 	DestroyStructure();
 	// and recursively destroy previous instantiations
-	if (pPrevConcept != NULL)
-		delete pPrevConcept;
-	pPrevConcept = NULL;
+	freeHistory();
 	// and finally the grounding model (if any)
 	if (pGroundingModel != NULL)
 	{
@@ -411,6 +542,17 @@ void CStructConcept::DestroyStructure()
 	svItems.clear();
 }
 
+// M: checks that an item about to be created (by the ITEM macro) is not a 
+//    duplicate: the items are accessed by position, pairing svItems[i] with
+//    ItemMap.GetItemAt(i), so each item name must be declared only once
+void CStructConcept::checkNewItem(string sItemName)
+{
+	if (ItemMap.find(sItemName) != ItemMap.end())
+		FatalError(FormatString(
+			"Duplicate item %s in structured concept %s.",
+			sItemName.c_str(), sName.c_str()));
+}
+
 //-----------------------------------------------------------------------------
 // CStructConcept: Access to various class members
 //-----------------------------------------------------------------------------
@@ -463,22 +605,13 @@ CConcept& CStructConcept::operator [](string sAItemName)
 
 	// check if index is negative and there is an active history, then 
 	// return the structured concept in history
-	if ((iFirstIndex < 0) && (pPrevConcept != NULL))
+	CConcept* pHistoryConcept = historyVersionAt(iFirstIndex);
+	if (pHistoryConcept != NULL)
 	{
-		// if adressing previous in history, return that
-		if (iFirstIndex == -1)
-		{
-			if (sFollowUp.empty())
-				return *pPrevConcept;
-			else
-				return pPrevConcept->operator [](sFollowUp);
-		}
+		if (sFollowUp.empty())
+			return *pHistoryConcept;
 		else
-		{
-			// o/w go recursively
-			return pPrevConcept->operator [](
-				FormatString("%d.%s", iFirstIndex + 1, sFollowUp.c_str()));
-		}
+			return pHistoryConcept->operator [](sFollowUp);
 	}
 	else
 	{
@@ -517,7 +650,7 @@ CConcept* CStructConcept::Clone(bool bCloneHistory)
 	for (unsigned int i = 0; i < svItems.size(); i++)
 	{
 		// clone a subitem
-		CConcept* pConceptToInsert = ItemMap[svItems[i]]->Clone();
+		CConcept* pConceptToInsert = ItemMap.GetItemAt(i)->Clone();
 		// reassign the owner concept
 		pConceptToInsert->SetOwnerConcept(pConcept);
 		// insert it
@@ -545,6 +678,7 @@ CConcept* CStructConcept::Clone(bool bCloneHistory)
 		pConcept->vhCurrentHypSet.push_back(
 		new CStructHyp(&(pConcept->ItemMap), &(pConcept->svItems), i));
 	pConcept->iNumValidHyps = iNumValidHyps;
+	pConcept->syncHypSlots();
 	pConcept->SetGroundedFlag(bGrounded);
 	pConcept->iCardinality = iCardinality;
 	pConcept->SetTurnLastUpdated(iTurnLastUpdated);
@@ -552,10 +686,8 @@ CConcept* CStructConcept::Clone(bool bCloneHistory)
 	// a clone does not wait for conveyance
 	pConcept->bWaitingConveyance = false;
 	pConcept->SetHistoryConcept(bHistoryConcept);
-	if (bCloneHistory && (pPrevConcept != NULL))
-		pConcept->pPrevConcept = pPrevConcept->Clone();
-	else
-		pConcept->pPrevConcept = NULL;
+	if (bCloneHistory)
+		cloneHistoryInto(pConcept);
 
 	// finally, return the clone
 	return pConcept;
@@ -690,7 +822,7 @@ void CStructConcept::Update_NPU_AssignFromString(void* pUpdateData)
 				// and if found, set its value accordingly
 				if (sConfidence != "")
 					sValue += VAL_CONF_SEPARATOR + sConfidence;
-				iPtr->second->Update(CU_ASSIGN_FROM_STRING, &sValue);
+				iPtr->second->Update(cuAssignFromString, &sValue);
 				// and mark it as updated
 				ssUpdated.insert(sItem);
 				// set the number of hypotheses
@@ -734,7 +866,7 @@ void CStructConcept::Update_NPU_AssignFromString(void* pUpdateData)
 			for (int h = 0; h < iUpdatedNumHyps; h++)
 			{
 				// this will notify the update
-				ItemMap[svItems[i]]->AddNullHyp();
+				ItemMap.GetItemAt(i)->AddNullHyp();
 			}
 		}
 	}
@@ -755,12 +887,13 @@ void CStructConcept::Update_NPU_AssignFromString(void* pUpdateData)
 // A: update partial hypotheses from a string
 void CStructConcept::Update_PartialFromString(void* pUpdateData)
 {
-	updateFromString(pUpdateData, CU_PARTIAL_FROM_STRING);
+	updateFromString(pUpdateData, cuPartialFromString);
 }
 
 // updates the concept from a string representation
 #pragma warning (disable:4189)
-void CStructConcept::updateFromString(void* pUpdateData, string sUpdateType)
+void CStructConcept::updateFromString(void* pUpdateData,
+	TConceptUpdateType cuUpdateType)
 {
 	// first, check that it's not a history concept
 	if (bHistoryConcept)
@@ -885,10 +1018,10 @@ void CStructConcept::updateFromString(void* pUpdateData, string sUpdateType)
 				// and if found, set its value accordingly
 				if (sConfidence != "")
 					sValue += VAL_CONF_SEPARATOR + sConfidence;
-				iPtr->second->Update(sUpdateType, &sValue);
+				iPtr->second->Update(cuUpdateType, &sValue);
 				// and mark it as updated
 				ssUpdated.insert(sItem);
-				if (sUpdateType == CU_PARTIAL_FROM_STRING)
+				if (cuUpdateType == cuPartialFromString)
 				{
 					// set the number of hypotheses
 					if (iUpdatedNumHyps == -1)
@@ -944,14 +1077,14 @@ void CStructConcept::updateFromString(void* pUpdateData, string sUpdateType)
 			// then update this concept with empty hypotheses
 			for (int h = 0; h < iUpdatedNumHyps; h++)
 			{
-				if (sUpdateType == CU_PARTIAL_FROM_STRING)
+				if (cuUpdateType == cuPartialFromString)
 				{
-					ItemMap[svItems[i]]->AddNullPartialHyp();
+					ItemMap.GetItemAt(i)->AddNullPartialHyp();
 				}
 				else
 				{
 					// this will notify the update
-					ItemMap[svItems[i]]->AddNullHyp();
+					ItemMap.GetItemAt(i)->AddNullHyp();
 				}
 			}
 		}
@@ -960,7 +1093,7 @@ void CStructConcept::updateFromString(void* pUpdateData, string sUpdateType)
 	// finally, update the valconf set
 	// first clear it (but without deleting the hypotheses from the 
 	//  concepts
-	if (sUpdateType == CU_PARTIAL_FROM_STRING)
+	if (cuUpdateType == cuPartialFromString)
 	{
 		CConcept::ClearPartialHypSet();
 		for (int h = 0; h < iUpdatedNumHyps; h++)
@@ -1000,12 +1133,12 @@ string CStructConcept::HypSetToString()
 		// go through the items and add them to the string
 		for (unsigned int i = 0; i < svItems.size(); i++)
 		{
-			if (ItemMap[svItems[i]]->IsUpdated() ||
-				ItemMap[svItems[i]]->HasPartialHyp())
+			if (ItemMap.GetItemAt(i)->IsUpdated() ||
+				ItemMap.GetItemAt(i)->HasPartialHyp())
 			{
 				sResult += FormatString("%s\t%s",
 					svItems[i].c_str(),
-					ItemMap[svItems[i]]->HypSetToString().c_str());
+					ItemMap.GetItemAt(i)->HypSetToString().c_str());
 			}
 		}
 		// and finally add the closing braces and return 
@@ -1029,7 +1162,7 @@ void CStructConcept::SetName(string sAName)
 	CConcept::SetName(sAName);
 	// sets the name recursively on each of the items
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->SetName(sName + "." + svItems[i]);
+		ItemMap.GetItemAt(i)->SetName(sName + "." + svItems[i]);
 }
 
 //-----------------------------------------------------------------------------
@@ -1043,7 +1176,7 @@ void CStructConcept::SetOwnerDialogAgent(CDialogAgent* pADialogAgent)
 	CConcept::SetOwnerDialogAgent(pADialogAgent);
 	// then set the owner an all subitems
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->SetOwnerDialogAgent(pADialogAgent);
+		ItemMap.GetItemAt(i)->SetOwnerDialogAgent(pADialogAgent);
 }
 
 //-----------------------------------------------------------------------------
@@ -1128,7 +1261,7 @@ void CStructConcept::CreateGroundingModel(string sGroundingModelSpec)
 			}
 		}
 		// now create the grounding model on the item
-		ItemMap[svItems[in]]->CreateGroundingModel(TrimRight(sItemGroundingModelSpec, ", "));
+		ItemMap.GetItemAt(in)->CreateGroundingModel(TrimRight(sItemGroundingModelSpec, ", "));
 	}
 }
 
@@ -1143,7 +1276,7 @@ void CStructConcept::DeclareGroundingModels(
 
 	// then add the grounding models for the subsumed concepts
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->DeclareGroundingModels(rgmpvModels, rgmpsExclude);
+		ItemMap.GetItemAt(i)->DeclareGroundingModels(rgmpvModels, rgmpsExclude);
 }
 
 // D: Declare the subsumed concepts
@@ -1157,7 +1290,7 @@ void CStructConcept::DeclareConcepts(
 
 	// then go through all the items and have them declare the concepts, too
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->DeclareConcepts(rcpvConcepts, rcpsExclude);
+		ItemMap.GetItemAt(i)->DeclareConcepts(rcpvConcepts, rcpsExclude);
 }
 
 //-----------------------------------------------------------------------------
@@ -1171,7 +1304,7 @@ void CStructConcept::SetChangeNotification(
 	bChangeNotification = bAChangeNotification;
 	// and set it for items
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->SetChangeNotification(bAChangeNotification);
+		ItemMap.GetItemAt(i)->SetChangeNotification(bAChangeNotification);
 }
 
 //-----------------------------------------------------------------------------
@@ -1195,7 +1328,7 @@ int CStructConcept::AddNewHyp()
 {
 	// add a hypothesis in all the members
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->AddNewHyp();
+		ItemMap.GetItemAt(i)->AddNewHyp();
 	// then add the corresponding entry in the hypset (this notifies the 
 	// change)
 	return AddHyp(new CStructHyp(&ItemMap, &svItems, vhCurrentHypSet.size()));
@@ -1206,7 +1339,7 @@ int CStructConcept::AddNullHyp()
 {
 	// add a null hypothesis in all the members
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->AddNullHyp();
+		ItemMap.GetItemAt(i)->AddNullHyp();
 	// then create the corresponding entry (this will notify the change)
 	return CConcept::AddNullHyp();
 }
@@ -1222,6 +1355,8 @@ void CStructConcept::SetHyp(int iIndex, CHyp* pHyp)
 	vhCurrentHypSet[iIndex] = new CStructHyp(&ItemMap, &svItems, iIndex);
 	// copy the contents (which will automatically copy into members)
 	*(vhCurrentHypSet[iIndex]) = *pHyp;
+	syncHypSlot(iIndex);
+	bHypValueIndexDirty = true;
 	iNumValidHyps++;
 	// notify the change
 	NotifyChange();
@@ -1233,7 +1368,7 @@ void CStructConcept::DeleteHyp(int iIndex)
 
 	// delete the hypothesis in all the members
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->DeleteHyp(iIndex);
+		ItemMap.GetItemAt(i)->DeleteHyp(iIndex);
 
 	if (vhCurrentHypSet[iIndex] != NULL)
 	{
@@ -1244,6 +1379,7 @@ void CStructConcept::DeleteHyp(int iIndex)
 
 	// then delete it from the array
 	vhCurrentHypSet.erase(vhCurrentHypSet.begin() + iIndex);
+	eraseHypSlot(iIndex);
 
 	// and reset the iHypIndex for all the hypotheses following
 	for (int i = iIndex; i < (int)vhCurrentHypSet.size(); i++)
@@ -1263,10 +1399,12 @@ void CStructConcept::SetNullHyp(int iIndex)
 	delete vhCurrentHypSet[iIndex];
 	// and set it to null
 	vhCurrentHypSet[iIndex] = NULL;
+	syncHypSlot(iIndex);
+	bHypValueIndexDirty = true;
 	// and call the same on all member items
 	// add a null hypothesis in all the members
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->SetNullHyp(iIndex);
+		ItemMap.GetItemAt(i)->SetNullHyp(iIndex);
 	// finally decrease the number of valid hypotheses and return
 	iNumValidHyps--;
 	// notify the change
@@ -1280,7 +1418,7 @@ void CStructConcept::ClearCurrentHypSet()
 	CConcept::ClearCurrentHypSet();
 	// clear the current hypsets for all the subsumed concepts
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->ClearCurrentHypSet();
+		ItemMap.GetItemAt(i)->ClearCurrentHypSet();
 }
 
 //-----------------------------------------------------------------------------
@@ -1292,7 +1430,7 @@ int CStructConcept::AddNewPartialHyp()
 {
 	// add a hypothesis in all the members
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->AddNewPartialHyp();
+		ItemMap.GetItemAt(i)->AddNewPartialHyp();
 
 	Log(CONCEPT_STREAM, "index of new hyp: %d", vhPartialHypSet.size());
 
@@ -1305,7 +1443,7 @@ int CStructConcept::AddNullPartialHyp()
 {
 	// add a null partial hypothesis in all the members
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->AddNullPartialHyp();
+		ItemMap.GetItemAt(i)->AddNullPartialHyp();
 	// then create the corresponding entry
 	return CConcept::AddNullPartialHyp();
 }
@@ -1320,7 +1458,86 @@ void CStructConcept::SetHistoryConcept(bool bAHistoryConcept)
 	bHistoryConcept = bAHistoryConcept;
 	// and set it for all the subconcepts
 	for (unsigned int i = 0; i < svItems.size(); i++)
-		ItemMap[svItems[i]]->SetHistoryConcept(bAHistoryConcept);
+		ItemMap.GetItemAt(i)->SetHistoryConcept(bAHistoryConcept);
+}
+
+//-----------------------------------------------------------------------------
+// Overwritten methods implementing the binary encoding
+//-----------------------------------------------------------------------------
+
+// M: writes the current hypset: which slots hold a structure hypothesis, 
+//    followed by the full state of the items (which hold the values)
+void CStructConcept::writeBinaryHypSet(CBinaryWriter& rbwWriter)
+{
+	rbwWriter.WriteUInt32((unsigned int)vhCurrentHypSet.size());
+	for (unsigned int i = 0; i < vhCurrentHypSet.size(); i++)
+		rbwWriter.WriteUInt8(vhCurrentHypSet[i] != NULL ? 1 : 0);
+	rbwWriter.WriteUInt32((unsigned int)svItems.size());
+	for (unsigned int i = 0; i < svItems.size(); i++)
+	{
+		rbwWriter.WriteString(svItems[i]);
+		ItemMap.GetItemAt(i)->WriteBinaryState(rbwWriter);
+	}
+}
+
+// M: reads the current hypset: restores the items, then rebuilds the 
+//    structure hypotheses over them (like Clone does)
+void CStructConcept::readBinaryHypSet(CBinaryReader& rbrReader)
+{
+	// clear the structure hypotheses (the items are restored below)
+	CConcept::ClearCurrentHypSet();
+
+	TIntVector viValidSlots;
+	int iNumSlots = (int)rbrReader.ReadUInt32();
+	for (int i = 0; (i < iNumSlots) && !rbrReader.Failed(); i++)
+		viValidSlots.push_back(rbrReader.ReadUInt8());
+
+	// restore the items
+	int iNumItems = (int)rbrReader.ReadUInt32();
+	for (int i = 0; (i < iNumItems) && !rbrReader.Failed(); i++)
+	{
+		string sItem = rbrReader.ReadString();
+		TItemMap::iterator iPtr = ItemMap.find(sItem);
+		if (iPtr == ItemMap.end())
+		{
+			FatalError(FormatString(
+				"Item %s not found in structured concept %s while restoring "\
+				"from binary.", sItem.c_str(), sName.c_str()));
+			return;
+		}
+		iPtr->second->ReadBinaryState(rbrReader);
+	}
+
+	// and rebuild the structure hypotheses
+	for (unsigned int i = 0; i < viValidSlots.size(); i++)
+	if (viValidSlots[i] == 0)
+		vhCurrentHypSet.push_back(NULL);
+	else
+	{
+		vhCurrentHypSet.push_back(new CStructHyp(&ItemMap, &svItems, i));
+		iNumValidHyps++;
+	}
+	syncHypSlots();
+}
+
+//-----------------------------------------------------------------------------
+// Overwritten methods for memory accounting
+//-----------------------------------------------------------------------------
+
+// M: accounts the memory held by the structure, and by its items
+void CStructConcept::AccountMemoryUsage(TMemoryAccount& rmaAccount,
+	const string& sComponent)
+{
+	CConcept::AccountMemoryUsage(rmaAccount, sComponent);
+
+	int iBytes = (int)(sizeof(CStructConcept) - sizeof(CConcept)) +
+		(int)(svItems.capacity() * sizeof(string));
+	for (unsigned int i = 0; i < svItems.size(); i++)
+		iBytes += StringHeapBytes(svItems[i]);
+	AccountMemory(rmaAccount, sComponent, 0, iBytes);
+
+	for (unsigned int i = 0; i < svItems.size(); i++)
+		ItemMap.GetItemAt(i)->AccountMemoryUsage(rmaAccount, sComponent);
 }
 
 #pragma warning (default:4100)
\ No newline at end of file
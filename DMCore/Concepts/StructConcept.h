@@ -50,6 +50,14 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): ITEM rejects duplicate item names
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
+//   [2026-10-19] (mbrenner): added the binary encoding of the hypset
+//   [2026-10-19] (mbrenner): updateFromString takes the update type enum
+//   [2026-10-19] (mbrenner): the items are now kept in a flat CItemMap (in
+//                            item order, with a sorted name index), and
+//                            accessed by position where possible
+//   [2026-10-19] (mbrenner): CStructHyp is allocated from a per-type pool
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
 //                            grounded
@@ -77,8 +85,48 @@
 // D: forward declaration of CStructConcept class
 class CStructConcept;
 
-// type definition for the list of items, kept as a hash for fast access
-typedef map<string, CConcept*, less<string>, allocator<CConcept *> > TItemMap;
+// M: the list of items of a structure. The items are kept in a flat vector,
+//    in the order in which they were declared (which is the order of the
+//    items in svItems, since duplicate item names are rejected, so that 
+//    svItems[i] and GetItemAt(i) are the same item), together with an 
+//    index of the items sorted by name for lookups. Structures have a handful of items, so this is cheaper 
+//    than a tree, and the items can be accessed by position; the class 
+//    provides the subset of the std::map interface used on the items
+class CItemMap
+{
+public:
+	typedef pair<string, CConcept*> value_type;
+	typedef vector<value_type>::iterator iterator;
+
+private:
+	vector<value_type> vItems;		// the items, in declaration order
+	TIntVector viSortedItems;		// the positions of the items, sorted by
+									//  item name
+
+	// returns the position in viSortedItems at which an item name is (or
+	// would be inserted)
+	int lowerBound(const string& sItem);
+
+public:
+	// iteration (in declaration order)
+	iterator begin();
+	iterator end();
+	int size();
+
+	// map-like access by name
+	iterator find(const string& sItem);
+	bool insert(const value_type& vtItem);
+	CConcept*& operator [](const string& sItem);
+	void clear();
+
+	// access by position: returns the item at a given position (in 
+	// declaration order), and the position of an item (-1 if not found)
+	CConcept* GetItemAt(int iIndex);
+	int GetItemIndex(const string& sItem);
+};
+
+// type definition for the list of items
+typedef CItemMap TItemMap;
 
 class CStructHyp : public CHyp
 {
@@ -113,6 +161,11 @@ public:
 
 	CStructHyp(CStructHyp& rAStructHyp);
 
+	// Pooled allocation (see DEFINE_HYP_POOL)
+	static void* operator new(size_t stSize);
+	static void operator delete(void* pBlock, size_t stSize);
+	static CFixedSizePool& GetPool();
+
 	//---------------------------------------------------------------------
 	// CStructHyp specific methods
 	//---------------------------------------------------------------------
@@ -142,6 +195,10 @@ public:
 	//
 	virtual CHyp* operator [](string sItem);
 
+	// Value hash (consistent with the equality operator)
+	//
+	virtual unsigned int ValueHash();
+
 	// String conversion functions
 	//
 	virtual string ValueToString();
@@ -202,6 +259,9 @@ public:
 	// Destroy the elements of the structure
 	virtual void DestroyStructure();
 
+	// Checks that an item about to be created (by ITEM) is not a duplicate
+	void checkNewItem(string sItemName);
+
 	//---------------------------------------------------------------------
 	// Overwritten methods for overall concept manipulation 
 	//---------------------------------------------------------------------
@@ -318,6 +378,14 @@ public:
 	// set the history concept flag
 	virtual void SetHistoryConcept(bool bAHistoryConcept = true);
 
+	//---------------------------------------------------------------------
+	// Overwritten methods for memory accounting
+	//---------------------------------------------------------------------
+
+	// account the memory held by the structure and its items
+	virtual void AccountMemoryUsage(TMemoryAccount& rmaAccount,
+		const string& sComponent = MA_CONCEPTS);
+
 protected:
 
 	//---------------------------------------------------------------------
@@ -325,7 +393,16 @@ protected:
 	//---------------------------------------------------------------------
 
 	// updates the concept from a string representation
-	virtual void updateFromString(void* pUpdateData, string sUpdateType);
+	virtual void updateFromString(void* pUpdateData, 
+		TConceptUpdateType cuUpdateType);
+
+	//---------------------------------------------------------------------
+	// Overwritten methods implementing the binary encoding
+	//---------------------------------------------------------------------
+
+	// write / read the binary encoding of the current hypset
+	virtual void writeBinaryHypSet(CBinaryWriter& rbwWriter);
+	virtual void readBinaryHypSet(CBinaryReader& rbrReader);
 
 };
 
@@ -377,6 +454,7 @@ public:\
 	// D: Macro for defining items in the derived structure class
 	// Dṹжĺ
 #define ITEM(Name, ConceptType)\
+	checkNewItem(#Name); \
 	ItemMap.insert(TItemMap::value_type(#Name, \
 	new ConceptType(sName + "." + #Name, csConceptSource))); \
 	ItemMap[#Name]->SetOwnerDialogAgent(pOwnerDialogAgent); \
@@ -109,6 +109,8 @@ TRavenClawConfigParams::TRavenClawConfigParams()
 	// initialize the dialog states file
 	//	#ʼԻ״̬ļ
 	Set(RCP_DIALOG_STATES_FILE, "");
+	// initialize the state broadcast mode (full or delta)
+	Set(RCP_STATE_BROADCAST_MODE, "full");
 	// initialize the grounding configuration
 	//#ʼӵ
 	Set(RCP_GROUNDING_MANAGER_CONFIGURATION, "full_grounding");// ??
@@ -55,6 +55,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added the state_broadcast_mode parameter
 //   [2003-05-13] (dbohus): changed so that configuration parameters are in a 
 //                           hash, which gets also logged
 //   [2002-12-03] (dbohus): fixed code so that bInSession is reset once dialog
@@ -115,6 +116,7 @@ extern DWORD g_idDMInterfaceThread;
 #define RCP_GROUNDING_POLICIES "grounding_policies"
 #define RCP_GROUNDING_POLICIES_FILE "grounding_policies_file"
 #define RCP_DIALOG_STATES_FILE "dialog_states_file"
+#define RCP_STATE_BROADCAST_MODE "state_broadcast_mode"
 #define RCP_GROUNDING_MANAGER_CONFIGURATION "grounding_manager_configuration"
 #define RCP_LOG_DIR "log_dir"
 #define RCP_LOG_PREFIX ""
@@ -50,6 +50,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the memory accounting of the session is logged
+//                            when the core terminates
+//   [2026-10-19] (mbrenner): the shared strings table size is logged at 
+//                            termination
 //   [2003-05-13] (dbohus): changed so that configuration parameters are in a 
 //                           hash, which gets also logged
 //   [2003-02-14] (dbohus): added pGroundingManager agent
@@ -156,6 +160,7 @@ void InitializeDialogCore(TRavenClawConfigParams rcpParams)
 	// ״̬㲥ַ
 	// ״̬ agentName -> stateName
 	pStateManager->LoadDialogStateNames(rcpParams.Get(RCP_DIALOG_STATES_FILE));
+	pStateManager->SetStateBroadcastMode(rcpParams.Get(RCP_STATE_BROADCAST_MODE));
 
 
 	//		create the dialog task tree manager
@@ -213,6 +218,9 @@ void TerminateDialogCore()
 {
 	Log(CORETHREAD_STREAM, "Terminating Core ...");
 
+	// log the memory accounting of the session
+	pDMCore->LogMemoryAccount();
+
 	//ɾкĵAgent
 	// destroy the core dialog management agent
 	delete pDMCore;
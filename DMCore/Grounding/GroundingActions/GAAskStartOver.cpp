@@ -52,6 +52,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
 //   [2006-01-24] (dbohus): started working on this
 // 
 //-----------------------------------------------------------------------------
@@ -69,6 +72,7 @@
 // strategy
 DEFINE_AGENCY(_CAskStartOver,
 	IS_NOT_DTS_AGENT()
+	CACHES_CONDITIONS
 	CONCEPT_BINDING_POLICY(WITHIN_TOPIC_ONLY)
 	DEFINE_CONCEPTS(
 	BOOL_USER_CONCEPT(want_start_over, ""))
@@ -52,6 +52,11 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the agents whose conditions only read concepts,
+//                            agents and the dialog manager state declare
+//                            CACHES_CONDITIONS
+//   [2026-10-19] (mbrenner): changing the confirmed concept invalidates the
+//                            concept handles
 //   [2007-03-09] (antoine): fixed a _CRequestConfirm so that it takes its
 //							 LM- and DTMF-related parameters from the
 //							 configuration of its parent agency
@@ -76,6 +81,7 @@
 
 DEFINE_AGENCY(_CExplicitConfirm,
 	IS_NOT_DTS_AGENT()
+	CACHES_CONDITIONS
 
 	private:
 		// D: the concept and value that are explicitly confirmed
@@ -86,6 +92,8 @@ DEFINE_AGENCY(_CExplicitConfirm,
 		void SetConfirmedConcept(CConcept* pAConfirmedConcept)
 		{
 			pConfirmedConcept = pAConfirmedConcept;
+			// LocalC resolves differently now
+			CDialogAgent::IncrementTreeGeneration();
 		}
 
 		// D: member function for accessing the concept that is confirmed
@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): changing the confirmed concept invalidates the
+//                            concept handles
 //   [2004-12-28] (antoine): added constructor with configuration
 //   [2003-04-15] (dbohus): started working on this
 // 
@@ -81,6 +83,8 @@ DEFINE_INFORM_AGENT(_CImplicitConfirmInform,
 		void SetConfirmedConcept(CConcept* pAConfirmedConcept)
 		{
 			pConfirmedConcept = pAConfirmedConcept;
+			// LocalC resolves differently now
+			CDialogAgent::IncrementTreeGeneration();
 			pConfirmedHyp = pConfirmedConcept->GetTopHyp();
 		}
 
@@ -143,6 +147,8 @@ DEFINE_INFORM_AGENT(_CImplicitConfirmInform,
 		void SetConfirmedConcept(CConcept* pAConfirmedConcept)
 		{
 			pConfirmedConcept = pAConfirmedConcept;
+			// LocalC resolves differently now
+			CDialogAgent::IncrementTreeGeneration();
 			pConfirmedHyp = pConfirmedConcept->GetTopHyp();
 		}
 
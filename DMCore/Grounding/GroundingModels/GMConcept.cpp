@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the state-space check uses the compiled policy
+//   [2026-10-19] (mbrenner): the copy constructor shares the compiled policy
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-02-24] (dbohus): addeded support for full state and collapsed state
@@ -81,7 +83,7 @@ CGMConcept::CGMConcept(CGMConcept& rAGMConcept)
 {
 	sModelPolicy = rAGMConcept.sModelPolicy;
 	sName = rAGMConcept.sName;
-	pPolicy = rAGMConcept.pPolicy;
+	pcpCompiledPolicy = rAGMConcept.pcpCompiledPolicy;
 	viActionMappings = rAGMConcept.viActionMappings;
 	sExplorationMode = rAGMConcept.sExplorationMode;
 	fExplorationParameter = rAGMConcept.fExplorationParameter;
@@ -168,17 +170,17 @@ bool CGMConcept::LoadPolicy()
 	else if (!bExternalPolicy)
 	{
 		// then check that the model has the presumed state-space
-		if (pPolicy.size() != 4)
+		if (getPolicyNumStates() != 4)
 		{
 			FatalError(FormatString("Error in CGMConcept::LoadPolicy(). "\
 				"Invalid state-space size for policy %s (4 states expected, "\
-				"%d found).", sModelPolicy.c_str(), pPolicy.size()));
+				"%d found).", sModelPolicy.c_str(), getPolicyNumStates()));
 			return false;
 		}
-		else if ((pPolicy[0].sStateName != SS_INACTIVE) ||
-			(pPolicy[1].sStateName != SS_CONFIDENT) ||
-			(pPolicy[2].sStateName != SS_UNCONFIDENT) ||
-			(pPolicy[3].sStateName != SS_GROUNDED))
+		else if ((getPolicyStateName(0) != SS_INACTIVE) ||
+			(getPolicyStateName(1) != SS_CONFIDENT) ||
+			(getPolicyStateName(2) != SS_UNCONFIDENT) ||
+			(getPolicyStateName(3) != SS_GROUNDED))
 		{
 			FatalError("Error in CGMConcept::LoadPolicy(). Invalid "\
 				"state-space.");
@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the state-space check uses the compiled policy
+//   [2026-10-19] (mbrenner): the copy constructor shares the compiled policy
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-02-24] (dbohus): addeded support for full state and collapsed state
@@ -81,7 +83,7 @@ CGMRequestAgent::CGMRequestAgent(CGMRequestAgent& rAGMRequestAgent)
 {
 	sModelPolicy = rAGMRequestAgent.sModelPolicy;
 	sName = rAGMRequestAgent.sName;
-	pPolicy = rAGMRequestAgent.pPolicy;
+	pcpCompiledPolicy = rAGMRequestAgent.pcpCompiledPolicy;
 	viActionMappings = rAGMRequestAgent.viActionMappings;
 	sExplorationMode = rAGMRequestAgent.sExplorationMode;
 	fExplorationParameter = rAGMRequestAgent.fExplorationParameter;
@@ -170,16 +172,16 @@ bool CGMRequestAgent::LoadPolicy()
 	else if (!bExternalPolicy)
 	{
 		// then check that the model has the presumed state-space
-		if (pPolicy.size() != 3)
+		if (getPolicyNumStates() != 3)
 		{
 			FatalError(FormatString("Error in CGMRequestAgent::LoadPolicy(). "\
 				"Invalid state-space size (3 states expected, %d found).",
-				pPolicy.size()));
+				getPolicyNumStates()));
 			return false;
 		}
-		else if ((pPolicy[0].sStateName != SS_FAILED) ||
-			(pPolicy[1].sStateName != SS_UNDERSTANDING) ||
-			(pPolicy[2].sStateName != SS_NONUNDERSTANDING))
+		else if ((getPolicyStateName(0) != SS_FAILED) ||
+			(getPolicyStateName(1) != SS_UNDERSTANDING) ||
+			(getPolicyStateName(2) != SS_NONUNDERSTANDING))
 		{
 			FatalError("Error in CGMRequestAgent::LoadPolicy(). Invalid "\
 				"state-space.");
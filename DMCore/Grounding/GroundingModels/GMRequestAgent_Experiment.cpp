@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the state-space check uses the compiled policy
+//   [2026-10-19] (mbrenner): the copy constructor shares the compiled policy
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-12-29] (antoine): started working on this based on GMRequestAgent
@@ -81,7 +83,7 @@ CGMRequestAgent_Experiment::CGMRequestAgent_Experiment(
 
 	sModelPolicy = rAGMRequestAgent_Experiment.sModelPolicy;
 	sName = rAGMRequestAgent_Experiment.sName;
-	pPolicy = rAGMRequestAgent_Experiment.pPolicy;
+	pcpCompiledPolicy = rAGMRequestAgent_Experiment.pcpCompiledPolicy;
 	viActionMappings = rAGMRequestAgent_Experiment.viActionMappings;
 	sExplorationMode = rAGMRequestAgent_Experiment.sExplorationMode;
 	fExplorationParameter = rAGMRequestAgent_Experiment.fExplorationParameter;
@@ -136,26 +138,26 @@ bool CGMRequestAgent_Experiment::LoadPolicy()
 	else if (!bExternalPolicy)
 	{
 		// then check that the model has the presumed state-space
-		if (pPolicy.size() != 10)
+		if (getPolicyNumStates() != 10)
 		{
 			FatalError(FormatString("Error in CGMRequestAgent_Experiment::LoadPolicy(). "\
 				"Invalid state-space size (10 states expected, %d found).",
-				pPolicy.size()));
+				getPolicyNumStates()));
 			return false;
 		}
-		else if ((pPolicy[0].sStateName != SS_FAILED) ||
-			(pPolicy[1].sStateName != SS_UNDERSTANDING) ||
-			(pPolicy[2].sStateName != SS_VERY_FIRST_NONUNDERSTANDING_CTL) ||
-			(pPolicy[3].sStateName != SS_NONUNDERSTANDING_1_CTL) ||
-			(pPolicy[4].sStateName != SS_NONUNDERSTANDING_2_CTL) ||
-			(pPolicy[5].sStateName != SS_NONUNDERSTANDING_MORE_CTL) ||
-			(pPolicy[6].sStateName != SS_VERY_FIRST_NONUNDERSTANDING_EXP) ||
-			(pPolicy[7].sStateName != SS_NONUNDERSTANDING_1_EXP) ||
-			(pPolicy[8].sStateName != SS_NONUNDERSTANDING_2_EXP) ||
-			(pPolicy[9].sStateName != SS_NONUNDERSTANDING_MORE_EXP))
+		else if ((getPolicyStateName(0) != SS_FAILED) ||
+			(getPolicyStateName(1) != SS_UNDERSTANDING) ||
+			(getPolicyStateName(2) != SS_VERY_FIRST_NONUNDERSTANDING_CTL) ||
+			(getPolicyStateName(3) != SS_NONUNDERSTANDING_1_CTL) ||
+			(getPolicyStateName(4) != SS_NONUNDERSTANDING_2_CTL) ||
+			(getPolicyStateName(5) != SS_NONUNDERSTANDING_MORE_CTL) ||
+			(getPolicyStateName(6) != SS_VERY_FIRST_NONUNDERSTANDING_EXP) ||
+			(getPolicyStateName(7) != SS_NONUNDERSTANDING_1_EXP) ||
+			(getPolicyStateName(8) != SS_NONUNDERSTANDING_2_EXP) ||
+			(getPolicyStateName(9) != SS_NONUNDERSTANDING_MORE_EXP))
 		{
 			FatalError(FormatString("Error in CGMRequestAgent_Experiment::LoadPolicy(). Invalid "\
-				"state-space. [%s]", pPolicy[2].sStateName.c_str()).c_str());
+				"state-space. [%s]", getPolicyStateName(2).c_str()).c_str());
 			return false;
 		}
 	}
@@ -51,6 +51,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the copy constructor shares the compiled policy
 //   [2008-06-03] (antoine): started working on this based on GMRequestAgent
 // 
 //-----------------------------------------------------------------------------
@@ -231,7 +232,7 @@ CGMRequestAgent_HandCrafted::CGMRequestAgent_HandCrafted(
 {
 	sModelPolicy = rAGMRequestAgent_HandCrafted.sModelPolicy;
 	sName = rAGMRequestAgent_HandCrafted.sName;
-	pPolicy = rAGMRequestAgent_HandCrafted.pPolicy;
+	pcpCompiledPolicy = rAGMRequestAgent_HandCrafted.pcpCompiledPolicy;
 	viActionMappings = rAGMRequestAgent_HandCrafted.viActionMappings;
 	sExplorationMode = rAGMRequestAgent_HandCrafted.sExplorationMode;
 	fExplorationParameter = rAGMRequestAgent_HandCrafted.fExplorationParameter;
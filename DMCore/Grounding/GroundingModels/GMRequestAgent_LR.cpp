@@ -53,6 +53,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the copy constructor shares the compiled policy
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2005-12-14] (dbohus): started working on this based on GMRequestAgent
@@ -76,7 +77,7 @@ CGMRequestAgent_LR::CGMRequestAgent_LR(string sAModelPolicy, string sAName):
 CGMRequestAgent_LR::CGMRequestAgent_LR(CGMRequestAgent_LR& rAGMRequestAgent_LR) {
     sModelPolicy = rAGMRequestAgent_LR.sModelPolicy;
     sName = rAGMRequestAgent_LR.sName;
-    pPolicy = rAGMRequestAgent_LR.pPolicy;
+    pcpCompiledPolicy = rAGMRequestAgent_LR.pcpCompiledPolicy;
     viActionMappings = rAGMRequestAgent_LR.viActionMappings;
     sExplorationMode = rAGMRequestAgent_LR.sExplorationMode;
     fExplorationParameter = rAGMRequestAgent_LR.fExplorationParameter;
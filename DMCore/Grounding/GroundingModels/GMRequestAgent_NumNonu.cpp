@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the state-space check uses the compiled policy
+//   [2026-10-19] (mbrenner): the copy constructor shares the compiled policy
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-12-29] (antoine): started working on this based on GMRequestAgent
@@ -80,7 +82,7 @@ CGMRequestAgent_NumNonu::CGMRequestAgent_NumNonu(CGMRequestAgent_NumNonu&
 
 	sModelPolicy = rAGMRequestAgent_NumNonu.sModelPolicy;
 	sName = rAGMRequestAgent_NumNonu.sName;
-	pPolicy = rAGMRequestAgent_NumNonu.pPolicy;
+	pcpCompiledPolicy = rAGMRequestAgent_NumNonu.pcpCompiledPolicy;
 	viActionMappings = rAGMRequestAgent_NumNonu.viActionMappings;
 	sExplorationMode = rAGMRequestAgent_NumNonu.sExplorationMode;
 	fExplorationParameter = rAGMRequestAgent_NumNonu.fExplorationParameter;
@@ -135,22 +137,22 @@ bool CGMRequestAgent_NumNonu::LoadPolicy()
 	else if (!bExternalPolicy)
 	{
 		// then check that the model has the presumed state-space
-		if (pPolicy.size() != 6)
+		if (getPolicyNumStates() != 6)
 		{
 			FatalError(FormatString("Error in CGMRequestAgent_NumNonu::LoadPolicy(). "\
 				"Invalid state-space size (6 states expected, %d found).",
-				pPolicy.size()));
+				getPolicyNumStates()));
 			return false;
 		}
-		else if ((pPolicy[0].sStateName != SS_FAILED) ||
-			(pPolicy[1].sStateName != SS_UNDERSTANDING) ||
-			(pPolicy[2].sStateName != SS_VERY_FIRST_NONUNDERSTANDING) ||
-			(pPolicy[3].sStateName != SS_NONUNDERSTANDING_1) ||
-			(pPolicy[4].sStateName != SS_NONUNDERSTANDING_2) ||
-			(pPolicy[5].sStateName != SS_NONUNDERSTANDING_MORE))
+		else if ((getPolicyStateName(0) != SS_FAILED) ||
+			(getPolicyStateName(1) != SS_UNDERSTANDING) ||
+			(getPolicyStateName(2) != SS_VERY_FIRST_NONUNDERSTANDING) ||
+			(getPolicyStateName(3) != SS_NONUNDERSTANDING_1) ||
+			(getPolicyStateName(4) != SS_NONUNDERSTANDING_2) ||
+			(getPolicyStateName(5) != SS_NONUNDERSTANDING_MORE))
 		{
 			FatalError(FormatString("Error in CGMRequestAgent_NumNonu::LoadPolicy(). Invalid "\
-				"state-space. [%s]", pPolicy[2].sStateName.c_str()).c_str());
+				"state-space. [%s]", getPolicyStateName(2).c_str()).c_str());
 			return false;
 		}
 	}
@@ -51,6 +51,17 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the parsed policies cache is keyed by policy file,
+//                            and replaces an entry when the policy key (file
+//                            time and text hash) changes
+//   [2026-10-19] (mbrenner): LoadPolicy compiles the policy straight from
+//                            the cached parsed policy (no per-model copy)
+//   [2026-10-19] (mbrenner): LoadPolicy uses a process-wide cache of parsed
+//                            policies, keyed by policy name and file time
+//   [2026-10-19] (mbrenner): added CCompiledPolicy; the models share the 
+//                            compiled (dense) form of their policy, and 
+//                            compute the action values from it
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-02-24] (dbohus): addeded support for full state and collapsed state
@@ -64,6 +75,9 @@
 #include "GroundingModel.h"
 #include "../../../DMCore/Core.h"
 
+// the process-wide cache of parsed policies
+TParsedPolicies CGroundingModel::mapParsedPolicies;
+
 //-----------------------------------------------------------------------------
 //
 // D: CExternalPolicyInterface class
@@ -245,6 +259,102 @@ int CExternalPolicyInterface::ComputeSuggestedActionIndex(CState& rState)
 //
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+// M: CCompiledPolicy class
+//-----------------------------------------------------------------------------
+
+// M: constructor - compiles a parsed policy (the actions missing from the
+//    parsed policy are available, with a value of 0)
+CCompiledPolicy::CCompiledPolicy(TPolicy& rpPolicy, int iANumActions)
+{
+	iNumStates = (int)rpPolicy.size();
+	iNumActions = iANumActions;
+	iMaskWords = (iNumActions + POLICY_MASK_WORD_BITS - 1) / 
+		POLICY_MASK_WORD_BITS;
+	vfValues.resize(iNumStates * iNumActions, 0);
+	vuiAvailable.resize(iNumStates * iMaskWords, 0);
+	for (int s = 0; s < iNumStates; s++)
+	{
+		vsStateNames.push_back(rpPolicy[s].sStateName);
+		for (int a = 0; a < iNumActions; a++)
+		{
+			map<int, float>::iterator iPtr = 
+				rpPolicy[s].i2fActionsValues.find(a);
+			float fValue = (iPtr == rpPolicy[s].i2fActionsValues.end()) ?
+				0 : iPtr->second;
+			if (fValue == UNAVAILABLE_ACTION)
+				continue;
+			vfValues[s * iNumActions + a] = fValue;
+			vuiAvailable[s * iMaskWords + a / POLICY_MASK_WORD_BITS] |=
+				1u << (a % POLICY_MASK_WORD_BITS);
+		}
+	}
+}
+
+// M: access to the number of states
+int CCompiledPolicy::GetNumStates()
+{
+	return iNumStates;
+}
+
+// M: access to the number of actions
+int CCompiledPolicy::GetNumActions()
+{
+	return iNumActions;
+}
+
+// M: access to the name of a state
+string CCompiledPolicy::GetStateName(int iState)
+{
+	return vsStateNames[iState];
+}
+
+// M: checks if an action is available from a state
+bool CCompiledPolicy::IsAvailable(int iState, int iAction)
+{
+	return (vuiAvailable[iState * iMaskWords + 
+		iAction / POLICY_MASK_WORD_BITS] & 
+		(1u << (iAction % POLICY_MASK_WORD_BITS))) != 0;
+}
+
+// M: computes the expected values of the actions for a belief state. This
+//    is a product of the belief vector with the value matrix (the 
+//    unavailable actions are stored as 0, so they do not contribute); the
+//    availability masks of the states with a non-zero belief determine 
+//    which actions are available
+void CCompiledPolicy::ComputeActionValues(CBeliefDistribution& rbdBeliefState,
+	CBeliefDistribution& rbdActionValues)
+{
+	vector<unsigned int> vuiReached(iMaskWords, 0);
+	for (int a = 0; a < iNumActions; a++)
+		rbdActionValues[a] = 0;
+	for (int s = 0; s < iNumStates; s++)
+	{
+		float fBelief = rbdBeliefState[s];
+		if (fBelief == 0) continue;
+		float* pfRow = &vfValues[s * iNumActions];
+		for (int a = 0; a < iNumActions; a++)
+			rbdActionValues[a] += pfRow[a] * fBelief;
+		for (int w = 0; w < iMaskWords; w++)
+			vuiReached[w] |= vuiAvailable[s * iMaskWords + w];
+	}
+	for (int a = 0; a < iNumActions; a++)
+	if (!(vuiReached[a / POLICY_MASK_WORD_BITS] &
+		(1u << (a % POLICY_MASK_WORD_BITS))))
+		rbdActionValues[a] = UNAVAILABLE_ACTION;
+}
+
+// M: returns the number of heap bytes held by the policy
+int CCompiledPolicy::GetHeapBytes()
+{
+	int iBytes = (int)(vsStateNames.capacity() * sizeof(string) +
+		vfValues.capacity() * sizeof(float) +
+		vuiAvailable.capacity() * sizeof(unsigned int));
+	for (unsigned int i = 0; i < vsStateNames.size(); i++)
+		iBytes += StringHeapBytes(vsStateNames[i]);
+	return iBytes;
+}
+
 //-----------------------------------------------------------------------------
 // D: Constructors and Destructors
 //-----------------------------------------------------------------------------
@@ -257,6 +367,7 @@ CGroundingModel::CGroundingModel(string sAModelPolicy, string sAName)
 	bExternalPolicy = false;
 	sExternalPolicyHost = "localhost:0";
 	pepiExternalPolicy = NULL;
+	pcpCompiledPolicy = NULL;
 	sExplorationMode = "epsilon-greedy";
 	fExplorationParameter = (float)0.2;
 	iSuggestedActionIndex = -1;
@@ -270,7 +381,7 @@ CGroundingModel::CGroundingModel(CGroundingModel& rAGroundingModel)
 	bExternalPolicy = rAGroundingModel.bExternalPolicy;
 	sExternalPolicyHost = rAGroundingModel.sExternalPolicyHost;
 	pepiExternalPolicy = rAGroundingModel.pepiExternalPolicy;
-	pPolicy = rAGroundingModel.pPolicy;
+	pcpCompiledPolicy = rAGroundingModel.pcpCompiledPolicy;
 	viActionMappings = rAGroundingModel.viActionMappings;
 	sExplorationMode = rAGroundingModel.sExplorationMode;
 	fExplorationParameter = rAGroundingModel.fExplorationParameter;
@@ -323,6 +434,19 @@ void CGroundingModel::SetName(string sAName)
 	sName = sAName;
 }
 
+// M: accounts the memory held by the model (the compiled policy is shared,
+//    and is accounted for by the grounding manager)
+void CGroundingModel::AccountMemoryUsage(TMemoryAccount& rmaAccount)
+{
+	int iBytes = sizeof(CGroundingModel) + StringHeapBytes(sName) +
+		StringHeapBytes(sModelPolicy) + StringHeapBytes(sExternalPolicyHost) +
+		StringHeapBytes(sExplorationMode) +
+		(int)(viActionMappings.capacity() * sizeof(int)) +
+		stFullState.GetHeapBytes() + bdBeliefState.GetHeapBytes() +
+		bdActionValues.GetHeapBytes();
+	AccountMemory(rmaAccount, MA_GROUNDING_MODELS, 1, iBytes);
+}
+
 //-----------------------------------------------------------------------------
 // D: Grounding model specific public methods
 //-----------------------------------------------------------------------------
@@ -333,6 +457,14 @@ void CGroundingModel::Initialize()
 {
 	if (!LoadPolicy())
 		FatalError(FormatString("Invalid policy for grounding model %s.", sModelPolicy.c_str()));
+	// the models with their own policy parsers fill in pPolicy: obtain 
+	// the compiled policy for it (shared with the other models that use the
+	// same policy), and release the parsed one
+	if ((pcpCompiledPolicy == NULL) && !pPolicy.empty())
+		pcpCompiledPolicy = pGroundingManager->GetCompiledPolicy(
+		pGroundingManager->GetPolicyKey(sModelPolicy), pPolicy, 
+		(int)viActionMappings.size());
+	pPolicy.clear();
 }
 
 /*
@@ -348,9 +480,10 @@ void CGroundingModel::Initialize()
 		UNCONFIDENT       -19           10            5
 		GROUNDED           10            -            -
 */
-// D: Loads the model policy (from the grounding manager agent)
+// D: Parses a policy (the string data obtained from the grounding manager
+//    agent)
 // DģͲԣӽӵع
-bool CGroundingModel::LoadPolicy()
+bool CGroundingModel::parsePolicy(string sData, TParsedPolicy& rppPolicy)
 {
 	//	get the string data
 	//	string sModelPolicy = expl expl_impl request_default request_lr...
@@ -362,8 +495,6 @@ bool CGroundingModel::LoadPolicy()
 					UNCONFIDENT       -19           10            5
 					GROUNDED           10            -            -
 				*/
-	string sData = pGroundingManager->GetPolicy(sModelPolicy);// s2sPolicies[sModelName];
-
 	// parse it - first break it into lines
 	TStringVector vsLines = PartitionString(sData, "\n");
 	bool bExplorationModeLine = true;
@@ -391,9 +522,9 @@ bool CGroundingModel::LoadPolicy()
 			if (ToLowerCase(Trim(sTemp1)) == "exploration_mode")
 			{
 				// set the external policy flag to false
-				bExternalPolicy = false;
+				rppPolicy.bExternalPolicy = false;
 				// set the exploration mode
-				sExplorationMode = ToLowerCase(Trim(sTemp2));
+				rppPolicy.sExplorationMode = ToLowerCase(Trim(sTemp2));
 				// and next, set the expectation for the exploration parameter line
 				bExplorationModeLine = false;
 				bExplorationParameterLine = true;
@@ -402,9 +533,9 @@ bool CGroundingModel::LoadPolicy()
 			else if (ToLowerCase(Trim(sTemp1)) == "external_policy_host")
 			{
 				// set the external policy flag to true
-				bExternalPolicy = true;
+				rppPolicy.bExternalPolicy = true;
 				// set the host
-				sExternalPolicyHost = ToLowerCase(Trim(sTemp2));
+				rppPolicy.sExternalPolicyHost = ToLowerCase(Trim(sTemp2));
 				bExplorationModeLine = false;
 				bExplorationParameterLine = false;
 				bExternalPolicyHostLine = false;
@@ -420,7 +551,7 @@ bool CGroundingModel::LoadPolicy()
 			if (ToLowerCase(Trim(sTemp1)) != "exploration_parameter")
 				return false;
 			// set the exploration parameter
-			fExplorationParameter = (float)atof(Trim(sTemp2).c_str());
+			rppPolicy.fExplorationParameter = (float)atof(Trim(sTemp2).c_str());
 			// and next, set the expectation for the exploration parameter line
 			bExplorationParameterLine = false;
 			bActionsLine = true;
@@ -431,20 +562,18 @@ bool CGroundingModel::LoadPolicy()
 			TStringVector vsActions = PartitionString(vsLines[i], " \t");
 			// check that there are some actions in the model
 			if (vsActions.size() < 1) return false;
-			// construct the action index vector
-			for (unsigned int a = 0; a < vsActions.size(); a++)
-				viActionMappings.push_back(
-				pGroundingManager->GroundingActionNameToIndex(vsActions[a]));
+			// store the action names
+			rppPolicy.vsActionNames = vsActions;
 			// set actions line to false
 			bActionsLine = false;
 		}
-		else if (!bExternalPolicy)
+		else if (!rppPolicy.bExternalPolicy)
 		{
 			// if it's not the first line, then it will be a line containing a 
 			// state and the values
 			TStringVector vsValues = PartitionString(vsLines[i], " \t");
 			// check that there's enough values
-			if (vsValues.size() != viActionMappings.size() + 1)
+			if (vsValues.size() != rppPolicy.vsActionNames.size() + 1)
 				return false;
 
 			// construct the state-action-utility datastructure
@@ -467,12 +596,67 @@ bool CGroundingModel::LoadPolicy()
 			}
 
 			// push it in the policy
-			pPolicy.push_back(savData);
+			rppPolicy.pPolicy.push_back(savData);
 
 		}
 		i++;
 	}
 
+	rppPolicy.bValid = true;
+	return true;
+}
+
+// M: Loads the model policy (from the grounding manager agent). Policies 
+//    are parsed once per process (the cache is keyed by policy file, and 
+//    holds the version of the file with the current policy key); each model
+//    then only maps the action names to the grounding manager action indices
+bool CGroundingModel::LoadPolicy()
+{
+	string sPolicyFile = pGroundingManager->GetPolicyFile(sModelPolicy);
+	string sPolicyKey = pGroundingManager->GetPolicyKey(sModelPolicy);
+
+	// if the policy was not parsed yet, or the file changed since it was 
+	// parsed, parse it now (replacing the older version)
+	TParsedPolicies::iterator iPtr = mapParsedPolicies.find(sPolicyFile);
+	if ((iPtr == mapParsedPolicies.end()) || 
+		(iPtr->second.sPolicyKey != sPolicyKey))
+	{
+		TParsedPolicy ppPolicy;
+		ppPolicy.bValid = false;
+		ppPolicy.bExternalPolicy = bExternalPolicy;
+		ppPolicy.sExternalPolicyHost = sExternalPolicyHost;
+		ppPolicy.sExplorationMode = sExplorationMode;
+		ppPolicy.fExplorationParameter = fExplorationParameter;
+		ppPolicy.sPolicyKey = sPolicyKey;
+		parsePolicy(pGroundingManager->GetPolicy(sModelPolicy), ppPolicy);
+		if (iPtr != mapParsedPolicies.end())
+			mapParsedPolicies.erase(iPtr);
+		iPtr = mapParsedPolicies.insert(
+			TParsedPolicies::value_type(sPolicyFile, ppPolicy)).first;
+	}
+	TParsedPolicy& rppPolicy = iPtr->second;
+	if (!rppPolicy.bValid)
+		return false;
+
+	// set the model parameters from the parsed policy
+	bExternalPolicy = rppPolicy.bExternalPolicy;
+	sExternalPolicyHost = rppPolicy.sExternalPolicyHost;
+	sExplorationMode = rppPolicy.sExplorationMode;
+	fExplorationParameter = rppPolicy.fExplorationParameter;
+
+	// construct the action index vector
+	for (unsigned int a = 0; a < rppPolicy.vsActionNames.size(); a++)
+		viActionMappings.push_back(
+		pGroundingManager->GroundingActionNameToIndex(
+			rppPolicy.vsActionNames[a]));
+
+	// obtain the compiled policy straight from the cached parsed policy
+	// (the compiled policy is shared with the other models that use the
+	// same policy, so the parsed policy is not copied into the model)
+	if (!rppPolicy.pPolicy.empty())
+		pcpCompiledPolicy = pGroundingManager->GetCompiledPolicy(
+		sPolicyKey, rppPolicy.pPolicy, (int)viActionMappings.size());
+
 	// resize the bdActionValues vector accordingly
 	bdActionValues.Resize(viActionMappings.size());
 
@@ -484,6 +668,23 @@ bool CGroundingModel::LoadPolicy()
 	return true;
 }
 
+// M: returns the number of states in the policy (from the compiled policy,
+//    or from the parsed one for the models with their own policy parsers)
+int CGroundingModel::getPolicyNumStates()
+{
+	if (pcpCompiledPolicy != NULL)
+		return pcpCompiledPolicy->GetNumStates();
+	return (int)pPolicy.size();
+}
+
+// M: returns the name of a state in the policy
+string CGroundingModel::getPolicyStateName(int iState)
+{
+	if (pcpCompiledPolicy != NULL)
+		return pcpCompiledPolicy->GetStateName(iState);
+	return pPolicy[iState].sStateName;
+}
+
 // D: Compute the state of the model
 // Dģ͵״̬
 void CGroundingModel::ComputeState()
@@ -512,47 +713,17 @@ void CGroundingModel::ComputeActionValuesDistribution()
 		GROUNDED           10            -            -
 	*/
 
-	//		for each action
-	// <1>	ÿAction
-	for (unsigned int a = 0; a < viActionMappings.size(); a++)//ÿaction[ACCEPT     EXPL_CONF    IMPL_CONF]
+	// the action values are the product of the belief state with the 
+	// compiled policy
+	if (pcpCompiledPolicy != NULL)
 	{
+		pcpCompiledPolicy->ComputeActionValues(bdBeliefState, bdActionValues);
+		return;
+	}
 
-		//		compute its expected utility by summing over the states
-		// <2>	ͨ״̬Ч
-		bdActionValues[a] = 0;
-		bool bUnavailableAction = true;
-		// <3>	ÿstate [INACTIVE, CONFIDENT, UNCONFIDENT, GROUNDED]
-		for (unsigned int s = 0; s < pPolicy.size(); s++)//ÿstate [INACTIVE, CONFIDENT, UNCONFIDENT, GROUNDED]
-		{
-			float fStateActionValue = pPolicy[s].i2fActionsValues[a];
-			//		if the action is available from that state, 
-			// <4>	ӵģеǰstateĵǰactionԶpolicyп
-			if (fStateActionValue != UNAVAILABLE_ACTION)
-			{
-				/*
-				岽裺
-					1 - ÿAction									=>	a
-					2 - ÿState									=>	s
-					3 - ȡԶõpolicyеĵǰstateactionֵ		=>	policy[s][a]
-					4 - ͳƵbdBeliefStateеǰ״̬				=> 01ֵ
-					5 - ЧþĵǰActionֵ						=>	bdActionValues[a] += fStateActionValue*bdBeliefState[s]
-					6 - ע⣬ÿActionЧֵpolicyActionУͳƵState
-				*/
-				// ǰͳƵstate,0 [0,1ֵ]
-				if (bdBeliefState[s] != 0)
-				{
-					// update the utility
-					// Чþ => [ǰActionֵ]
-					bdActionValues[a] += fStateActionValue*bdBeliefState[s];// 10(еֵ) * [pConcept->GetTopHypConfidence()]
-					bUnavailableAction = false;
-				}
-			}
-		}//ÿstate[INACTIVE, CONFIDENT, UNCONFIDENT, GROUNDED]
-		if (bUnavailableAction)
-		{
-			bdActionValues[a] = UNAVAILABLE_ACTION;
-		}
-	}//ÿaction[ACCEPT     EXPL_CONF    IMPL_CONF]
+	// o/w (no policy states), no action is available
+	for (unsigned int a = 0; a < viActionMappings.size(); a++)
+		bdActionValues[a] = UNAVAILABLE_ACTION;
 }
 
 // D: Compute the suggested action index - be default, the action that 
@@ -661,10 +832,12 @@ void CGroundingModel::LogStateAction()
 string CGroundingModel::beliefStateToString()
 {
 	string sResult;
-	for (unsigned int i = 0; i < pPolicy.size(); i++)
+	if (pcpCompiledPolicy == NULL)
+		return sResult;
+	for (int i = 0; i < pcpCompiledPolicy->GetNumStates(); i++)
 	{
 		sResult += FormatString("%s:%.2f  ",
-			pPolicy[i].sStateName.c_str(), bdBeliefState[i]);
+			pcpCompiledPolicy->GetStateName(i).c_str(), bdBeliefState[i]);
 	}
 	return sResult;
 }
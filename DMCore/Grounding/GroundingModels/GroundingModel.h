@@ -51,6 +51,14 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the parsed policies are keyed by policy file, and
+//                            hold the policy key they were parsed for
+//   [2026-10-19] (mbrenner): added getPolicyNumStates and getPolicyStateName
+//   [2026-10-19] (mbrenner): parsed policies are cached process-wide, keyed by
+//                            policy name and policy file time
+//   [2026-10-19] (mbrenner): added CCompiledPolicy; the models share the 
+//                            compiled (dense) form of their policy
+//   [2026-10-19] (mbrenner): added AccountMemoryUsage
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-02-24] (dbohus): addeded support for full state and collapsed state
@@ -89,6 +97,78 @@ typedef struct
 // DȻ󽫲ԶΪ ״̬//ֵ 
 typedef vector<TStateActionsValues> TPolicy;
 
+// M: structure holding a parsed policy, in a form that does not depend on 
+//    the grounding manager (actions are kept by name)
+typedef struct {
+	bool bValid;                    // indicates the policy parsed correctly
+	bool bExternalPolicy;
+	string sExternalPolicyHost;
+	string sExplorationMode;
+	float fExplorationParameter;
+	TStringVector vsActionNames;
+	TPolicy pPolicy;
+	string sPolicyKey;              // the key of the policy contents (see
+	                                // GetPolicyKey in the grounding manager)
+} TParsedPolicy;
+
+// M: type definition for the cache of parsed policies (key = policy 
+//    file; an entry is replaced when the policy key changes)
+typedef map<string, TParsedPolicy> TParsedPolicies;
+
+// M: the number of bits in a word of the availability bitmask
+#define POLICY_MASK_WORD_BITS	32
+
+//-----------------------------------------------------------------------------
+// CCompiledPolicy Class - 
+//   This class holds the compiled (dense) form of a policy: the values as a
+//     states x actions matrix (row-major), and a bitmask indicating which
+//     actions are available from each state. Compiled policies are immutable
+//     and are shared by all the models that use the same policy (they are 
+//     owned by the grounding manager)
+//-----------------------------------------------------------------------------
+class CCompiledPolicy
+{
+
+private:
+	//---------------------------------------------------------------------
+	// Private members
+	//---------------------------------------------------------------------
+
+	int iNumStates;                 // the dimensions of the policy
+	int iNumActions;
+	int iMaskWords;                 // the number of mask words for a state
+	TStringVector vsStateNames;     // the names of the states
+	vector<float> vfValues;         // the values (0 for unavailable actions)
+	vector<unsigned int> vuiAvailable;
+	// the availability bitmask (iMaskWords 
+	//  words for each state)
+
+public:
+	//---------------------------------------------------------------------
+	// Constructors and destructors
+	//---------------------------------------------------------------------
+
+	CCompiledPolicy(TPolicy& rpPolicy, int iANumActions);
+
+	//---------------------------------------------------------------------
+	// Access to the policy
+	//---------------------------------------------------------------------
+
+	int GetNumStates();
+	int GetNumActions();
+	string GetStateName(int iState);
+	bool IsAvailable(int iState, int iAction);
+
+	// Computes the expected values of the actions for a belief state over
+	// the policy states (UNAVAILABLE_ACTION for the actions that are not
+	// available from any state with a non-zero belief)
+	void ComputeActionValues(CBeliefDistribution& rbdBeliefState,
+		CBeliefDistribution& rbdActionValues);
+
+	// Returns the number of heap bytes held by the policy
+	int GetHeapBytes();
+};
+
 //-----------------------------------------------------------------------------
 // CExternalPolicyInterface Class - 
 //   This class implements an interface to an external policy (a policy that 
@@ -139,6 +219,12 @@ protected:
 	string sModelPolicy;// the model policy name	  expl, expl_impl, [request_default request_lr...]
 
 	TPolicy pPolicy;    // the policy for the model: for each state, a state-actions-values structure
+	// (this is only the parsed form of the policy,
+	//  filled in by the models with their own policy
+	//  parsers, and released once compiled)
+	CCompiledPolicy* pcpCompiledPolicy;
+	// the compiled form of the policy (shared with 
+	//  the other models using the same policy)
 	//###############################################################################################################################
 	bool bExternalPolicy;							//ʾⲿģʵ־߲
 	// indicates that an external module is used for
@@ -211,6 +297,9 @@ public:
 	virtual string GetName();
 	virtual void SetName(string sAName);
 
+	// Account the memory held by the model (including its policy)
+	virtual void AccountMemoryUsage(TMemoryAccount& rmaAccount);
+
 	//---------------------------------------------------------------------
 	// Fundamental grounding model methods. These are to be overwritten by 
 	// by derived grounding model classes
@@ -274,6 +363,20 @@ protected:
 	//
 	string beliefStateToString();
 	string actionValuesToString();
+
+	// Access to the states of the policy (used when checking the 
+	// state-space of the policy)
+	//
+	int getPolicyNumStates();
+	string getPolicyStateName(int iState);
+
+	// Parses a policy string (fills in rppPolicy, which comes in with the
+	// default settings)
+	static bool parsePolicy(string sData, TParsedPolicy& rppPolicy);
+
+	// the process-wide cache of parsed policies, so that each policy file
+	// is parsed only once
+	static TParsedPolicies mapParsedPolicies;
 };
 
 // D: type definition for a vector of grounding model pointers
@@ -52,6 +52,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added GetHeapBytes to CState and 
+//                            CBeliefDistribution
+//   [2026-10-19] (mbrenner): Normalize and GetModeEvent use the vectorized 
+//                            float vector kernels; implemented Sharpen
 //   [2004-02-24] (dbohus): added CState
 //   [2004-02-10] (dbohus): changed so that belief distribution can have 
 //                           invalid events
@@ -96,6 +100,12 @@ string CState::ToString()
 	return S2SHashToString(s2sStateVars, "\n") + "\n";
 }
 
+// M: returns the number of heap bytes held by the state
+int CState::GetHeapBytes()
+{
+	return S2SHeapBytes(s2sStateVars);
+}
+
 //-----------------------------------------------------------------------------
 //
 // D: CBeliefDistribution
@@ -187,10 +197,17 @@ int CBeliefDistribution::GetValidEventsNumber()
 	int iEventsNumber = 0;
 	for (unsigned int i = 0; i < vfProbability.size(); i++)
 	if (vfProbability[i] != INVALID_EVENT)
-		iEventsNumber++;
+			iEventsNumber++;
 	return iEventsNumber;
 }
 
+// M: Access to the number of heap bytes held by the distribution
+int CBeliefDistribution::GetHeapBytes()
+{
+	return (int)((vfProbability.capacity() + vfProbabilityLowBound.capacity() +
+		vfProbabilityHiBound.capacity()) * sizeof(float));
+}
+
 //-----------------------------------------------------------------------------
 // D: Functions for transforming the distribution
 //-----------------------------------------------------------------------------
@@ -199,23 +216,21 @@ int CBeliefDistribution::GetValidEventsNumber()
 void CBeliefDistribution::Normalize()
 {
 	// compute the normalization constant
-	float fNormalizer = 0;
-	for (unsigned int i = 0; i < vfProbability.size(); i++)
-	if (vfProbability[i] != INVALID_EVENT)
-	{
-		fNormalizer += vfProbability[i];
-	}
+	float fNormalizer = SumFloatVector(vfProbability, INVALID_EVENT);
 	// normalize
 	if (fNormalizer != 0)
 	{
-		for (unsigned int i = 0; i < vfProbability.size(); i++)
-		if (vfProbability[i] != INVALID_EVENT)
-		{
-			vfProbability[i] = vfProbability[i] / fNormalizer;
-		}
+		ScaleFloatVector(vfProbability, 1 / fNormalizer, INVALID_EVENT);
 	}
 }
 
+// M: Sharpen the distribution
+void CBeliefDistribution::Sharpen(float fPower)
+{
+	PowerFloatVector(vfProbability, fPower, INVALID_EVENT);
+	Normalize();
+}
+
 //-----------------------------------------------------------------------------
 // Functions for choosing a particular action from the distribution
 //-----------------------------------------------------------------------------
@@ -224,17 +239,7 @@ void CBeliefDistribution::Normalize()
 // Dؾ߸/ЧõĶ
 int CBeliefDistribution::GetModeEvent()
 {
-	int iMaxIndex = -1;
-	float fMaxProbability = 0;
-	for (unsigned int i = 0; i < vfProbability.size(); i++)
-	{
-		if (vfProbability[i] > fMaxProbability)
-		{
-			fMaxProbability = vfProbability[i];
-			iMaxIndex = i;
-		}
-	}
-	return iMaxIndex;
+	return ArgMaxFloatVector(vfProbability);
 }
 
 // D: return the action with the highest upper bound on the probability/utility
@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added GetHeapBytes to CState and 
+//                            CBeliefDistribution
 //   [2004-02-24] (dbohus): added CState
 //   [2004-02-10] (dbohus): changed so that belief distribution can have 
 //                           invalid events
@@ -103,6 +105,9 @@ public:
 
 	// string conversion function
 	string ToString();
+
+	// returns the number of heap bytes held by the state
+	int GetHeapBytes();
 };
 
 //-----------------------------------------------------------------------------
@@ -157,6 +162,10 @@ public:
 	//
 	int GetValidEventsNumber();
 
+	// Obtain the number of heap bytes held by the distribution
+	//
+	int GetHeapBytes();
+
 	//---------------------------------------------------------------------
 	// Various functions for transforming the distribution
 	//---------------------------------------------------------------------
@@ -50,6 +50,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added IsLoggingStreamActive
 //   [2004-03-15] (dbohus):  fixed bug in logging long strings to the screen
 //   [2003-05-13] (dbohus):  changed InitializeLogging function to work with 
 //                            the new configuration parameters
@@ -213,6 +214,19 @@ void DisableAllLoggingStreams()
 		iPtr->second.bEnabled = false;
 }
 
+// M: Check if a logging stream is active (displayed, or enabled and logging
+//    to file)
+bool IsLoggingStreamActive(string sStreamName)
+{
+	TLoggingStreamsHash::iterator iPtr;
+
+	// if the stream is not defined, it's not active
+	if ((iPtr = lshLogStreams.find(sStreamName)) == lshLogStreams.end())
+		return false;
+
+	return iPtr->second.bDisplayed || (fileLog && iPtr->second.bEnabled);
+}
+
 
 //-----------------------------------------------------------------------------
 // Logging defines, levels, function etc
@@ -50,6 +50,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added IsLoggingStreamActive
 //   [2004-03-15] (dbohus):  fixed bug in logging long strings to the screen
 //   [2003-05-13] (dbohus):  changed InitializeLogging function to work with 
 //                            the new configuration parameters
@@ -153,6 +154,10 @@ void EnableAllLoggingStreams();
 // D: Disable all logging streams
 void DisableAllLoggingStreams();
 
+// M: Check if a logging stream is active, i.e. if logging on it produces 
+//    any output (on the screen or in the log file)
+bool IsLoggingStreamActive(string sStreamName);
+
 
 //-----------------------------------------------------------------------------
 // Logging Functions
@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): Create takes the generator agent, instead of 
+//                            looking it up in the registry by name
 //   [2005-06-02] (antoine): added the possibility to have a "prompt_header" and
 //                           "prompt_ending" parameters in the OutputManager's 
 //                           configuration, the values of which get appended 
@@ -127,13 +129,13 @@ COutput* CFrameOutput::Clone(int iNewOutputId)
 // D: creates the internal representation starting from a string description
 //    of the prompt. Returns false if an output cannot be created
 // Dʾַʼڲʾ ޷򷵻false
-bool CFrameOutput::Create(string sAGeneratorAgentName,	int iAExecutionIndex, string sAOutput, TFloorStatus fsAFloor, int iAOutputId)
+bool CFrameOutput::Create(CDialogAgent* pAGeneratorAgent, int iAExecutionIndex, string sAOutput, TFloorStatus fsAFloor, int iAOutputId)
 {
 
 	//		set the prompt id and caller agent name
 	// <1>	ʾIDɴ
 	iOutputId = iAOutputId;
-	sGeneratorAgentName = sAGeneratorAgentName;
+	sGeneratorAgentName = pAGeneratorAgent?pAGeneratorAgent->GetName():"";
 	fsFinalFloorStatus = fsAFloor; //Ľʱfloor״̬ ö٣λáϵͳûɡ
 
 	//		Set the state index and string representation
@@ -143,14 +145,12 @@ bool CFrameOutput::Create(string sAGeneratorAgentName,	int iAExecutionIndex, str
 
 	//		gets a reference to the sending agent
 	// <3>	ȡagent
-	CDialogAgent *pdaGenerator = (CDialogAgent *)AgentsRegistry[sGeneratorAgentName];
+	CDialogAgent *pdaGenerator = pAGeneratorAgent;
 	if (pdaGenerator == NULL)
 	{
-		// if we can't locate the generator agent
-		Warning(FormatString("Could not get a pointer to generator agent %s "\
-			"for frame-output (dump below). Output could not"\
-			" be created.\n%s",
-			sGeneratorAgentName.c_str(),
+		// if we don't have a generator agent
+		Warning(FormatString("No generator agent for frame-output (dump "\
+			"below). Output could not be created.\n%s",
 			sAOutput.c_str()));
 		return false;
 	}
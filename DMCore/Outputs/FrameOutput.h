@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): Create takes the generator agent (instead of its
+//                            name)
 //   [2005-01-11] (antoine): changed ToString so that it includes a slot giving
 //							  the number of times the output has been repeated
 //   [2004-02-24] (dbohus):  changed outputs so that we no longer clone 
@@ -119,7 +121,7 @@ public:
 
 	// Overwritten virtual method which creates a certain frame output 
 	// from a given string-represented prompt 
-	virtual bool Create(string sAGeneratorAgentName, int iAExecutionIndex,
+	virtual bool Create(CDialogAgent* pAGeneratorAgent, int iAExecutionIndex,
 		string sAOutput, TFloorStatus fsAFloor, int iAOutputId);
 
 	// Overwritten virtual method which clones an output
@@ -53,6 +53,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added RenewConceptNotificationRequest
 //   [2005-10-22] (antoine): added method GetGeneratorAgentName
 //   [2005-10-20] (antoine): added a sDialogState field sent along with the
 //                           output (this is for the InteractionManager)
@@ -306,6 +307,14 @@ void COutput::CancelConceptNotificationRequest(CConcept* pConcept)
 		vbNotifyConcept[i] = false;
 }
 
+// M: Renews the notification request for one of the concepts
+void COutput::RenewConceptNotificationRequest(CConcept* pConcept)
+{
+	for (unsigned int i = 0; i < vcpConcepts.size(); i++)
+	if (vcpConcepts[i] == pConcept)
+		vbNotifyConcept[i] = true;
+}
+
 // D: Changes the pointers for one of the concepts (this happens on 
 // reopens and other operations which change the concept pointers)
 void COutput::ChangeConceptNotificationPointer(CConcept* pOldConcept,
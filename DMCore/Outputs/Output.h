@@ -52,6 +52,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): Create takes the generator agent (instead of its
+//                            name)
+//   [2026-10-19] (mbrenner): added RenewConceptNotificationRequest
 //	 [2007-02-08] (antoine): added bIsFinalOutput
 //   [2005-10-22] (antoine): added method GetGeneratorAgentName
 //   [2005-10-20] (antoine): added a sDialogState field sent along with the
@@ -165,7 +168,7 @@ public:
 	// Pure virtual method which creates a certain output from a given
 	// string-represented prompt
 	//鷽Ӹַʾһض
-	virtual bool Create(string sAGeneratorAgentName, int iAExecutionIndex, string sAPrompt, TFloorStatus fsAFloor, int iAOutputId) = 0;
+	virtual bool Create(CDialogAgent* pAGeneratorAgent, int iAExecutionIndex, string sAPrompt, TFloorStatus fsAFloor, int iAOutputId) = 0;
 
 	// Pure virtual method which generates a string representation for the
 	// output that will be sent to the external output component (i.e. 
@@ -225,6 +228,10 @@ public:
 	// ȡһ֪ͨ
 	void CancelConceptNotificationRequest(CConcept* pConcept);
 
+	// Renews the notification request for one of the concepts (when the
+	// concept is restored to a state in which it was waiting for conveyance)
+	void RenewConceptNotificationRequest(CConcept* pConcept);
+
 	// Changes the pointers for one of the concepts (this happens on 
 	// reopens and other operations which change the concept pointers)
 	// һָ루ⷢ´򿪺ĸָĲ
@@ -56,6 +56,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added get_memory_usage function
+//   [2026-10-19] (mbrenner): added resync_dialog_state function
 //   [2005-02-08] (antoine,dbohus): added DMI_SendEndSession function
 //   [2004-05-07] (dbohus): making blocking calls through GalIO_DispatchViaHub
 //   [2004-04-01] (dbohus): fixed potential buffer overrun problem
@@ -100,6 +102,8 @@ extern "C"
 #include <set>
 
 extern COutputManagerAgent *pOutputManager;
+extern CStateManagerAgent *pStateManager;
+extern CDMCoreAgent *pDMCore;
 
 //-----------------------------------------------------------------------------
 // Galaxy Interface internal variables
@@ -590,6 +594,45 @@ Gal_Frame reinitialize(Gal_Frame frame, void *server_data)
 	return frame;
 }
 
+//-----------------------------------------------------------------------------
+// M: this function is called by a consumer of the dialog state broadcast 
+//    when it receives a delta against a version it has not seen; the next
+//    broadcast will be a base snapshot
+//-----------------------------------------------------------------------------
+Gal_Frame resync_dialog_state(Gal_Frame frame, void *server_data)
+{
+	// update hub communication structures and incoming frame
+	pLastGalSS_Environment = (GalSS_Environment *)server_data;
+	pHubCommStruct = GalSS_EnvComm(pLastGalSS_Environment);
+	gfIncomingFrame = frame;
+
+	DMI_DisplayMessage("resync_dialog_state called.", 1);
+	if (pStateManager)
+		pStateManager->RequestStateResync();
+	return frame;
+}
+
+//-----------------------------------------------------------------------------
+// M: this function is called to query the memory accounting of the session;
+//    the accounting walks the dialog task tree, so it should be queried 
+//    between turns. The result is returned in the :memory_usage slot
+//-----------------------------------------------------------------------------
+Gal_Frame get_memory_usage(Gal_Frame frame, void *server_data)
+{
+	// update hub communication structures and incoming frame
+	pLastGalSS_Environment = (GalSS_Environment *)server_data;
+	pHubCommStruct = GalSS_EnvComm(pLastGalSS_Environment);
+	gfIncomingFrame = frame;
+
+	DMI_DisplayMessage("get_memory_usage called.", 1);
+	// the string needs to outlive the returned frame
+	static string sMemoryUsage;
+	sMemoryUsage = pDMCore ? pDMCore->GetMemoryAccountAsString() : "";
+	Gal_SetProp(frame, ":memory_usage",
+		Gal_StringObject((char *)sMemoryUsage.c_str()));
+	return frame;
+}
+
 //-----------------------------------------------------------------------------
 // D: this function is called by the Galaxy architecture when a
 //    timeout period elapses
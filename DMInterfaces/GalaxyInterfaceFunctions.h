@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added get_memory_usage
+//   [2026-10-19] (mbrenner): added resync_dialog_state
 //   [2003-03-17] (dbohus): changed so that the server name and port are 
 //                           specified from the dialog task
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
@@ -82,3 +84,5 @@ GAL_SERVER_OP(start_inactivity_timeout)
 GAL_SERVER_OP(cancel_inactivity_timeout)
 GAL_SERVER_OP(reinitialize)
 GAL_SERVER_OP(handle_event)
+GAL_SERVER_OP(resync_dialog_state)
+GAL_SERVER_OP(get_memory_usage)
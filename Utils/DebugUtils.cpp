@@ -51,6 +51,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added RunConditionCacheTests
+//   [2026-10-19] (mbrenner): added RunVectorKernelsTests (tolerance check
+//                            and microbenchmark for the vector kernels)
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
 //   [2001-12-29] (dbohus): started working on this
 // 
@@ -59,6 +62,7 @@
 #include "../Utils/DebugUtils.h"
 #include "../Utils/Utils.h"
 #include "../DMCore/Concepts/AllConcepts.h"
+#include "../DMCore/Agents/AllAgents.h"
 #include "../DMInterfaces/DMInterface.h"
 
 //-----------------------------------------------------------------------------
@@ -68,12 +72,272 @@
 #ifdef _RUN_DEBUGGING_TESTS
 
 DEFINE_STRUCT_CONCEPT_TYPE( CMyStruct,
-    ITEM(a, CIntConcept, none)
-    ITEM(b, CIntConcept, none)
-    ITEM(c, CStringConcept, none)
+    ITEM(a, CIntConcept)
+    ITEM(b, CIntConcept)
+    ITEM(c, CStringConcept)
 )
 #endif // _TESTING_WITH_MAIN
 
 void RunDebuggingTests()
 {
+	RunVectorKernelsTests();
+	RunConditionCacheTests();
+}
+
+//-----------------------------------------------------------------------------
+// Tests for the condition cache (see DialogAgent.h)
+//-----------------------------------------------------------------------------
+
+// M: the number of times the precondition of the test agency was evaluated
+static int iConditionCacheTestEvaluations = 0;
+
+// M: agency used by the condition cache tests; the precondition counts its 
+//    evaluations, and reads a concept of the agency. The concept gets no 
+//    grounding model, as the tests run before the grounding manager exists
+DEFINE_AGENCY(CConditionCacheTestAgency,
+	CACHES_CONDITIONS
+	PRECONDITION((++iConditionCacheTestEvaluations > 0) && 
+		!C("value").IsInvalidated())
+	DEFINE_CONCEPTS(
+		Concepts.push_back(new CIntConcept("value", csSystem));
+		Concepts.back()->SetOwnerDialogAgent(this);
+	)
+)
+
+// M: checks that a cached precondition is reused while the state it read 
+//    is unchanged, and is evaluated again once the concept it read, or the 
+//    agent status, changes; the results are printed on the standard output,
+//    and the function returns the number of failed checks
+int RunConditionCacheTests()
+{
+	int iFailures = 0;
+	CConditionCacheTestAgency daTest("ConditionCacheTest");
+	daTest.Create();
+	iConditionCacheTestEvaluations = 0;
+
+	// the first call evaluates the precondition, the second one hits the
+	// cache
+	bool bFirst = daTest.PreconditionsSatisfied();
+	bool bSecond = daTest.PreconditionsSatisfied();
+	bool bHit = bFirst && bSecond && (iConditionCacheTestEvaluations == 1);
+	printf("condition cache hit: %s\n", bHit?"ok":"FAILED");
+	if (!bHit) iFailures++;
+
+	// changing the concept invalidates the cached value
+	daTest.C("value").SetInvalidatedFlag(true);
+	bool bThird = daTest.PreconditionsSatisfied();
+	bool bConceptChange = !bThird && (iConditionCacheTestEvaluations == 2);
+	printf("condition cache invalidation on concept change: %s\n", 
+		bConceptChange?"ok":"FAILED");
+	if (!bConceptChange) iFailures++;
+
+	// the new value is cached again
+	daTest.PreconditionsSatisfied();
+	bool bRehit = (iConditionCacheTestEvaluations == 2);
+	printf("condition cache hit after invalidation: %s\n", 
+		bRehit?"ok":"FAILED");
+	if (!bRehit) iFailures++;
+
+	// changing the agent status invalidates the cached value
+	daTest.IncrementExecuteCounter();
+	daTest.PreconditionsSatisfied();
+	bool bStatusChange = (iConditionCacheTestEvaluations == 3);
+	printf("condition cache invalidation on agent status change: %s\n", 
+		bStatusChange?"ok":"FAILED");
+	if (!bStatusChange) iFailures++;
+
+	return iFailures;
+}
+
+//-----------------------------------------------------------------------------
+// Tests for the vectorized kernels over float vectors (see Utils.h)
+//-----------------------------------------------------------------------------
+
+// M: the relative tolerance allowed between the vectorized and the scalar
+//    sums (the vectorized sums accumulate in a different order)
+#define VECTOR_KERNELS_TOLERANCE ((float)1e-4)
+
+// M: the value marking the elements skipped by the sums in the tests (the
+//    empty hypothesis slots, as in the concept updates)
+#define VECTOR_KERNELS_SKIP_VALUE ((float)-1.0)
+
+// M: the number of elements processed for each timing (the calls are 
+//    repeated until this many elements have been processed)
+#define VECTOR_KERNELS_BENCHMARK_ELEMENTS 4000000
+
+// M: scalar reference versions of the kernels
+static float scalarSumFloatVector(const vector<float>& vfValues, 
+	float fSkipValue)
+{
+	float fSum = 0;
+	for (unsigned int i = 0; i < vfValues.size(); i++)
+		if (vfValues[i] != fSkipValue)
+			fSum += vfValues[i];
+	return fSum;
+}
+
+static float scalarMultiplyFloatVectors(vector<float>& vfResult, 
+	const vector<float>& vfA, const vector<float>& vfB)
+{
+	float fSum = 0;
+	vfResult.resize(vfA.size());
+	for (unsigned int i = 0; i < vfA.size(); i++)
+	{
+		vfResult[i] = vfA[i] * vfB[i];
+		fSum += vfResult[i];
+	}
+	return fSum;
+}
+
+static int scalarArgMaxFloatVector(const vector<float>& vfValues)
+{
+	int iMaxIndex = -1;
+	float fMax = 0;
+	for (unsigned int i = 0; i < vfValues.size(); i++)
+		if (vfValues[i] > fMax)
+		{
+			fMax = vfValues[i];
+			iMaxIndex = i;
+		}
+	return iMaxIndex;
+}
+
+// M: checks that two sums agree within the tolerance, relative to the sum
+//    of the absolute values of the elements summed
+static bool sumsAgree(float fVector, float fScalar, float fMagnitude)
+{
+	return fabs(fVector - fScalar) <= 
+		VECTOR_KERNELS_TOLERANCE * ((fMagnitude > 1) ? fMagnitude : 1);
+}
+
+// M: fills a vector with random confidence-like values in [0, 1), with 
+//    about one element in eight set to the skip value, and (for the argmax)
+//    the maximum repeated at a later position
+static void fillTestVector(vector<float>& vfValues, int iSize)
+{
+	vfValues.resize(iSize);
+	for (int i = 0; i < iSize; i++)
+		vfValues[i] = (rand() % 8 == 0) ? VECTOR_KERNELS_SKIP_VALUE :
+			(float)rand() / ((float)RAND_MAX + 1);
+	if ((iSize > 1) && (rand() % 2 == 0))
+	{
+		int iMaxIndex = scalarArgMaxFloatVector(vfValues);
+		if (iMaxIndex != -1)
+			vfValues[iMaxIndex + rand() % (iSize - iMaxIndex)] = 
+				vfValues[iMaxIndex];
+	}
+}
+
+// M: checks the vectorized kernels against the scalar reference versions 
+//    on vectors of 1 to 1000 elements, then times both versions on a range
+//    of sizes; the results are printed on the standard output, and the 
+//    function returns the number of mismatches found
+int RunVectorKernelsTests()
+{
+	int iMismatches = 0;
+	vector<float> vfA, vfB, vfResult, vfScalarResult;
+
+	// the tolerance check
+	srand(1);
+	for (int iSize = 1; iSize <= 1000; iSize++)
+	{
+		fillTestVector(vfA, iSize);
+		fillTestVector(vfB, iSize);
+		float fMagnitude = 0;
+		for (int i = 0; i < iSize; i++)
+			fMagnitude += fabs(vfA[i]);
+
+		// the sum
+		float fSum = SumFloatVector(vfA, VECTOR_KERNELS_SKIP_VALUE);
+		float fScalarSum = 
+			scalarSumFloatVector(vfA, VECTOR_KERNELS_SKIP_VALUE);
+		if (!sumsAgree(fSum, fScalarSum, fMagnitude))
+		{
+			printf("SumFloatVector mismatch (size %d): %g vs. %g (scalar)\n",
+				iSize, fSum, fScalarSum);
+			iMismatches++;
+		}
+
+		// the element-wise product (the products themselves are exact)
+		fSum = MultiplyFloatVectors(vfResult, vfA, vfB);
+		fScalarSum = scalarMultiplyFloatVectors(vfScalarResult, vfA, vfB);
+		fMagnitude = 0;
+		for (int i = 0; i < iSize; i++)
+			fMagnitude += fabs(vfScalarResult[i]);
+		if ((vfResult != vfScalarResult) || 
+			!sumsAgree(fSum, fScalarSum, fMagnitude))
+		{
+			printf("MultiplyFloatVectors mismatch (size %d): %g vs. %g "\
+				"(scalar)\n", iSize, fSum, fScalarSum);
+			iMismatches++;
+		}
+
+		// the argmax (which must pick the same, first, index)
+		int iArgMax = ArgMaxFloatVector(vfA);
+		int iScalarArgMax = scalarArgMaxFloatVector(vfA);
+		if (iArgMax != iScalarArgMax)
+		{
+			printf("ArgMaxFloatVector mismatch (size %d): %d vs. %d "\
+				"(scalar)\n", iSize, iArgMax, iScalarArgMax);
+			iMismatches++;
+		}
+	}
+	printf("Vector kernels: %d mismatches on sizes 1 to 1000.\n", 
+		iMismatches);
+
+	// the microbenchmark (the sink keeps the calls from being optimized 
+	// away)
+	volatile float fSink = 0;
+	int viSizes[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1000};
+	printf("%6s %22s %22s %22s\n", "size", "sum (scalar/vector)", 
+		"multiply (s/v)", "argmax (s/v)");
+	for (unsigned int s = 0; s < sizeof(viSizes) / sizeof(int); s++)
+	{
+		int iSize = viSizes[s];
+		int iRepeats = VECTOR_KERNELS_BENCHMARK_ELEMENTS / iSize;
+		fillTestVector(vfA, iSize);
+		fillTestVector(vfB, iSize);
+
+		// the time per call, in nanoseconds, for each kernel: scalar, 
+		// then vectorized
+		double vdTimes[6];
+		for (int k = 0; k < 6; k++)
+		{
+			clock_t cStart = clock();
+			for (int r = 0; r < iRepeats; r++)
+			{
+				switch (k)
+				{
+				case 0:
+					fSink = fSink + scalarSumFloatVector(vfA, 
+						VECTOR_KERNELS_SKIP_VALUE);
+					break;
+				case 1:
+					fSink = fSink + SumFloatVector(vfA, 
+						VECTOR_KERNELS_SKIP_VALUE);
+					break;
+				case 2:
+					fSink = fSink + scalarMultiplyFloatVectors(vfResult, 
+						vfA, vfB);
+					break;
+				case 3:
+					fSink = fSink + MultiplyFloatVectors(vfResult, vfA, vfB);
+					break;
+				case 4:
+					fSink = fSink + (float)scalarArgMaxFloatVector(vfA);
+					break;
+				case 5:
+					fSink = fSink + (float)ArgMaxFloatVector(vfA);
+					break;
+				}
+			}
+			vdTimes[k] = (double)(clock() - cStart) * 1e9 / 
+				CLOCKS_PER_SEC / iRepeats;
+		}
+		printf("%6d %10.1f /%10.1f %10.1f /%10.1f %10.1f /%10.1f\n", 
+			iSize, vdTimes[0], vdTimes[1], vdTimes[2], vdTimes[3], 
+			vdTimes[4], vdTimes[5]);
+	}
+
+	return iMismatches;
 }
@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): added RunConditionCacheTests
+//   [2026-10-19] (mbrenner): added RunVectorKernelsTests
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
 //   [2001-12-29] (dbohus): started working on this
 // 
@@ -67,4 +69,14 @@
 //#define _RUN_DEBUGGING_TESTS
 void RunDebuggingTests();
 
+// M: checks the vectorized kernels over float vectors (Utils.h) against
+//    scalar versions, within a tolerance, and times them on vectors of 1 to
+//    1000 elements; returns the number of mismatches
+int RunVectorKernelsTests();
+
+// M: checks that the condition cache (DialogAgent.h) reuses a cached 
+//    condition until the concept or agent status it read changes; returns
+//    the number of failed checks
+int RunConditionCacheTests();
+
 #endif // __DEBUG_UTILS_H__
\ No newline at end of file
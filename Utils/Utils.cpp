@@ -51,6 +51,19 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the CStringTable strings are reference counted,
+//                            and their ids are reused once released
+//   [2026-10-19] (mbrenner): added GetFileModificationTime
+//   [2026-10-19] (mbrenner): added the memory accounting helpers
+//   [2026-10-19] (mbrenner): added CBinaryWriter and CBinaryReader
+//   [2026-10-19] (mbrenner): added CSharedString (interned, reference counted
+//                            strings)
+//   [2026-10-19] (mbrenner): added CFixedSizePool
+//   [2026-10-19] (mbrenner): added vectorized (SSE/AVX2) kernels over float
+//                            vectors, used in belief updating
+//   [2026-10-19] (mbrenner): added CSubstringMatcher (Aho-Corasick)
+//   [2026-10-19] (mbrenner): added HashString and the CStringTable class for
+//                            interning strings
 //   [2006-01-24] (dbohus):  added support for constructing hashes from string
 //                           descriptions and the other way around
 //   [2005-02-08] (antoine): added the Sleep function that waits for a number
@@ -73,8 +86,47 @@
 //-----------------------------------------------------------------------------
 
 #include <windows.h>
+#include <sys/stat.h>
 #include "Utils.h"
 
+// M: select the instruction set for the vectorized kernels
+#if !defined(NO_SIMD_KERNELS) && defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256 TFloatBlock;
+#define FLOAT_BLOCK_SIZE 8
+#define BLOCK_LOAD(p) _mm256_loadu_ps(p)
+#define BLOCK_STORE(p, b) _mm256_storeu_ps(p, b)
+#define BLOCK_SET(f) _mm256_set1_ps(f)
+#define BLOCK_ZERO() _mm256_setzero_ps()
+#define BLOCK_ADD(a, b) _mm256_add_ps(a, b)
+#define BLOCK_MUL(a, b) _mm256_mul_ps(a, b)
+#define BLOCK_MAX(a, b) _mm256_max_ps(a, b)
+#define BLOCK_AND(a, b) _mm256_and_ps(a, b)
+#define BLOCK_ANDNOT(a, b) _mm256_andnot_ps(a, b)
+#define BLOCK_OR(a, b) _mm256_or_ps(a, b)
+#define BLOCK_CMPEQ(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#define BLOCK_CMPNEQ(a, b) _mm256_cmp_ps(a, b, _CMP_NEQ_UQ)
+#define BLOCK_MASK(a) _mm256_movemask_ps(a)
+#elif !defined(NO_SIMD_KERNELS) && (defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#include <emmintrin.h>
+typedef __m128 TFloatBlock;
+#define FLOAT_BLOCK_SIZE 4
+#define BLOCK_LOAD(p) _mm_loadu_ps(p)
+#define BLOCK_STORE(p, b) _mm_storeu_ps(p, b)
+#define BLOCK_SET(f) _mm_set1_ps(f)
+#define BLOCK_ZERO() _mm_setzero_ps()
+#define BLOCK_ADD(a, b) _mm_add_ps(a, b)
+#define BLOCK_MUL(a, b) _mm_mul_ps(a, b)
+#define BLOCK_MAX(a, b) _mm_max_ps(a, b)
+#define BLOCK_AND(a, b) _mm_and_ps(a, b)
+#define BLOCK_ANDNOT(a, b) _mm_andnot_ps(a, b)
+#define BLOCK_OR(a, b) _mm_or_ps(a, b)
+#define BLOCK_CMPEQ(a, b) _mm_cmpeq_ps(a, b)
+#define BLOCK_CMPNEQ(a, b) _mm_cmpneq_ps(a, b)
+#define BLOCK_MASK(a) _mm_movemask_ps(a)
+#endif
+
 // D: Static buffer commonly used by string routines
 //̬ char飬 ڹ
 static char szBuffer[STRING_MAX];
@@ -471,6 +523,967 @@ void AppendToS2S(STRING2STRING& rs2sInto, STRING2STRING& rs2sFrom)
 }
 
 
+//-----------------------------------------------------------------------------
+// String hashing and interning
+//-----------------------------------------------------------------------------
+
+// M: computes a (32 bit FNV-1a) hash value for a string
+unsigned int HashString(const string& sString)
+{
+	unsigned int uiHash = FNV_HASH_SEED;
+	for (unsigned int i = 0; i < sString.length(); i++)
+	{
+		uiHash ^= (unsigned char)sString[i];
+		uiHash *= 16777619u;
+	}
+	return uiHash;
+}
+
+// M: folds a 32 bit value into a hash value (FNV-1a over its 4 bytes)
+unsigned int HashCombine(unsigned int uiHash, unsigned int uiValue)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		uiHash ^= (uiValue & 0xff);
+		uiHash *= 16777619u;
+		uiValue >>= 8;
+	}
+	return uiHash;
+}
+
+// M: constructor, starts with a small empty table
+CStringTable::CStringTable()
+{
+	viSlots.assign(16, -1);
+	iSlotsUsed = 0;
+}
+
+// M: finds the slot for a string, by linear probing
+unsigned int CStringTable::findSlot(const string& sString, unsigned int uiHash)
+{
+	unsigned int uiMask = (unsigned int)viSlots.size() - 1;
+	unsigned int uiSlot = uiHash & uiMask;
+	while (viSlots[uiSlot] != -1)
+	{
+		int iID = viSlots[uiSlot];
+		if ((iID >= 0) && (vuiHashes[iID] == uiHash) && 
+			(vsStrings[iID] == sString))
+			break;
+		uiSlot = (uiSlot + 1) & uiMask;
+	}
+	return uiSlot;
+}
+
+// M: rebuilds the hash table with the live ids, dropping the deleted 
+//    slots; the new table is sized so that it is at most half full
+void CStringTable::rehash()
+{
+	unsigned int uiLive = (unsigned int)(vsStrings.size() - viFreeIDs.size());
+	unsigned int uiNewSize = 16;
+	while (uiLive * 2 > uiNewSize)
+		uiNewSize *= 2;
+	viSlots.assign(uiNewSize, -1);
+	iSlotsUsed = 0;
+	unsigned int uiMask = uiNewSize - 1;
+	for (unsigned int i = 0; i < vsStrings.size(); i++)
+		if (viRefs[i] > 0)
+		{
+			unsigned int uiSlot = vuiHashes[i] & uiMask;
+			while (viSlots[uiSlot] != -1)
+				uiSlot = (uiSlot + 1) & uiMask;
+			viSlots[uiSlot] = i;
+			iSlotsUsed++;
+		}
+}
+
+// M: returns the id of the string, adding it to the table if needed, and
+//    adds a reference to it
+int CStringTable::Intern(const string& sString)
+{
+	unsigned int uiHash = HashString(sString);
+	unsigned int uiSlot = findSlot(sString, uiHash);
+	if (viSlots[uiSlot] != -1)
+	{
+		viRefs[viSlots[uiSlot]]++;
+		return viSlots[uiSlot];
+	}
+
+	// add the string, reusing a released id if there is one
+	int iID;
+	if (!viFreeIDs.empty())
+	{
+		iID = viFreeIDs.back();
+		viFreeIDs.pop_back();
+		vsStrings[iID] = sString;
+		vuiHashes[iID] = uiHash;
+		viRefs[iID] = 1;
+	}
+	else
+	{
+		iID = (int)vsStrings.size();
+		vsStrings.push_back(sString);
+		vuiHashes.push_back(uiHash);
+		viRefs.push_back(1);
+	}
+
+	// and index it, keeping the load (including the deleted slots) under 3/4
+	if ((unsigned int)(iSlotsUsed + 1) * 4 > viSlots.size() * 3)
+		rehash();
+	else
+	{
+		viSlots[uiSlot] = iID;
+		iSlotsUsed++;
+	}
+	return iID;
+}
+
+// M: drops a reference to a string. When the last one goes away, the string
+//    is removed from the hash table (leaving a deleted marker in its slot) 
+//    and its id is kept for reuse
+void CStringTable::Release(int iID)
+{
+	if (--viRefs[iID] > 0)
+		return;
+
+	unsigned int uiMask = (unsigned int)viSlots.size() - 1;
+	unsigned int uiSlot = vuiHashes[iID] & uiMask;
+	while (viSlots[uiSlot] != iID)
+		uiSlot = (uiSlot + 1) & uiMask;
+	viSlots[uiSlot] = -2;
+	string().swap(vsStrings[iID]);
+	viFreeIDs.push_back(iID);
+}
+
+// M: returns the id of the string, or -1 if it's not in the table
+int CStringTable::Find(const string& sString)
+{
+	return viSlots[findSlot(sString, HashString(sString))];
+}
+
+// M: returns the string for an id
+const string& CStringTable::GetString(int iID)
+{
+	return vsStrings[iID];
+}
+
+// M: returns the number of ids (including the released ones)
+int CStringTable::GetSize()
+{
+	return (int)vsStrings.size();
+}
+
+// M: empties the table
+void CStringTable::Clear()
+{
+	vsStrings.clear();
+	vuiHashes.clear();
+	viRefs.clear();
+	viFreeIDs.clear();
+	viSlots.assign(16, -1);
+	iSlotsUsed = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Shared (interned, reference counted) strings
+//-----------------------------------------------------------------------------
+
+// M: the process-wide table of shared strings: a chained hash table, so 
+//    that entries can be removed when they are no longer referenced. It is
+//    allocated on first use and never destroyed, so that shared strings in
+//    static objects can be released at any time
+typedef struct {
+	vector<void*> vpBuckets;		// the buckets (the size is a power of 2)
+	int iEntries;					// the number of entries
+	int iBytes;						// the bytes held by the entries
+} TSharedStringTable;
+
+static TSharedStringTable& getSharedStringTable()
+{
+	static TSharedStringTable* pTable = NULL;
+	if (pTable == NULL)
+	{
+		pTable = new TSharedStringTable;
+		pTable->vpBuckets.assign(64, (void*)NULL);
+		pTable->iEntries = 0;
+		pTable->iBytes = 0;
+	}
+	return *pTable;
+}
+
+// M: returns the (referenced) entry for a string, adding it to the table if
+//    needed
+CSharedString::TSharedStringEntry* CSharedString::acquire(const string& sString)
+{
+	if (sString.empty())
+		return NULL;
+
+	TSharedStringTable& rTable = getSharedStringTable();
+	unsigned int uiHash = HashString(sString);
+	unsigned int uiMask = (unsigned int)rTable.vpBuckets.size() - 1;
+	TSharedStringEntry* pAEntry = 
+		(TSharedStringEntry*)rTable.vpBuckets[uiHash & uiMask];
+	for (; pAEntry != NULL; pAEntry = pAEntry->pNext)
+	if ((pAEntry->uiHash == uiHash) && (pAEntry->sValue == sString))
+	{
+		pAEntry->iRefCount++;
+		return pAEntry;
+	}
+
+	// add a new entry
+	pAEntry = new TSharedStringEntry;
+	pAEntry->sValue = sString;
+	pAEntry->uiHash = uiHash;
+	pAEntry->iRefCount = 1;
+	pAEntry->pNext = (TSharedStringEntry*)rTable.vpBuckets[uiHash & uiMask];
+	rTable.vpBuckets[uiHash & uiMask] = pAEntry;
+	rTable.iEntries++;
+	rTable.iBytes += (int)(sizeof(TSharedStringEntry) + 
+		pAEntry->sValue.capacity());
+
+	// grow the table, keeping at most one entry per bucket on average
+	if (rTable.iEntries > (int)rTable.vpBuckets.size())
+	{
+		vector<void*> vpOldBuckets(rTable.vpBuckets.size() * 2, (void*)NULL);
+		vpOldBuckets.swap(rTable.vpBuckets);
+		uiMask = (unsigned int)rTable.vpBuckets.size() - 1;
+		for (unsigned int i = 0; i < vpOldBuckets.size(); i++)
+		{
+			TSharedStringEntry* pMoved = (TSharedStringEntry*)vpOldBuckets[i];
+			while (pMoved != NULL)
+			{
+				TSharedStringEntry* pNextEntry = pMoved->pNext;
+				pMoved->pNext = 
+					(TSharedStringEntry*)rTable.vpBuckets[pMoved->uiHash & uiMask];
+				rTable.vpBuckets[pMoved->uiHash & uiMask] = pMoved;
+				pMoved = pNextEntry;
+			}
+		}
+	}
+
+	return pAEntry;
+}
+
+// M: drops a reference to an entry, and removes it from the table when it
+//    is no longer referenced
+void CSharedString::release(TSharedStringEntry* pAEntry)
+{
+	if ((pAEntry == NULL) || (--pAEntry->iRefCount > 0))
+		return;
+
+	// unlink it from its bucket
+	TSharedStringTable& rTable = getSharedStringTable();
+	unsigned int uiMask = (unsigned int)rTable.vpBuckets.size() - 1;
+	void** ppLink = &rTable.vpBuckets[pAEntry->uiHash & uiMask];
+	while (*ppLink != pAEntry)
+		ppLink = (void**)&((TSharedStringEntry*)*ppLink)->pNext;
+	*ppLink = pAEntry->pNext;
+
+	rTable.iEntries--;
+	rTable.iBytes -= (int)(sizeof(TSharedStringEntry) + 
+		pAEntry->sValue.capacity());
+	delete pAEntry;
+}
+
+// M: default constructor, the empty string
+CSharedString::CSharedString()
+{
+	pEntry = NULL;
+}
+
+// M: constructor from a string
+CSharedString::CSharedString(const string& sString)
+{
+	pEntry = acquire(sString);
+}
+
+// M: copy constructor
+CSharedString::CSharedString(const CSharedString& rASharedString)
+{
+	pEntry = rASharedString.pEntry;
+	if (pEntry != NULL)
+		pEntry->iRefCount++;
+}
+
+// M: destructor
+CSharedString::~CSharedString()
+{
+	release(pEntry);
+}
+
+// M: assignment operator from a string
+CSharedString& CSharedString::operator = (const string& sString)
+{
+	TSharedStringEntry* pNewEntry = acquire(sString);
+	release(pEntry);
+	pEntry = pNewEntry;
+	return *this;
+}
+
+// M: assignment operator from another shared string
+CSharedString& CSharedString::operator = (const CSharedString& rASharedString)
+{
+	if (rASharedString.pEntry != NULL)
+		rASharedString.pEntry->iRefCount++;
+	release(pEntry);
+	pEntry = rASharedString.pEntry;
+	return *this;
+}
+
+// M: equality operator
+bool CSharedString::operator == (const CSharedString& rASharedString) const
+{
+	return pEntry == rASharedString.pEntry;
+}
+
+// M: inequality operator
+bool CSharedString::operator != (const CSharedString& rASharedString) const
+{
+	return pEntry != rASharedString.pEntry;
+}
+
+// M: returns the string
+const string& CSharedString::Get() const
+{
+	static const string sEmpty;
+	return (pEntry != NULL) ? pEntry->sValue : sEmpty;
+}
+
+// M: returns the hash value of the string
+unsigned int CSharedString::GetHash() const
+{
+	return (pEntry != NULL) ? pEntry->uiHash : FNV_HASH_SEED;
+}
+
+// M: returns the number of strings in the table
+int CSharedString::GetTableSize()
+{
+	return getSharedStringTable().iEntries;
+}
+
+// M: returns the number of bytes held by the table and its strings
+int CSharedString::GetTableBytes()
+{
+	TSharedStringTable& rTable = getSharedStringTable();
+	return rTable.iBytes + (int)(rTable.vpBuckets.size() * sizeof(void*));
+}
+
+//-----------------------------------------------------------------------------
+// Binary encoding
+//-----------------------------------------------------------------------------
+
+// M: appends a byte
+void CBinaryWriter::WriteUInt8(unsigned char ucValue)
+{
+	sBuffer += (char)ucValue;
+}
+
+// M: appends an unsigned 32 bit value (little-endian)
+void CBinaryWriter::WriteUInt32(unsigned int uiValue)
+{
+	char lpBytes[4];
+	lpBytes[0] = (char)(uiValue & 0xFF);
+	lpBytes[1] = (char)((uiValue >> 8) & 0xFF);
+	lpBytes[2] = (char)((uiValue >> 16) & 0xFF);
+	lpBytes[3] = (char)((uiValue >> 24) & 0xFF);
+	sBuffer.append(lpBytes, 4);
+}
+
+// M: appends a signed 32 bit value
+void CBinaryWriter::WriteInt32(int iValue)
+{
+	WriteUInt32((unsigned int)iValue);
+}
+
+// M: appends a float (as its 32 bit IEEE representation)
+void CBinaryWriter::WriteFloat(float fValue)
+{
+	unsigned int uiBits;
+	memcpy(&uiBits, &fValue, sizeof(uiBits));
+	WriteUInt32(uiBits);
+}
+
+// M: appends a string (its length, followed by its bytes)
+void CBinaryWriter::WriteString(const string& sValue)
+{
+	WriteUInt32((unsigned int)sValue.length());
+	sBuffer.append(sValue);
+}
+
+// M: returns the encoded bytes
+const string& CBinaryWriter::GetBuffer()
+{
+	return sBuffer;
+}
+
+// M: returns the number of encoded bytes
+int CBinaryWriter::GetSize()
+{
+	return (int)sBuffer.length();
+}
+
+// M: clears the buffer
+void CBinaryWriter::Clear()
+{
+	sBuffer.clear();
+}
+
+// M: constructor from a buffer and its size
+CBinaryReader::CBinaryReader(const char* pABuffer, int iASize)
+{
+	pBuffer = pABuffer;
+	iSize = iASize;
+	iPosition = 0;
+	bFailed = false;
+}
+
+// M: constructor from a string holding the encoded bytes
+CBinaryReader::CBinaryReader(const string& sABuffer)
+{
+	pBuffer = sABuffer.data();
+	iSize = (int)sABuffer.length();
+	iPosition = 0;
+	bFailed = false;
+}
+
+// M: checks that the next iLength bytes are available (and sets the failed
+//    flag if they are not)
+bool CBinaryReader::available(int iLength)
+{
+	if (bFailed || (iLength < 0) || (iLength > iSize - iPosition))
+	{
+		bFailed = true;
+		return false;
+	}
+	return true;
+}
+
+// M: reads a byte
+unsigned char CBinaryReader::ReadUInt8()
+{
+	if (!available(1))
+		return 0;
+	return (unsigned char)pBuffer[iPosition++];
+}
+
+// M: reads an unsigned 32 bit value (little-endian)
+unsigned int CBinaryReader::ReadUInt32()
+{
+	if (!available(4))
+		return 0;
+	const unsigned char* pBytes = (const unsigned char*)pBuffer + iPosition;
+	iPosition += 4;
+	return (unsigned int)pBytes[0] | ((unsigned int)pBytes[1] << 8) |
+		((unsigned int)pBytes[2] << 16) | ((unsigned int)pBytes[3] << 24);
+}
+
+// M: reads a signed 32 bit value
+int CBinaryReader::ReadInt32()
+{
+	return (int)ReadUInt32();
+}
+
+// M: reads a float
+float CBinaryReader::ReadFloat()
+{
+	unsigned int uiBits = ReadUInt32();
+	float fValue;
+	memcpy(&fValue, &uiBits, sizeof(fValue));
+	return fValue;
+}
+
+// M: reads a string (into a new string object)
+string CBinaryReader::ReadString()
+{
+	int iLength;
+	const char* lpszView = ReadStringView(iLength);
+	return string(lpszView, iLength);
+}
+
+// M: reads a string as a view into the buffer
+const char* CBinaryReader::ReadStringView(int& riLength)
+{
+	riLength = (int)ReadUInt32();
+	if (!available(riLength))
+	{
+		riLength = 0;
+		return pBuffer + iPosition;
+	}
+	const char* lpszView = pBuffer + iPosition;
+	iPosition += riLength;
+	return lpszView;
+}
+
+// M: returns true if a read went past the end of the buffer
+bool CBinaryReader::Failed()
+{
+	return bFailed;
+}
+
+// M: returns true if the whole buffer was read
+bool CBinaryReader::AtEnd()
+{
+	return iPosition == iSize;
+}
+
+// M: returns the current read position
+int CBinaryReader::GetPosition()
+{
+	return iPosition;
+}
+
+//-----------------------------------------------------------------------------
+// Fixed size memory pools
+//-----------------------------------------------------------------------------
+
+// M: constructor
+CFixedSizePool::CFixedSizePool(size_t stAObjectSize, int iABlocksPerChunk)
+{
+	stObjectSize = stAObjectSize;
+	// the blocks must hold the free list link, and keep the alignment 
+	stBlockSize = (stAObjectSize + sizeof(double) - 1) / sizeof(double) *
+		sizeof(double);
+	if (stBlockSize < sizeof(void*))
+		stBlockSize = sizeof(void*);
+	iBlocksPerChunk = iABlocksPerChunk;
+	pFreeList = NULL;
+	iBlocksInUse = 0;
+}
+
+// M: destructor, releases the chunks
+CFixedSizePool::~CFixedSizePool()
+{
+	for (unsigned int i = 0; i < vpChunks.size(); i++)
+		::operator delete(vpChunks[i]);
+	vpChunks.clear();
+	pFreeList = NULL;
+}
+
+// M: allocates a new chunk, and puts its blocks on the free list (in order,
+//    so that consecutive allocations are adjacent in memory)
+void CFixedSizePool::addChunk()
+{
+	char* pChunk = (char*)::operator new(stBlockSize * iBlocksPerChunk);
+	vpChunks.push_back(pChunk);
+	for (int i = iBlocksPerChunk - 1; i >= 0; i--)
+	{
+		void* pBlock = pChunk + i * stBlockSize;
+		*(void**)pBlock = pFreeList;
+		pFreeList = pBlock;
+	}
+}
+
+// M: allocates a block
+void* CFixedSizePool::Allocate(size_t stSize)
+{
+	if (stSize != stObjectSize)
+		return ::operator new(stSize);
+	if (pFreeList == NULL)
+		addChunk();
+	void* pBlock = pFreeList;
+	pFreeList = *(void**)pBlock;
+	iBlocksInUse++;
+	return pBlock;
+}
+
+// M: returns a block to the free list
+void CFixedSizePool::Free(void* pBlock, size_t stSize)
+{
+	if (pBlock == NULL)
+		return;
+	if (stSize != stObjectSize)
+	{
+		::operator delete(pBlock);
+		return;
+	}
+	*(void**)pBlock = pFreeList;
+	pFreeList = pBlock;
+	iBlocksInUse--;
+}
+
+// M: returns the number of blocks in use
+int CFixedSizePool::GetBlocksInUse()
+{
+	return iBlocksInUse;
+}
+
+// M: returns the number of bytes held by the pool
+int CFixedSizePool::GetBytesReserved()
+{
+	return (int)(vpChunks.size() * stBlockSize * iBlocksPerChunk);
+}
+
+//-----------------------------------------------------------------------------
+// Memory accounting
+//-----------------------------------------------------------------------------
+
+// M: adds a number of objects and bytes to a component of an account
+void AccountMemory(TMemoryAccount& rmaAccount, const string& sComponent,
+	int iObjects, int iBytes)
+{
+	TMemoryAccount::iterator iPtr = rmaAccount.find(sComponent);
+	if (iPtr == rmaAccount.end())
+	{
+		TMemoryUsage muUsage;
+		muUsage.iObjects = iObjects;
+		muUsage.iBytes = iBytes;
+		rmaAccount.insert(TMemoryAccount::value_type(sComponent, muUsage));
+	}
+	else
+	{
+		iPtr->second.iObjects += iObjects;
+		iPtr->second.iBytes += iBytes;
+	}
+}
+
+// M: returns the number of heap bytes held by a string (the short strings 
+//    are kept inside the string object)
+int StringHeapBytes(const string& sString)
+{
+	if (sString.capacity() <= STRING_INPLACE_CAPACITY)
+		return 0;
+	return (int)sString.capacity() + 1;
+}
+
+// M: returns the number of heap bytes held by a string hash
+int S2SHeapBytes(STRING2STRING& rs2sHash)
+{
+	int iBytes = (int)(rs2sHash.size() *
+		(sizeof(STRING2STRING::value_type) + TREE_NODE_OVERHEAD));
+	STRING2STRING::iterator iPtr;
+	for (iPtr = rs2sHash.begin(); iPtr != rs2sHash.end(); iPtr++)
+		iBytes += StringHeapBytes(iPtr->first) + StringHeapBytes(iPtr->second);
+	return iBytes;
+}
+
+// M: converts a memory account to a string
+string MemoryAccountToString(TMemoryAccount& rmaAccount)
+{
+	string sResult;
+	int iTotalBytes = 0;
+	TMemoryAccount::iterator iPtr;
+	for (iPtr = rmaAccount.begin(); iPtr != rmaAccount.end(); iPtr++)
+	{
+		sResult += FormatString("%-20s %10d objects %12d bytes\n",
+			iPtr->first.c_str(), iPtr->second.iObjects, iPtr->second.iBytes);
+		iTotalBytes += iPtr->second.iBytes;
+	}
+	sResult += FormatString("%-20s %31d bytes", "total", iTotalBytes);
+	return sResult;
+}
+
+//-----------------------------------------------------------------------------
+// Multiple pattern substring matching
+//-----------------------------------------------------------------------------
+
+// M: constructor, starts with an empty set of patterns
+CSubstringMatcher::CSubstringMatcher()
+{
+	Clear();
+}
+
+// M: adds a new node to the automaton
+int CSubstringMatcher::addNode()
+{
+	TSubstringMatcherNode smnNode;
+	smnNode.iFail = 0;
+	smnNode.iFirstPattern = -1;
+	vsmnNodes.push_back(smnNode);
+	return (int)vsmnNodes.size() - 1;
+}
+
+// M: removes all the patterns
+void CSubstringMatcher::Clear()
+{
+	vsmnNodes.clear();
+	addNode();
+	iNumPatterns = 0;
+	bCompiled = false;
+}
+
+// M: adds a pattern to the trie
+int CSubstringMatcher::AddPattern(const string& sPattern)
+{
+	int iNode = 0;
+	for (unsigned int i = 0; i < sPattern.length(); i++)
+	{
+		map<char, int>::iterator iPtr = vsmnNodes[iNode].mciNext.find(sPattern[i]);
+		if (iPtr == vsmnNodes[iNode].mciNext.end())
+		{
+			int iNewNode = addNode();
+			vsmnNodes[iNode].mciNext.insert(map<char, int>::value_type(
+				sPattern[i], iNewNode));
+			iNode = iNewNode;
+		}
+		else
+			iNode = iPtr->second;
+	}
+	// if the same pattern was added before, the earlier one takes precedence
+	if (vsmnNodes[iNode].iFirstPattern == -1)
+		vsmnNodes[iNode].iFirstPattern = iNumPatterns;
+	bCompiled = false;
+	return iNumPatterns++;
+}
+
+// M: computes the failure links breadth-first, and propagates the first
+//    pattern along them
+void CSubstringMatcher::Compile()
+{
+	queue<int> qiNodes;
+	map<char, int>::iterator iPtr;
+	for (iPtr = vsmnNodes[0].mciNext.begin(); iPtr != vsmnNodes[0].mciNext.end(); iPtr++)
+	{
+		vsmnNodes[iPtr->second].iFail = 0;
+		qiNodes.push(iPtr->second);
+	}
+	while (!qiNodes.empty())
+	{
+		int iNode = qiNodes.front();
+		qiNodes.pop();
+		// a node matches whatever its failure node matches
+		int iFailPattern = vsmnNodes[vsmnNodes[iNode].iFail].iFirstPattern;
+		if ((iFailPattern != -1) && ((vsmnNodes[iNode].iFirstPattern == -1) ||
+			(iFailPattern < vsmnNodes[iNode].iFirstPattern)))
+			vsmnNodes[iNode].iFirstPattern = iFailPattern;
+		for (iPtr = vsmnNodes[iNode].mciNext.begin(); iPtr != vsmnNodes[iNode].mciNext.end(); iPtr++)
+		{
+			// follow the failure links of the parent to find the failure
+			// link of the child
+			int iFail = vsmnNodes[iNode].iFail;
+			map<char, int>::iterator iFailPtr;
+			while (((iFailPtr = vsmnNodes[iFail].mciNext.find(iPtr->first)) ==
+				vsmnNodes[iFail].mciNext.end()) && (iFail != 0))
+				iFail = vsmnNodes[iFail].iFail;
+			if (iFailPtr != vsmnNodes[iFail].mciNext.end())
+				vsmnNodes[iPtr->second].iFail = iFailPtr->second;
+			else
+				vsmnNodes[iPtr->second].iFail = 0;
+			qiNodes.push(iPtr->second);
+		}
+	}
+	bCompiled = true;
+}
+
+// M: runs the automaton over the text, and returns the lowest index of a
+//    pattern occurring in it (or -1 if none does)
+int CSubstringMatcher::FindFirstPattern(const string& sText)
+{
+	if (!bCompiled)
+		Compile();
+
+	// the empty pattern (if any) matches any text
+	int iFirstPattern = vsmnNodes[0].iFirstPattern;
+	int iNode = 0;
+	for (unsigned int i = 0; i < sText.length(); i++)
+	{
+		map<char, int>::iterator iPtr;
+		while (((iPtr = vsmnNodes[iNode].mciNext.find(sText[i])) ==
+			vsmnNodes[iNode].mciNext.end()) && (iNode != 0))
+			iNode = vsmnNodes[iNode].iFail;
+		if (iPtr != vsmnNodes[iNode].mciNext.end())
+			iNode = iPtr->second;
+		int iPattern = vsmnNodes[iNode].iFirstPattern;
+		if ((iPattern != -1) && ((iFirstPattern == -1) || (iPattern < iFirstPattern)))
+		{
+			iFirstPattern = iPattern;
+			// nothing can beat the first pattern
+			if (iFirstPattern == 0) break;
+		}
+	}
+	return iFirstPattern;
+}
+
+// M: returns the number of patterns
+int CSubstringMatcher::GetNumPatterns()
+{
+	return iNumPatterns;
+}
+
+//-----------------------------------------------------------------------------
+// Vectorized kernels over float vectors
+//-----------------------------------------------------------------------------
+
+#ifdef FLOAT_BLOCK_SIZE
+// M: adds up the elements of a block
+static float blockSum(TFloatBlock fbBlock)
+{
+	float afBlock[FLOAT_BLOCK_SIZE];
+	BLOCK_STORE(afBlock, fbBlock);
+	float fSum = 0;
+	for (int i = 0; i < FLOAT_BLOCK_SIZE; i++)
+		fSum += afBlock[i];
+	return fSum;
+}
+
+// M: returns the largest element of a block
+static float blockMax(TFloatBlock fbBlock)
+{
+	float afBlock[FLOAT_BLOCK_SIZE];
+	BLOCK_STORE(afBlock, fbBlock);
+	float fMax = afBlock[0];
+	for (int i = 1; i < FLOAT_BLOCK_SIZE; i++)
+	if (afBlock[i] > fMax)
+		fMax = afBlock[i];
+	return fMax;
+}
+#endif
+
+// M: returns the sum of the elements of a vector, skipping the elements 
+//    equal to fSkipValue
+float SumFloatVector(const vector<float>& vfValues, float fSkipValue)
+{
+	int iSize = (int)vfValues.size();
+	int i = 0;
+	float fSum = 0;
+#ifdef FLOAT_BLOCK_SIZE
+	if (iSize >= FLOAT_BLOCK_SIZE)
+	{
+		const float* pfValues = &vfValues[0];
+		TFloatBlock fbSkip = BLOCK_SET(fSkipValue);
+		TFloatBlock fbSum = BLOCK_ZERO();
+		for (; i + FLOAT_BLOCK_SIZE <= iSize; i += FLOAT_BLOCK_SIZE)
+		{
+			TFloatBlock fbValues = BLOCK_LOAD(pfValues + i);
+			// zero out the elements to be skipped
+			fbSum = BLOCK_ADD(fbSum,
+				BLOCK_AND(fbValues, BLOCK_CMPNEQ(fbValues, fbSkip)));
+		}
+		fSum = blockSum(fbSum);
+	}
+#endif
+	for (; i < iSize; i++)
+	if (vfValues[i] != fSkipValue)
+		fSum += vfValues[i];
+	return fSum;
+}
+
+// M: multiplies two vectors element-wise (vfResult[i] = vfA[i] * vfB[i]) 
+//    and returns the sum of the products
+float MultiplyFloatVectors(vector<float>& vfResult, const vector<float>& vfA,
+	const vector<float>& vfB)
+{
+	int iSize = (int)vfA.size();
+	assert((int)vfB.size() == iSize);
+	vfResult.resize(iSize);
+	int i = 0;
+	float fSum = 0;
+#ifdef FLOAT_BLOCK_SIZE
+	if (iSize >= FLOAT_BLOCK_SIZE)
+	{
+		const float* pfA = &vfA[0];
+		const float* pfB = &vfB[0];
+		float* pfResult = &vfResult[0];
+		TFloatBlock fbSum = BLOCK_ZERO();
+		for (; i + FLOAT_BLOCK_SIZE <= iSize; i += FLOAT_BLOCK_SIZE)
+		{
+			TFloatBlock fbProduct = BLOCK_MUL(BLOCK_LOAD(pfA + i),
+				BLOCK_LOAD(pfB + i));
+			BLOCK_STORE(pfResult + i, fbProduct);
+			fbSum = BLOCK_ADD(fbSum, fbProduct);
+		}
+		fSum = blockSum(fbSum);
+	}
+#endif
+	for (; i < iSize; i++)
+	{
+		vfResult[i] = vfA[i] * vfB[i];
+		fSum += vfResult[i];
+	}
+	return fSum;
+}
+
+// M: multiplies by fScale the elements of a vector which are not equal to 
+//    fSkipValue
+void ScaleFloatVector(vector<float>& vfValues, float fScale, float fSkipValue)
+{
+	int iSize = (int)vfValues.size();
+	int i = 0;
+#ifdef FLOAT_BLOCK_SIZE
+	if (iSize >= FLOAT_BLOCK_SIZE)
+	{
+		float* pfValues = &vfValues[0];
+		TFloatBlock fbSkip = BLOCK_SET(fSkipValue);
+		TFloatBlock fbScale = BLOCK_SET(fScale);
+		for (; i + FLOAT_BLOCK_SIZE <= iSize; i += FLOAT_BLOCK_SIZE)
+		{
+			TFloatBlock fbValues = BLOCK_LOAD(pfValues + i);
+			TFloatBlock fbMask = BLOCK_CMPNEQ(fbValues, fbSkip);
+			// select the scaled value where the mask is set, and the 
+			// original one elsewhere
+			BLOCK_STORE(pfValues + i, BLOCK_OR(
+				BLOCK_AND(fbMask, BLOCK_MUL(fbValues, fbScale)),
+				BLOCK_ANDNOT(fbMask, fbValues)));
+		}
+	}
+#endif
+	for (; i < iSize; i++)
+	if (vfValues[i] != fSkipValue)
+		vfValues[i] *= fScale;
+}
+
+// M: raises to fPower the elements of a vector which are not equal to 
+//    fSkipValue
+void PowerFloatVector(vector<float>& vfValues, float fPower, float fSkipValue)
+{
+	// there is no vectorized pow, so this one stays scalar
+	for (unsigned int i = 0; i < vfValues.size(); i++)
+	if (vfValues[i] != fSkipValue)
+		vfValues[i] = (float)pow(vfValues[i], fPower);
+}
+
+// M: returns the index of the (first) largest element of a vector, or -1 
+//    if there are no strictly positive elements
+int ArgMaxFloatVector(const vector<float>& vfValues)
+{
+	int iSize = (int)vfValues.size();
+	int i = 0;
+	float fMax = 0;
+#ifdef FLOAT_BLOCK_SIZE
+	const float* pfValues = iSize ? &vfValues[0] : NULL;
+	// first find the maximum
+	if (iSize >= FLOAT_BLOCK_SIZE)
+	{
+		TFloatBlock fbMax = BLOCK_ZERO();
+		for (; i + FLOAT_BLOCK_SIZE <= iSize; i += FLOAT_BLOCK_SIZE)
+			fbMax = BLOCK_MAX(BLOCK_LOAD(pfValues + i), fbMax);
+		fMax = blockMax(fbMax);
+	}
+	for (; i < iSize; i++)
+	if (vfValues[i] > fMax)
+		fMax = vfValues[i];
+	if (fMax <= 0)
+		return -1;
+	// then find the first element equal to it
+	TFloatBlock fbMax = BLOCK_SET(fMax);
+	for (i = 0; i + FLOAT_BLOCK_SIZE <= iSize; i += FLOAT_BLOCK_SIZE)
+	{
+		int iMask = BLOCK_MASK(BLOCK_CMPEQ(BLOCK_LOAD(pfValues + i), fbMax));
+		if (iMask)
+		{
+			int iOffset = 0;
+			while (!(iMask & 1))
+			{
+				iMask >>= 1;
+				iOffset++;
+			}
+			return i + iOffset;
+		}
+	}
+	for (; i < iSize; i++)
+	if (vfValues[i] == fMax)
+		return i;
+	return -1;
+#else
+	int iMaxIndex = -1;
+	for (; i < iSize; i++)
+	if (vfValues[i] > fMax)
+	{
+		fMax = vfValues[i];
+		iMaxIndex = i;
+	}
+	return iMaxIndex;
+#endif
+}
+
 //-----------------------------------------------------------------------------
 // Functions for constructing unique IDs
 //-----------------------------------------------------------------------------
@@ -654,4 +1667,13 @@ void Sleep(int iDelay)
 	int iGoal;
 	iGoal = iDelay + (int)clock();
 	while (iGoal > clock());
-}
\ No newline at end of file
+}
+// M: Returns the last modification time of a file (0 if the file cannot
+//    be accessed)
+time_t GetFileModificationTime(string sFileName)
+{
+	struct _stat stFileInfo;
+	if (_stat(sFileName.c_str(), &stFileInfo) != 0)
+		return 0;
+	return stFileInfo.st_mtime;
+}
@@ -51,6 +51,21 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-19] (mbrenner): the CStringTable strings are reference counted,
+//                            and their ids are reused once released
+//   [2026-10-19] (mbrenner): added GetFileModificationTime
+//   [2026-10-19] (mbrenner): added MA_GROUNDING_POLICIES
+//   [2026-10-19] (mbrenner): added the memory accounting types and helpers
+//   [2026-10-19] (mbrenner): added CBinaryWriter and CBinaryReader
+//   [2026-10-19] (mbrenner): added CSharedString (interned, reference counted
+//                            strings)
+//   [2026-10-19] (mbrenner): added CFixedSizePool
+//   [2026-10-19] (mbrenner): added vectorized (SSE/AVX2) kernels over float
+//                            vectors, used in belief updating
+//   [2026-10-19] (mbrenner): added HashCombine
+//   [2026-10-19] (mbrenner): added CSubstringMatcher (Aho-Corasick)
+//   [2026-10-19] (mbrenner): added HashString and the CStringTable class for
+//                            interning strings
 //   [2006-01-24] (dbohus):  added support for constructing hashes from string
 //                           descriptions and the other way around
 //   [2005-02-08] (antoine): added the Sleep function that waits for a number
@@ -99,6 +114,7 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <deque>
 #include <set>
 #include <string>
 #include <queue>
@@ -224,6 +240,332 @@ STRING2STRING StringToS2SHash(string sString, string sSeparator = ",",
 // D: add to a S2S hash from a string description
 void AppendToS2S(STRING2STRING& rs2sInto, STRING2STRING& rs2sFrom);
 
+//-----------------------------------------------------------------------------
+// String hashing and interning
+//-----------------------------------------------------------------------------
+
+// M: definition of the initial value for the (FNV-1a) hashes
+#define FNV_HASH_SEED 2166136261u
+
+// M: computes a (32 bit FNV-1a) hash value for a string
+unsigned int HashString(const string& sString);
+
+// M: folds a 32 bit value into a hash value
+unsigned int HashCombine(unsigned int uiHash, unsigned int uiValue);
+
+// M: a table of interned strings. Each distinct string is stored once and 
+//    gets a small integer id. The strings are reference counted: each call
+//    to Intern adds a reference, which is dropped by Release; a string is 
+//    removed when its last reference goes away, and its id is then reused 
+//    for the next new string. The ids are looked up through an 
+//    open-addressing hash table
+class CStringTable
+{
+private:
+	TStringVector vsStrings;			// the strings, indexed by id
+	vector<unsigned int> vuiHashes;		// the hash values, indexed by id
+	TIntVector viRefs;					// the reference counts, indexed by id
+										//  (0 for the released ids)
+	TIntVector viFreeIDs;				// the released ids
+	TIntVector viSlots;					// the hash table (ids, -1 for empty
+										//  slots, -2 for deleted ones); the 
+										//  size is a power of 2
+	int iSlotsUsed;						// number of used or deleted slots
+
+	// finds the slot for a string (the slot holds either the id of the 
+	// string, or -1 if the string is not in the table)
+	unsigned int findSlot(const string& sString, unsigned int uiHash);
+	// rebuilds the hash table, dropping the deleted slots
+	void rehash();
+
+public:
+	CStringTable();
+
+	// returns the id of the string, adding it to the table if needed, and
+	// adds a reference to it
+	int Intern(const string& sString);
+	// drops a reference to a string, removing it when it was the last one
+	void Release(int iID);
+	// returns the id of the string, or -1 if it's not in the table
+	int Find(const string& sString);
+	// returns the string for an id
+	const string& GetString(int iID);
+	// returns the number of ids (including the released ones, which are 
+	// reused)
+	int GetSize();
+	// empties the table
+	void Clear();
+};
+
+// M: an interned, reference counted string. All the equal strings share a 
+//    single entry in a process-wide table, so copying a shared string only
+//    updates a reference count, and comparing two shared strings is a 
+//    pointer comparison. An entry is removed from the table when its last
+//    reference goes away. The empty string has no entry
+class CSharedString
+{
+private:
+	// the entries in the shared strings table
+	typedef struct TSharedStringEntry {
+		string sValue;				// the string
+		unsigned int uiHash;		// its hash value
+		int iRefCount;				// the number of references to it
+		TSharedStringEntry* pNext;	// the next entry in the bucket
+	} TSharedStringEntry;
+
+	TSharedStringEntry* pEntry;		// the entry (NULL for the empty string)
+
+	// returns the (referenced) entry for a string
+	static TSharedStringEntry* acquire(const string& sString);
+	// drops a reference to an entry
+	static void release(TSharedStringEntry* pAEntry);
+
+public:
+	CSharedString();
+	CSharedString(const string& sString);
+	CSharedString(const CSharedString& rASharedString);
+	~CSharedString();
+
+	// assignment operators
+	CSharedString& operator = (const string& sString);
+	CSharedString& operator = (const CSharedString& rASharedString);
+
+	// equality operators (pointer comparisons)
+	bool operator == (const CSharedString& rASharedString) const;
+	bool operator != (const CSharedString& rASharedString) const;
+
+	// returns the string
+	const string& Get() const;
+	// returns the hash value of the string (same as HashString)
+	unsigned int GetHash() const;
+
+	// returns the number of strings in the table
+	static int GetTableSize();
+	// returns the number of bytes held by the table and its strings
+	static int GetTableBytes();
+};
+
+//-----------------------------------------------------------------------------
+// Binary encoding
+//-----------------------------------------------------------------------------
+
+// M: a writer for compact binary encodings: appends fixed size values (in
+//    little-endian byte order) and length-prefixed strings to a buffer
+class CBinaryWriter
+{
+private:
+	string sBuffer;					// the encoded bytes
+
+public:
+	// append values
+	void WriteUInt8(unsigned char ucValue);
+	void WriteUInt32(unsigned int uiValue);
+	void WriteInt32(int iValue);
+	void WriteFloat(float fValue);
+	void WriteString(const string& sValue);
+
+	// access to the encoded bytes
+	const string& GetBuffer();
+	int GetSize();
+	void Clear();
+};
+
+// M: a reader for the binary encodings produced by CBinaryWriter. The
+//    values are decoded directly from the buffer (which must outlive the
+//    reader), and strings can also be read as views into it. Reading past the end
+//    of the buffer returns zeros/empty strings, and sets the failed flag
+class CBinaryReader
+{
+private:
+	const char* pBuffer;			// the buffer
+	int iSize;						// its size
+	int iPosition;					// the current read position
+	bool bFailed;					// set when reading past the end
+
+	// checks that the next iLength bytes are available
+	bool available(int iLength);
+
+public:
+	CBinaryReader(const char* pABuffer, int iASize);
+	CBinaryReader(const string& sABuffer);
+
+	// read values
+	unsigned char ReadUInt8();
+	unsigned int ReadUInt32();
+	int ReadInt32();
+	float ReadFloat();
+	string ReadString();
+	// reads a string as a view into the buffer (not 0-terminated)
+	const char* ReadStringView(int& riLength);
+
+	// access to the read state
+	bool Failed();
+	bool AtEnd();
+	int GetPosition();
+};
+
+//-----------------------------------------------------------------------------
+// Fixed size memory pools
+//-----------------------------------------------------------------------------
+
+// M: a pool of fixed size memory blocks. The blocks are carved out of larger
+//    chunks, and the freed blocks are kept on a free list and reused; the 
+//    chunks themselves are only released when the pool is destroyed. 
+//    Requests for a different size than the one the pool was created for 
+//    (i.e. for derived classes) are passed on to the global operator new
+class CFixedSizePool
+{
+private:
+	size_t stObjectSize;			// the size of the objects in the pool
+	size_t stBlockSize;				// the size of a block (the object size
+									//  rounded up for alignment)
+	int iBlocksPerChunk;			// the number of blocks in a chunk
+	void* pFreeList;				// the free blocks (linked through their
+									//  first word)
+	vector<void*> vpChunks;			// the allocated chunks
+	int iBlocksInUse;				// the number of blocks handed out
+
+	// allocates a new chunk, and puts its blocks on the free list
+	void addChunk();
+
+public:
+	CFixedSizePool(size_t stAObjectSize, int iABlocksPerChunk = 256);
+	~CFixedSizePool();
+
+	// allocates/frees a block
+	void* Allocate(size_t stSize);
+	void Free(void* pBlock, size_t stSize);
+
+	// returns the number of blocks in use
+	int GetBlocksInUse();
+	// returns the number of bytes held by the pool
+	int GetBytesReserved();
+};
+
+//-----------------------------------------------------------------------------
+// Memory accounting
+//-----------------------------------------------------------------------------
+
+// M: the components in the memory accounting of a session
+#define MA_DIALOG_AGENTS		"dialog_agents"
+#define MA_CONCEPTS				"concepts"
+#define MA_CONCEPT_HISTORY		"concept_history"
+#define MA_HYPOTHESES			"hypotheses"
+#define MA_SHARED_STRINGS		"shared_strings"
+#define MA_GROUNDING_MODELS		"grounding_models"
+#define MA_GROUNDING_POLICIES	"grounding_policies"
+#define MA_EXECUTION_HISTORY	"execution_history"
+#define MA_BINDING_HISTORY		"binding_history"
+#define MA_STATE_HISTORY		"state_history"
+#define MA_STATE_JOURNAL		"state_journal"
+#define MA_OUTPUT_HISTORY		"output_history"
+
+// M: the estimated overhead of a node in a map or set (the tree links and 
+//    color) and in a list, and the longest string kept inside the string
+//    object itself
+#define TREE_NODE_OVERHEAD		(4 * sizeof(void*))
+#define LIST_NODE_OVERHEAD		(2 * sizeof(void*))
+#define STRING_INPLACE_CAPACITY	15
+
+// M: the memory held by a component: the number of objects, and an estimate
+//    of the number of bytes they hold (from the sizes of the objects and the
+//    capacities of their containers; the allocator overhead is not included)
+typedef struct
+{
+	int iObjects;
+	int iBytes;
+} TMemoryUsage;
+
+// M: the memory accounting of a session, by component
+typedef map<string, TMemoryUsage> TMemoryAccount;
+
+// M: adds a number of objects and bytes to a component of an account
+void AccountMemory(TMemoryAccount& rmaAccount, const string& sComponent,
+	int iObjects, int iBytes);
+
+// M: returns the number of heap bytes held by a string, and by a string hash
+//    (its nodes and the strings in them), not counting the object itself
+int StringHeapBytes(const string& sString);
+int S2SHeapBytes(STRING2STRING& rs2sHash);
+
+// M: converts a memory account to a string: one line per component, 
+//    followed by the total
+string MemoryAccountToString(TMemoryAccount& rmaAccount);
+
+//-----------------------------------------------------------------------------
+// Multiple pattern substring matching
+//-----------------------------------------------------------------------------
+
+// M: a node in the substring matcher automaton
+typedef struct
+{
+	map<char, int> mciNext;			// the trie transitions
+	int iFail;						// the failure link (longest proper suffix
+									//  of this node which is also in the trie)
+	int iFirstPattern;				// the first pattern (lowest index) that 
+									//  ends at this node or at any node on 
+									//  its failure chain; -1 if none
+} TSubstringMatcherNode;
+
+// M: a matcher for a set of patterns, which finds in one pass over a text
+//    the first pattern (in the order they were added) that occurs as a
+//    substring of the text (Aho-Corasick automaton)
+class CSubstringMatcher
+{
+private:
+	vector<TSubstringMatcherNode> vsmnNodes;	// the automaton; node 0 is 
+												//  the root
+	int iNumPatterns;							// the number of patterns
+	bool bCompiled;								// are the failure links 
+												//  computed?
+	// adds a new node
+	int addNode();
+
+public:
+	CSubstringMatcher();
+
+	// removes all the patterns
+	void Clear();
+	// adds a pattern (patterns added earlier take precedence); returns the 
+	// index of the pattern
+	int AddPattern(const string& sPattern);
+	// computes the failure links (must be called after the patterns are
+	// added, and before matching)
+	void Compile();
+	// returns the index of the first pattern occurring in sText, -1 if none
+	int FindFirstPattern(const string& sText);
+	// returns the number of patterns
+	int GetNumPatterns();
+};
+
+//-----------------------------------------------------------------------------
+// Vectorized kernels over float vectors (SSE/AVX2 when available at compile
+// time, scalar otherwise; define NO_SIMD_KERNELS to force the scalar code).
+// The vectorized versions accumulate sums in a different order, so the 
+// results may differ from the scalar ones in the last bits.
+//-----------------------------------------------------------------------------
+
+// M: returns the sum of the elements of a vector, skipping the elements 
+//    equal to fSkipValue
+float SumFloatVector(const vector<float>& vfValues, float fSkipValue);
+
+// M: multiplies two vectors element-wise (vfResult[i] = vfA[i] * vfB[i]) 
+//    and returns the sum of the products; the vectors must have the same size
+float MultiplyFloatVectors(vector<float>& vfResult, const vector<float>& vfA,
+	const vector<float>& vfB);
+
+// M: multiplies by fScale the elements of a vector which are not equal to 
+//    fSkipValue
+void ScaleFloatVector(vector<float>& vfValues, float fScale, float fSkipValue);
+
+// M: raises to fPower the elements of a vector which are not equal to 
+//    fSkipValue
+void PowerFloatVector(vector<float>& vfValues, float fPower, float fSkipValue);
+
+// M: returns the index of the (first) largest element of a vector, or -1 
+//    if there are no strictly positive elements
+int ArgMaxFloatVector(const vector<float>& vfValues);
+
 //-----------------------------------------------------------------------------
 // Functions for constructing unique IDs
 //-----------------------------------------------------------------------------
@@ -278,4 +620,8 @@ string GetTimeAsString();
 // A: pauses for a specified number of milliseconds
 void Sleep(int iDelay);
 
+// M: Returns the last modification time of a file (0 if the file cannot
+//    be accessed)
+time_t GetFileModificationTime(string sFileName);
+
 #endif // __UTILS_H__
\ No newline at end of file